@@ -0,0 +1,1080 @@
+// Micro-benchmarks for the ingest and render hot paths. `ftl_bench` runs all of
+// them; `ftl_bench <name>` runs just one.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <fmt/base.h>
+#include <fmt/format.h>
+
+#include "ClusterGrid.hpp"
+#include "DeadReckoning.hpp"
+#include "FlightStore.hpp"
+#include "GeoGrid.hpp"
+#include "IngestWorker.hpp"
+#include "JsonLines.hpp"
+#include "LabelPlacer.hpp"
+#include "MarkerBatch.hpp"
+#include "OpenSky.hpp"
+#include "PickGrid.hpp"
+#include "ScreenTransform.hpp"
+#include "SnapshotLog.hpp"
+#include "StructuralParser.hpp"
+#include "Synthetic.hpp"
+#include "TieredHistory.hpp"
+#include "TrackHistory.hpp"
+
+namespace rl {
+#include <rlgl.h>
+}
+
+// --- Allocation counting ---------------------------------------------------------
+
+static std::atomic< size_t > allocCount{ 0 };
+static std::atomic< size_t > allocBytes{ 0 };
+
+// Every replaceable form that plain `new` and `delete` expressions reach, so
+// that each pointer from `malloc` goes back through `free`.
+static void *
+countedAlloc( std::size_t size ) {
+    allocCount.fetch_add( 1, std::memory_order_relaxed );
+    allocBytes.fetch_add( size, std::memory_order_relaxed );
+    if( void * p = std::malloc( size ? size : 1 ) ) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void *
+operator new( std::size_t size ) {
+    return countedAlloc( size );
+}
+
+void *
+operator new[]( std::size_t size ) {
+    return countedAlloc( size );
+}
+
+void
+operator delete( void * p ) noexcept {
+    std::free( p );
+}
+
+void
+operator delete[]( void * p ) noexcept {
+    std::free( p );
+}
+
+void
+operator delete( void * p, std::size_t ) noexcept {
+    std::free( p );
+}
+
+void
+operator delete[]( void * p, std::size_t ) noexcept {
+    std::free( p );
+}
+
+struct AllocStats {
+    size_t count;
+    size_t bytes;
+
+    static AllocStats now() {
+        return { allocCount.load( std::memory_order_relaxed ),
+                 allocBytes.load( std::memory_order_relaxed ) };
+    }
+    AllocStats since() const {
+        const AllocStats n = now();
+        return { n.count - count, n.bytes - bytes };
+    }
+};
+
+// --- Timing ------------------------------------------------------------------------
+
+// Best wall time of `reps` runs of `fn`, in milliseconds.
+template< typename Fn >
+double
+bestOfMs( int reps, Fn && fn ) {
+    double best = 1e300;
+    for( int i = 0; i < reps; ++i ) {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        const auto end = std::chrono::steady_clock::now();
+        best = std::min(
+            best, std::chrono::duration< double, std::milli >( end - start ).count() );
+    }
+    return best;
+}
+
+// Keep the optimizer from discarding benchmarked work.
+static volatile double sink;
+
+// --- Benchmarks --------------------------------------------------------------------
+
+void
+benchParse() {
+    fmt::print( "{:>8} {:>6} {:>10} {:>10} {:>12} {:>12}\n",
+                "states", "path", "ms", "MB/s", "allocs", "alloc MB" );
+    for( const size_t stateCount : { 1000, 10000, 100000 } ) {
+        const std::string json = Synthetic::statesJson( stateCount );
+        const double mb = json.size() / 1e6;
+        const int reps = stateCount >= 100000 ? 3 : 10;
+
+        AllocStats domAllocs = AllocStats::now();
+        const double domMs = bestOfMs( reps, [ & ] {
+            domAllocs = AllocStats::now();
+            double acc = 0;
+            const nlohmann::json data = nlohmann::json::parse( json );
+            StateVector stateVector;
+            for( const auto & state : data[ "states" ] ) {
+                if( OpenSky::parseState( state, stateVector ) == StateStatus::ok ) {
+                    acc += stateVector.longitudeE6;
+                }
+            }
+            domAllocs = domAllocs.since();
+            sink = acc;
+        } );
+
+        AllocStats saxAllocs = AllocStats::now();
+        const double saxMs = bestOfMs( reps, [ & ] {
+            saxAllocs = AllocStats::now();
+            double acc = 0;
+            OpenSky::streamStates(
+                json,
+                [ & ]( const StateVector & stateVector ) { acc += stateVector.longitudeE6; },
+                OpenSky::Backend::nlohmann );
+            saxAllocs = saxAllocs.since();
+            sink = acc;
+        } );
+
+        fmt::print( "{:>8} {:>6} {:>10.2f} {:>10.1f} {:>12} {:>12.2f}\n",
+                    stateCount, "dom", domMs, mb / ( domMs / 1000 ),
+                    domAllocs.count, domAllocs.bytes / 1e6 );
+        fmt::print( "{:>8} {:>6} {:>10.2f} {:>10.1f} {:>12} {:>12.2f}\n",
+                    stateCount, "sax", saxMs, mb / ( saxMs / 1000 ),
+                    saxAllocs.count, saxAllocs.bytes / 1e6 );
+    }
+}
+
+// Decoding throughput of whole state vectors: `parseState` over an already
+// parsed DOM, which isolates the per-record work, and the streaming parser end
+// to end.
+void
+benchStates() {
+    fmt::print( "{:>8} {:>6} {:>10} {:>14}\n", "states", "path", "ms", "records/s" );
+    for( const size_t stateCount : { 10000, 100000 } ) {
+        const std::string json = Synthetic::statesJson( stateCount );
+        const nlohmann::json data = nlohmann::json::parse( json );
+        const nlohmann::json & states = data[ "states" ];
+
+        const double domMs = bestOfMs( 10, [ & ] {
+            double acc = 0;
+            StateVector stateVector;
+            for( const auto & state : states ) {
+                if( OpenSky::parseState( state, stateVector ) == StateStatus::ok ) {
+                    acc += stateVector.velocity;
+                }
+            }
+            sink = acc;
+        } );
+        const double saxMs = bestOfMs( 10, [ & ] {
+            double acc = 0;
+            OpenSky::streamStates(
+                json,
+                [ & ]( const StateVector & stateVector ) { acc += stateVector.velocity; },
+                OpenSky::Backend::nlohmann );
+            sink = acc;
+        } );
+
+        fmt::print( "{:>8} {:>6} {:>10.2f} {:>14.0f}\n", stateCount, "dom", domMs,
+                    stateCount / ( domMs / 1000 ) );
+        fmt::print( "{:>8} {:>6} {:>10.2f} {:>14.0f}\n", stateCount, "sax", saxMs,
+                    stateCount / ( saxMs / 1000 ) );
+    }
+}
+
+// End-to-end throughput of each parser backend, and of the structural one on
+// every instruction set this CPU has. The index alone shows how much of the
+// structural parser's time is the vectorized first pass.
+void
+benchBackends() {
+    fmt::print( "{:>8} {:>18} {:>10} {:>10} {:>12}\n", "states", "backend", "ms", "MB/s",
+                "allocs" );
+    for( const size_t stateCount : { 1000, 100000 } ) {
+        const std::string json = Synthetic::statesJson( stateCount );
+        const double mb = json.size() / 1e6;
+        const int reps = stateCount >= 100000 ? 5 : 20;
+        const auto report = [ & ]( std::string_view name, double ms, size_t allocs ) {
+            fmt::print( "{:>8} {:>18} {:>10.2f} {:>10.1f} {:>12}\n", stateCount, name, ms,
+                        mb / ( ms / 1000 ), allocs );
+        };
+
+        AllocStats allocs = AllocStats::now();
+        double ms = bestOfMs( reps, [ & ] {
+            allocs = AllocStats::now();
+            double acc = 0;
+            OpenSky::streamStates(
+                json,
+                [ & ]( const StateVector & stateVector ) { acc += stateVector.longitudeE6; },
+                OpenSky::Backend::nlohmann );
+            allocs = allocs.since();
+            sink = acc;
+        } );
+        report( "nlohmann", ms, allocs.count );
+
+        for( const auto isa : { StructuralIndex::Isa::scalar, StructuralIndex::Isa::sse42,
+                                StructuralIndex::Isa::avx2 } ) {
+            if( !StructuralIndex::supported( isa ) ) {
+                continue;
+            }
+            ms = bestOfMs( reps, [ & ] {
+                allocs = AllocStats::now();
+                double acc = 0;
+                StructuralParser::streamStates(
+                    json,
+                    [ & ]( const StateVector & stateVector ) {
+                        acc += stateVector.longitudeE6;
+                    },
+                    isa );
+                allocs = allocs.since();
+                sink = acc;
+            } );
+            report( fmt::format( "structural {}", isa ), ms, allocs.count );
+
+            std::vector< uint32_t > positions;
+            ms = bestOfMs( reps, [ & ] {
+                StructuralIndex::build( json, positions, isa );
+                sink = positions.size();
+            } );
+            report( fmt::format( "index {}", isa ), ms, 0 );
+        }
+    }
+}
+
+// Streaming throughput as a growing share of the rows is malformed. Bad rows are
+// counted and skipped without unwinding, so they should cost no more than good
+// ones.
+void
+benchQuarantine() {
+    fmt::print( "{:>10} {:>10} {:>14} {:>12}\n", "malformed", "ms", "records/s",
+                "quarantined" );
+    for( const double rate : { 0.0, 0.01, 0.1, 0.5 } ) {
+        const size_t stateCount = 100000;
+        const std::string json = Synthetic::statesJson( stateCount, 1, 1752437666, rate );
+        OpenSky::StatesHeader header;
+        const double ms = bestOfMs( 5, [ & ] {
+            double acc = 0;
+            header = *OpenSky::streamStates( json, [ & ]( const StateVector & stateVector ) {
+                acc += stateVector.velocity;
+            } );
+            sink = acc;
+        } );
+        fmt::print( "{:>9.0f}% {:>10.2f} {:>14.0f} {:>12}\n", rate * 100, ms,
+                    stateCount / ( ms / 1000 ), header.stats.quarantined() );
+    }
+}
+
+// Walks every position once over the old array of records and once over the
+// columns: first a plain sum, which is bound by memory traffic, then projecting
+// and hit-testing like `Radar::drawFlight`.
+void
+benchStore() {
+    const GeoBb geoBb = { { -180, -90 }, { 180, 90 } };
+    const Vector2 screen( 1600, 900 );
+    const Vector2 cursor( 800, 450 );
+
+    fmt::print( "{:>8} {:>10} {:>10} {:>10} {:>10} {:>10} {:>10}\n", "flights",
+                "aos sum", "soa sum", "speedup", "aos draw", "soa draw", "speedup" );
+    for( const size_t flightCount : { 1000, 10000, 100000, 1000000 } ) {
+        Synthetic::XorShift rng( 3 );
+        std::vector< StateVector > records;
+        FlightStore store;
+        for( size_t i = 0; i < flightCount; ++i ) {
+            StateVector stateVector;
+            stateVector.callSign =
+                CallSign::fromTrimmed( fmt::format( "DAL{}", rng.next() % 10000 ) );
+            stateVector.longitudeE6 = toMicroDegrees( rng.uniform( -180, 180 ) );
+            stateVector.latitudeE6 = toMicroDegrees( rng.uniform( -90, 90 ) );
+            records.push_back( stateVector );
+            store.insert( stateVector );
+        }
+        const int reps = flightCount >= 1000000 ? 5 : 20;
+
+        const double aosSumMs = bestOfMs( reps, [ & ] {
+            double acc = 0;
+            for( const StateVector & stateVector : records ) {
+                acc += stateVector.longitudeE6 + stateVector.latitudeE6;
+            }
+            sink = acc;
+        } );
+
+        const double soaSumMs = bestOfMs( reps, [ & ] {
+            double acc = 0;
+            const std::vector< uint8_t > & live = store.liveMask();
+            const std::vector< int32_t > & longitudes = store.longitudesE6();
+            const std::vector< int32_t > & latitudes = store.latitudesE6();
+            for( FlightSlot slot = 0; slot < store.slotCount(); ++slot ) {
+                acc += live[ slot ] ? longitudes[ slot ] + latitudes[ slot ] : 0;
+            }
+            sink = acc;
+        } );
+
+        const double aosMs = bestOfMs( reps, [ & ] {
+            size_t near = 0;
+            for( const StateVector & stateVector : records ) {
+                GeoBb bb = geoBb;
+                const Vector2 rel = bb.relativePosition( stateVector.position() );
+                const Vector2 at( screen.width() * rel.x(), screen.height() * rel.y() );
+                near += cursor.distanceTo( at ) <= 5;
+            }
+            sink = near;
+        } );
+
+        const double soaMs = bestOfMs( reps, [ & ] {
+            size_t near = 0;
+            const std::vector< uint8_t > & live = store.liveMask();
+            for( FlightSlot slot = 0; slot < store.slotCount(); ++slot ) {
+                if( !live[ slot ] ) {
+                    continue;
+                }
+                GeoBb bb = geoBb;
+                const Vector2 rel = bb.relativePosition( store.position( slot ) );
+                const Vector2 at( screen.width() * rel.x(), screen.height() * rel.y() );
+                near += cursor.distanceTo( at ) <= 5;
+            }
+            sink = near;
+        } );
+
+        fmt::print( "{:>8} {:>10.3f} {:>10.3f} {:>9.2f}x {:>10.3f} {:>10.3f} {:>9.2f}x\n",
+                    flightCount, aosSumMs, soaSumMs, aosSumMs / soaSumMs,
+                    aosMs, soaMs, aosMs / soaMs );
+    }
+}
+
+// Appending one sample per aircraft per snapshot, with the slab small enough that
+// most appends past the first few hundred snapshots have to evict. After the
+// first snapshot sizes the per-slot table, nothing should allocate.
+void
+benchHistory() {
+    fmt::print( "{:>8} {:>12} {:>14} {:>10} {:>12}\n", "flights", "max samples",
+                "samples/s", "allocs", "held" );
+    for( const size_t flightCount : { 1000, 10000, 100000 } ) {
+        Synthetic::XorShift rng( 9 );
+        TrackHistory history( { 1 << 20, 256, 0 } );
+        const int snapshots = 300;
+        TrackSample sample{ 0, 0, 0, 1000 };
+        for( FlightSlot slot = 0; slot < flightCount; ++slot ) {
+            history.append( slot, sample );
+        }
+
+        const AllocStats before = AllocStats::now();
+        const double ms = bestOfMs( 1, [ & ] {
+            for( int snapshot = 1; snapshot <= snapshots; ++snapshot ) {
+                sample.time = snapshot;
+                for( FlightSlot slot = 0; slot < flightCount; ++slot ) {
+                    sample.longitudeE6 = static_cast< int32_t >( rng.next() );
+                    history.append( slot, sample );
+                }
+            }
+        } );
+        const AllocStats allocs = before.since();
+        fmt::print( "{:>8} {:>12} {:>14.0f} {:>10} {:>12}\n", flightCount,
+                    history.limits().maxSamples, flightCount * snapshots / ( ms / 1000 ),
+                    allocs.count, history.totalSize() );
+    }
+}
+
+// How far simplification shrinks a day of 5-second reports from 100 aircraft,
+// cruising straight or with turns, and what it costs per append.
+void
+benchSimplify() {
+    fmt::print( "{:>8} {:>10} {:>10} {:>10} {:>14}\n", "path", "tolerance", "samples",
+                "ratio", "samples/s" );
+    std::vector< std::vector< StateVector > > cruising;
+    std::vector< std::vector< StateVector > > turning;
+    for( uint32_t seed = 1; seed <= 100; ++seed ) {
+        cruising.push_back( Synthetic::flightPath( 24 * 3600 / 5, seed, false ) );
+        turning.push_back( Synthetic::flightPath( 24 * 3600 / 5, seed ) );
+    }
+    for( const bool turns : { false, true } ) {
+        const auto & paths = turns ? turning : cruising;
+        for( const float tolerance : { 0.0f, 10.0f, 30.0f, 100.0f } ) {
+            TrackHistory history( { 100 * 24 * 3600 / 5, 24 * 3600 / 5, tolerance } );
+            const double ms = bestOfMs( 1, [ & ] {
+                for( size_t i = 0; i < paths.front().size(); ++i ) {
+                    for( FlightSlot slot = 0; slot < paths.size(); ++slot ) {
+                        history.append( slot, paths[ slot ][ i ] );
+                    }
+                }
+            } );
+            const TrackHistory::Compression & compression = history.compression();
+            fmt::print( "{:>8} {:>10.0f} {:>10} {:>9.1f}x {:>14.0f}\n",
+                        turns ? "turning" : "cruising", tolerance, compression.samples,
+                        compression.ratio(), compression.samples / ( ms / 1000 ) );
+        }
+    }
+}
+
+// A simulated day of 5-second reports from 2000 aircraft through the three tiers.
+// Memory is fixed by the tiers' limits, so it should read the same every hour.
+void
+benchTiers() {
+    constexpr size_t flightCount = 2000;
+    constexpr uint32_t interval = 5;
+    Synthetic::XorShift rng( 11 );
+    std::vector< double > longitudes( flightCount );
+    std::vector< double > latitudes( flightCount );
+    std::vector< double > tracks( flightCount );
+    for( size_t i = 0; i < flightCount; ++i ) {
+        longitudes[ i ] = rng.uniform( -120, 20 );
+        latitudes[ i ] = rng.uniform( 20, 60 );
+        tracks[ i ] = rng.uniform( 0, 2 * pi );
+    }
+
+    TieredHistory history;
+    fmt::print( "{:>6} {:>10} {:>10} {:>10} {:>10} {:>14}\n", "hour", "memory MB", "1 s",
+                "10 s", "60 s", "appends/s" );
+    uint32_t time = 0;
+    for( int hour = 1; hour <= 24; ++hour ) {
+        const auto start = std::chrono::steady_clock::now();
+        for( ; time < uint32_t( hour ) * 3600; time += interval ) {
+            for( FlightSlot slot = 0; slot < flightCount; ++slot ) {
+                // Mostly straight, with the odd turn.
+                if( rng.chance( 0.01 ) ) {
+                    tracks[ slot ] += rng.uniform( -0.5, 0.5 );
+                }
+                const double step = 230.0 * interval / metersPerDegree;
+                latitudes[ slot ] += step * std::cos( tracks[ slot ] );
+                longitudes[ slot ] += step * std::sin( tracks[ slot ] ) /
+                                      std::cos( toRadians( latitudes[ slot ] ) );
+                if( std::abs( latitudes[ slot ] ) > 80 || std::abs( longitudes[ slot ] ) > 179 ) {
+                    tracks[ slot ] += pi;
+                }
+                history.append( slot, TrackSample{ time, toMicroDegrees( longitudes[ slot ] ),
+                                                   toMicroDegrees( latitudes[ slot ] ), 10000 } );
+            }
+        }
+        const double seconds = std::chrono::duration< double >(
+                                   std::chrono::steady_clock::now() - start ).count();
+        if( hour == 1 || hour % 4 == 0 ) {
+            fmt::print( "{:>6} {:>10.1f} {:>10} {:>10} {:>10} {:>14.0f}\n", hour,
+                        history.memoryBytes() / 1e6, history.tier( 0 ).totalSize(),
+                        history.tier( 1 ).totalSize(), history.tier( 2 ).totalSize(),
+                        flightCount * 3600 / interval / seconds );
+        }
+    }
+}
+
+// One frame of dead reckoning: moving every aircraft to the frame time, with
+// half of them still blending in a correction. Budget: 0.1 ms for 10k aircraft.
+void
+benchReckon() {
+    fmt::print( "{:>8} {:>12} {:>12} {:>14}\n", "flights", "advance ms", "rebase ms",
+                "aircraft/s" );
+    for( const size_t flightCount : { 1000, 10000, 100000 } ) {
+        Synthetic::XorShift rng( 5 );
+        FlightStore flights;
+        flights.beginSnapshot();
+        for( size_t i = 0; i < flightCount; ++i ) {
+            StateVector stateVector;
+            stateVector.icao24 = static_cast< Icao24 >( i );
+            stateVector.longitudeE6 = toMicroDegrees( rng.uniform( -180, 180 ) );
+            stateVector.latitudeE6 = toMicroDegrees( rng.uniform( -80, 80 ) );
+            stateVector.velocity = static_cast< float >( rng.uniform( 0, 260 ) );
+            stateVector.trueTrack = static_cast< float >( rng.uniform( 0, 360 ) );
+            stateVector.lastContact = 1752437660 - rng.next() % 10;
+            flights.upsert( stateVector );
+        }
+        flights.endSnapshot();
+
+        DeadReckoning reckoning;
+        const double rebaseMs = bestOfMs( 5, [ & ] {
+            reckoning.snapshotIs( flights, 1752437660.5 );
+        } );
+        double now = 1752437660.5;
+        const double advanceMs = bestOfMs( 200, [ & ] {
+            now += 1.0 / 60;
+            reckoning.advance( now );
+        } );
+        sink = reckoning.longitudesE6()[ 0 ];
+        fmt::print( "{:>8} {:>12.4f} {:>12.3f} {:>14.0f}\n", flightCount, advanceMs,
+                    rebaseMs, flightCount / ( advanceMs / 1000 ) );
+    }
+}
+
+// Projecting every aircraft to the screen: one `GeoBb::relativePosition` per
+// point like `Radar::drawFlight` used to, against the batch kernels with the
+// transform built once, under both projections.
+void
+benchProject() {
+    const GeoBb geoBb = { { -180, -80 }, { 180, 80 } };
+    const Vector2 screen( 1600, 900 );
+    fmt::print( "{:>8} {:>12} {:>12} {:>10} {:>12} {:>10} {:>12}\n", "points",
+                "per point ms", "generic ms", "speedup", "avx2 ms", "speedup", "mercator ms" );
+    for( const size_t pointCount : { 1000, 10000, 100000 } ) {
+        Synthetic::XorShift rng( 11 );
+        std::vector< int32_t > longitudes( pointCount );
+        std::vector< int32_t > latitudes( pointCount );
+        for( size_t i = 0; i < pointCount; ++i ) {
+            longitudes[ i ] = toMicroDegrees( rng.uniform( -180, 180 ) );
+            latitudes[ i ] = toMicroDegrees( rng.uniform( -80, 80 ) );
+        }
+        std::vector< float > xs( pointCount );
+        std::vector< float > ys( pointCount );
+
+        const double pointMs = bestOfMs( 50, [ & ] {
+            for( size_t i = 0; i < pointCount; ++i ) {
+                GeoBb bb = geoBb;
+                const Vector2 rel = bb.relativePosition(
+                    { fromMicroDegrees( longitudes[ i ] ), fromMicroDegrees( latitudes[ i ] ) } );
+                xs[ i ] = static_cast< float >( screen.width() * rel.x() );
+                ys[ i ] = static_cast< float >( screen.height() * rel.y() );
+            }
+            sink = xs[ pointCount / 2 ];
+        } );
+        const auto batchMs = [ & ]( ScreenTransform::Projection projection,
+                                    ScreenTransform::Isa isa ) {
+            const ScreenTransform transform( geoBb, Vector2( 0, 0 ), screen, projection );
+            return bestOfMs( 50, [ & ] {
+                transform.project( longitudes.data(), latitudes.data(), pointCount, xs.data(),
+                                   ys.data(), isa );
+                sink = xs[ pointCount / 2 ];
+            } );
+        };
+        const auto equirectangular = ScreenTransform::Projection::equirectangular;
+        const double genericMs = batchMs( equirectangular, ScreenTransform::Isa::generic );
+        const double mercatorMs =
+            batchMs( ScreenTransform::Projection::webMercator, ScreenTransform::bestIsa() );
+        if( ScreenTransform::supported( ScreenTransform::Isa::avx2 ) ) {
+            const double avx2Ms = batchMs( equirectangular, ScreenTransform::Isa::avx2 );
+            fmt::print( "{:>8} {:>12.4f} {:>12.4f} {:>9.1f}x {:>12.4f} {:>9.1f}x {:>12.4f}\n",
+                        pointCount, pointMs, genericMs, pointMs / genericMs, avx2Ms,
+                        pointMs / avx2Ms, mercatorMs );
+        } else {
+            fmt::print( "{:>8} {:>12.4f} {:>12.4f} {:>9.1f}x {:>12} {:>10} {:>12.4f}\n",
+                        pointCount, pointMs, genericMs, pointMs / genericMs, "-", "-",
+                        mercatorMs );
+        }
+    }
+}
+
+// Hover picking: the old `distanceTo` against every aircraft, against keeping a
+// `PickGrid` up to date and querying it. Positions drift up to 0.1 pixel per
+// frame, which is an airliner at 60 fps on a radar 50 km across.
+void
+benchPick() {
+    const Vector2 screen( 1600, 900 );
+    fmt::print( "{:>8} {:>12} {:>12} {:>12}\n", "flights", "scan ms", "update ms",
+                "query us" );
+    for( const size_t flightCount : { 1000, 10000, 100000 } ) {
+        Synthetic::XorShift rng( 13 );
+        std::vector< float > xs( flightCount );
+        std::vector< float > ys( flightCount );
+        std::vector< float > dxs( flightCount );
+        std::vector< float > dys( flightCount );
+        const std::vector< uint8_t > drawn( flightCount, 1 );
+        for( size_t i = 0; i < flightCount; ++i ) {
+            xs[ i ] = static_cast< float >( rng.uniform( 0, screen.width() ) );
+            ys[ i ] = static_cast< float >( rng.uniform( 0, screen.height() ) );
+            dxs[ i ] = static_cast< float >( rng.uniform( -0.1, 0.1 ) );
+            dys[ i ] = static_cast< float >( rng.uniform( -0.1, 0.1 ) );
+        }
+        const Vector2 cursor( 800, 450 );
+
+        const double scanMs = bestOfMs( 20, [ & ] {
+            size_t near = 0;
+            for( size_t i = 0; i < flightCount; ++i ) {
+                near += cursor.distanceTo( Vector2( xs[ i ], ys[ i ] ) ) <= 5;
+            }
+            sink = near;
+        } );
+
+        PickGrid grid;
+        grid.viewIs( Vector2( 0, 0 ), screen );
+        grid.update( xs.data(), ys.data(), drawn.data(), flightCount );
+        const double updateMs = bestOfMs( 20, [ & ] {
+            for( size_t i = 0; i < flightCount; ++i ) {
+                xs[ i ] += dxs[ i ];
+                ys[ i ] += dys[ i ];
+            }
+            grid.update( xs.data(), ys.data(), drawn.data(), flightCount );
+        } );
+        const int queries = 1000;
+        const double queryMs = bestOfMs( 5, [ & ] {
+            size_t found = 0;
+            for( int i = 0; i < queries; ++i ) {
+                const Vector2 at( rng.uniform( 0, screen.width() ),
+                                  rng.uniform( 0, screen.height() ) );
+                found += grid.nearest( at, 5 ) != FlightStore::invalidSlot;
+            }
+            sink = found;
+        } );
+        fmt::print( "{:>8} {:>12.4f} {:>12.4f} {:>12.3f}\n", flightCount, scanMs, updateMs,
+                    queryMs * 1000 / queries );
+    }
+}
+
+// Culling to the view: projecting every aircraft of a world-wide fleet each
+// frame, against asking a `GeoGrid` for the ones in a view 10 degrees across
+// and projecting only those, as `Radar::draw` does. The grid holds reported
+// positions and is updated once per snapshot, after every aircraft flew 10 s at
+// 250 m/s; frames see them up to 0.05 degrees further on.
+void
+benchCull() {
+    const GeoBb view = { { -76, 39 }, { -66, 45 } };
+    const int32_t reachE6 = 100000;
+    const Vector2 screen( 1600, 900 );
+    const ScreenTransform transform( view, Vector2( 0, 0 ), screen );
+    fmt::print( "{:>8} {:>12} {:>12} {:>10} {:>10} {:>12} {:>10}\n", "flights", "all ms",
+                "culled ms", "speedup", "in view", "snapshot ms", "relinked" );
+    for( const size_t flightCount : { 10000, 100000, 1000000 } ) {
+        Synthetic::XorShift rng( 17 );
+        std::vector< int32_t > reportedLongitudes( flightCount );
+        std::vector< int32_t > reportedLatitudes( flightCount );
+        std::vector< int32_t > longitudes( flightCount );
+        std::vector< int32_t > latitudes( flightCount );
+        const std::vector< uint8_t > live( flightCount, 1 );
+        for( size_t i = 0; i < flightCount; ++i ) {
+            reportedLongitudes[ i ] = toMicroDegrees( rng.uniform( -180, 180 ) );
+            reportedLatitudes[ i ] = toMicroDegrees( rng.uniform( -60, 70 ) );
+            longitudes[ i ] =
+                reportedLongitudes[ i ] + toMicroDegrees( rng.uniform( -0.05, 0.05 ) );
+            latitudes[ i ] =
+                reportedLatitudes[ i ] + toMicroDegrees( rng.uniform( -0.05, 0.05 ) );
+        }
+        std::vector< float > xs( flightCount );
+        std::vector< float > ys( flightCount );
+
+        const double allMs = bestOfMs( 20, [ & ] {
+            transform.project( longitudes.data(), latitudes.data(), flightCount, xs.data(),
+                               ys.data() );
+            sink = xs[ flightCount / 2 ];
+        } );
+
+        GeoGrid grid;
+        grid.update( reportedLongitudes.data(), reportedLatitudes.data(), live.data(),
+                     flightCount );
+        const int32_t west = toMicroDegrees( view.min.longitude );
+        const int32_t east = toMicroDegrees( view.max.longitude );
+        const int32_t south = toMicroDegrees( view.min.latitude );
+        const int32_t north = toMicroDegrees( view.max.latitude );
+        const double reach = fromMicroDegrees( reachE6 );
+        const GeoBb reachable = { { view.min.longitude - reach, view.min.latitude - reach },
+                                  { view.max.longitude + reach, view.max.latitude + reach } };
+        std::vector< FlightSlot > visible;
+        std::vector< int32_t > visibleLongitudes;
+        std::vector< int32_t > visibleLatitudes;
+        const double culledMs = bestOfMs( 20, [ & ] {
+            visible.clear();
+            grid.forEachWithin( reachable, [ & ]( FlightSlot slot ) {
+                if( longitudes[ slot ] >= west && longitudes[ slot ] <= east &&
+                    latitudes[ slot ] >= south && latitudes[ slot ] <= north ) {
+                    visible.push_back( slot );
+                }
+            } );
+            visibleLongitudes.resize( visible.size() );
+            visibleLatitudes.resize( visible.size() );
+            for( size_t i = 0; i < visible.size(); ++i ) {
+                visibleLongitudes[ i ] = longitudes[ visible[ i ] ];
+                visibleLatitudes[ i ] = latitudes[ visible[ i ] ];
+            }
+            transform.project( visibleLongitudes.data(), visibleLatitudes.data(),
+                               visible.size(), xs.data(), ys.data() );
+            sink = double( visible.size() );
+        } );
+
+        // Snapshots alternate east and west, so every one moves the fleet.
+        size_t relinked = 0;
+        int32_t step = 22000;
+        const int snapshots = 10;
+        const double snapshotMs = bestOfMs( snapshots, [ & ] {
+            for( size_t i = 0; i < flightCount; ++i ) {
+                reportedLongitudes[ i ] += step;
+            }
+            step = -step;
+            grid.update( reportedLongitudes.data(), reportedLatitudes.data(), live.data(),
+                         flightCount );
+            relinked += grid.relinked();
+        } );
+        fmt::print( "{:>8} {:>12.4f} {:>12.4f} {:>9.1f}x {:>10} {:>12.4f} {:>10}\n",
+                    flightCount, allMs, culledMs, allMs / culledMs, visible.size(),
+                    snapshotMs, relinked / snapshots );
+    }
+}
+
+// Zoomed out over a view 120 degrees across, drawing every aircraft in view as
+// `Radar::draw` does when zoomed in, against drawing the clusters of the
+// `ClusterGrid` level whose cells are 40 pixels tall or more. "snapshot ms" is
+// counting a snapshot in which every aircraft flew 10 s at 250 m/s.
+void
+benchClusters() {
+    const GeoBb view = { { -120, -10 }, { 0, 70 } };
+    const Vector2 screen( 1600, 900 );
+    const ScreenTransform transform( view, Vector2( 0, 0 ), screen );
+    const double cellPixels = fromMicroDegrees( ClusterGrid::cellE6 ) * metersPerDegree /
+                              transform.metersPerPixel();
+    int32_t level = 0;
+    while( cellPixels * ( 1 << level ) < 40 && level + 1 < ClusterGrid::levelCount ) {
+        ++level;
+    }
+    fmt::print( "level {}, cells {:.0f} px\n", level, cellPixels * ( 1 << level ) );
+    fmt::print( "{:>8} {:>12} {:>10} {:>12} {:>10} {:>12} {:>10} {:>8}\n", "flights",
+                "aircraft ms", "drawn", "clusters ms", "drawn", "snapshot ms", "recounted",
+                "merged" );
+    for( const size_t flightCount : { 10000, 100000, 1000000 } ) {
+        Synthetic::XorShift rng( 37 );
+        std::vector< int32_t > longitudes( flightCount );
+        std::vector< int32_t > latitudes( flightCount );
+        const std::vector< uint8_t > live( flightCount, 1 );
+        for( size_t i = 0; i < flightCount; ++i ) {
+            longitudes[ i ] = toMicroDegrees( rng.uniform( -180, 180 ) );
+            latitudes[ i ] = toMicroDegrees( rng.uniform( -60, 70 ) );
+        }
+        std::vector< float > xs( flightCount );
+        std::vector< float > ys( flightCount );
+
+        GeoGrid grid;
+        grid.update( longitudes.data(), latitudes.data(), live.data(), flightCount );
+        std::vector< FlightSlot > visible;
+        std::vector< int32_t > visibleLongitudes;
+        std::vector< int32_t > visibleLatitudes;
+        const double aircraftMs = bestOfMs( 10, [ & ] {
+            visible.clear();
+            grid.forEachWithin( view, [ & ]( FlightSlot slot ) { visible.push_back( slot ); } );
+            visibleLongitudes.resize( visible.size() );
+            visibleLatitudes.resize( visible.size() );
+            for( size_t i = 0; i < visible.size(); ++i ) {
+                visibleLongitudes[ i ] = longitudes[ visible[ i ] ];
+                visibleLatitudes[ i ] = latitudes[ visible[ i ] ];
+            }
+            transform.project( visibleLongitudes.data(), visibleLatitudes.data(),
+                               visible.size(), xs.data(), ys.data() );
+            sink = double( visible.size() );
+        } );
+
+        ClusterGrid clusters;
+        clusters.update( longitudes.data(), latitudes.data(), live.data(), flightCount );
+        size_t shown = 0;
+        const double clustersMs = bestOfMs( 10, [ & ] {
+            shown = 0;
+            double acc = 0;
+            clusters.forEachWithin( level, view, [ & ]( const ClusterGrid::Cluster & cluster ) {
+                const Vector2 at = transform.project( { fromMicroDegrees( cluster.longitudeE6 ),
+                                                        fromMicroDegrees( cluster.latitudeE6 ) } );
+                acc += at.x() + cluster.count;
+                ++shown;
+            } );
+            sink = acc;
+        } );
+
+        // Snapshots alternate east and west, so every one moves the fleet.
+        size_t recounted = 0;
+        size_t merged = 0;
+        int32_t step = 22000;
+        const int snapshots = 10;
+        const double snapshotMs = bestOfMs( snapshots, [ & ] {
+            for( size_t i = 0; i < flightCount; ++i ) {
+                longitudes[ i ] += step;
+            }
+            step = -step;
+            clusters.update( longitudes.data(), latitudes.data(), live.data(), flightCount );
+            recounted += clusters.recounted();
+            merged += clusters.merged();
+        } );
+        fmt::print( "{:>8} {:>12.4f} {:>10} {:>12.4f} {:>10} {:>12.4f} {:>10} {:>8}\n",
+                    flightCount, aircraftMs, visible.size(), clustersMs, shown, snapshotMs,
+                    recounted / snapshots, merged / snapshots );
+    }
+}
+
+// Aircraft markers per frame, drawn in a hidden window: one `DrawCircleV` per
+// marker, and `MarkerBatch`. Times are CPU milliseconds per frame up to handing
+// everything to the GPU, flush and upload included. raylib doesn't count its
+// draw calls, so the old path's are worked out from its batch of 8192 quads'
+// worth of vertices, which it draws whenever a 36-triangle circle doesn't fit;
+// the batched path's are what `MarkerBatch` reports.
+void
+benchMarkers() {
+    constexpr size_t circleVertices = 3 * 36;
+    constexpr size_t batchVertices = 8192 * 4;
+    const Vector2 screen( 1600, 900 );
+    rl::SetConfigFlags( rl::FLAG_WINDOW_HIDDEN );
+    rl::InitWindow( static_cast< int >( screen.width() ), static_cast< int >( screen.height() ),
+                    "ftl_bench" );
+    if( !rl::IsWindowReady() ) {
+        fmt::print( "no window: markers need a GL context\n" );
+        return;
+    }
+    fmt::print( "{:>8} {:>14} {:>10} {:>12} {:>10} {:>10} {:>10}\n", "markers",
+                "immediate ms", "calls", "batched ms", "calls", "speedup", "upload kB" );
+    {
+        // Gone before the window, like everything else holding GL resources.
+        MarkerBatch markers;
+        for( const size_t markerCount : { 1000, 10000, 100000 } ) {
+            Synthetic::XorShift rng( 19 );
+            std::vector< Vector2 > positions( markerCount );
+            for( Vector2 & position : positions ) {
+                position = Vector2( rng.uniform( 0, screen.width() ),
+                                    rng.uniform( 0, screen.height() ) );
+            }
+
+            rl::BeginDrawing();
+            const size_t circlesPerBatch = batchVertices / circleVertices;
+            const size_t immediateCalls = ( markerCount + circlesPerBatch - 1 ) / circlesPerBatch;
+            const double immediateMs = bestOfMs( 10, [ & ] {
+                for( const Vector2 & position : positions ) {
+                    rl::DrawCircleV( position.toRlVector2(), 3, rl::RED );
+                }
+                rl::rlDrawRenderBatchActive();
+            } );
+            const double batchedMs = bestOfMs( 10, [ & ] {
+                markers.clear();
+                for( const Vector2 & position : positions ) {
+                    markers.add( position, 3, rl::RED );
+                }
+                markers.draw();
+            } );
+            rl::EndDrawing();
+            fmt::print( "{:>8} {:>14.4f} {:>10} {:>12.4f} {:>10} {:>9.1f}x {:>10}\n",
+                        markerCount, immediateMs, immediateCalls, batchedMs,
+                        markers.drawCalls(), immediateMs / batchedMs,
+                        markerCount * sizeof( MarkerBatch::Marker ) / 1024 );
+        }
+    }
+    rl::CloseWindow();
+}
+
+// Callsign labels over a busy approach: aircraft bunched toward the middle of
+// the radar, each keeping labels off its marker, drifting up to 0.1 pixel a
+// frame as in `benchPick`. A frame is clearing the grid, marking the markers
+// and placing every label; "kept" is how many labels stay in the spot they had
+// the frame before.
+void
+benchLabels() {
+    const Vector2 screen( 1600, 900 );
+    fmt::print( "{:>8} {:>12} {:>12} {:>10} {:>10}\n", "labels", "first ms", "frame ms",
+                "placed", "kept" );
+    for( const size_t labelCount : { 1000, 5000, 20000 } ) {
+        Synthetic::XorShift rng( 29 );
+        std::vector< LabelPlacer::Label > labels( labelCount );
+        for( FlightSlot slot = 0; slot < labelCount; ++slot ) {
+            // Sums of uniforms bunch up in the middle.
+            const double x = ( rng.uniform( 0, 1 ) + rng.uniform( 0, 1 ) ) / 2;
+            const double y = ( rng.uniform( 0, 1 ) + rng.uniform( 0, 1 ) ) / 2;
+            labels[ slot ] = { slot, float( x * screen.width() ), float( y * screen.height() ),
+                               float( 24 + rng.next() % 4 * 6 ), 10 };
+        }
+        LabelPlacer placer;
+        const auto frame = [ & ] {
+            placer.viewIs( Vector2( 0, 0 ), screen );
+            for( const LabelPlacer::Label & label : labels ) {
+                placer.occupy( label.x, label.y, 3 );
+            }
+            placer.place( labels.data(), labels.size(), 4 );
+        };
+        const double firstMs = bestOfMs( 1, frame );
+
+        std::vector< uint8_t > spots( labelCount );
+        size_t kept = 0;
+        const double frameMs = bestOfMs( 20, [ & ] {
+            for( FlightSlot slot = 0; slot < labelCount; ++slot ) {
+                spots[ slot ] = placer.candidate( slot );
+            }
+            for( LabelPlacer::Label & label : labels ) {
+                label.x += float( rng.uniform( -0.1, 0.1 ) );
+                label.y += float( rng.uniform( -0.1, 0.1 ) );
+            }
+            frame();
+            kept = 0;
+            for( const LabelPlacer::Placement & placement : placer.placements() ) {
+                kept += spots[ placement.slot ] == placer.candidate( placement.slot );
+            }
+        } );
+        fmt::print( "{:>8} {:>12.4f} {:>12.4f} {:>10} {:>10}\n", labelCount, firstMs,
+                    frameMs, placer.placements().size(), kept );
+    }
+}
+
+// Frame times of a simulated render loop while 100k-state snapshots keep
+// arriving, parsed either on the frame thread or by an `IngestWorker`.
+void
+benchIngest() {
+    const std::string json = Synthetic::statesJson( 100000 );
+    const int frameCount = 240;
+    const int framesPerSnapshot = 30;
+
+    // Stands in for drawing: one pass over the position columns.
+    const auto drawFrame = []( const FlightStore & store ) {
+        double acc = 0;
+        for( FlightSlot slot = 0; slot < store.slotCount(); ++slot ) {
+            acc += store.liveMask()[ slot ] ? store.longitudesE6()[ slot ] : 0;
+        }
+        sink = acc;
+    };
+    const auto apply = []( FlightStore & store, const Snapshot & snapshot ) {
+        store.beginSnapshot();
+        for( const StateVector & stateVector : snapshot.states ) {
+            store.upsert( stateVector );
+        }
+        store.endSnapshot();
+    };
+    const auto report = []( const char * mode, std::vector< double > frameMs ) {
+        std::sort( frameMs.begin(), frameMs.end() );
+        fmt::print( "{:>8} {:>10.3f} {:>10.3f} {:>10.3f}\n", mode,
+                    frameMs[ frameMs.size() / 2 ],
+                    frameMs[ frameMs.size() * 99 / 100 ], frameMs.back() );
+    };
+
+    fmt::print( "{:>8} {:>10} {:>10} {:>10}\n", "mode", "p50 ms", "p99 ms", "max ms" );
+    {
+        FlightStore store;
+        Snapshot snapshot;
+        std::vector< double > frameMs;
+        for( int frame = 0; frame < frameCount; ++frame ) {
+            frameMs.push_back( bestOfMs( 1, [ & ] {
+                if( frame % framesPerSnapshot == 0 ) {
+                    OpenSky::parseSnapshot( json, snapshot );
+                    apply( store, snapshot );
+                }
+                drawFrame( store );
+            } ) );
+        }
+        report( "inline", frameMs );
+    }
+    {
+        FlightStore store;
+        std::vector< double > frameMs;
+        IngestWorker ingest( [ & ]( IngestWorker &, Snapshot & snapshot ) {
+            return OpenSky::parseSnapshot( json, snapshot );
+        } );
+        for( int frame = 0; frame < frameCount; ++frame ) {
+            frameMs.push_back( bestOfMs( 1, [ & ] {
+                if( auto snapshot = ingest.poll() ) {
+                    apply( store, *snapshot );
+                    ingest.recycle( std::move( snapshot ) );
+                }
+                drawFrame( store );
+            } ) );
+            std::this_thread::sleep_for( std::chrono::milliseconds( 4 ) );
+        }
+        report( "worker", frameMs );
+    }
+}
+
+// Replays the same recorded day from JSON and from a binary snapshot log.
+void
+benchReplay() {
+    const std::string logPath =
+        ( std::filesystem::temp_directory_path() / "ftl_bench_replay.ftlog" ).string();
+    fmt::print( "{:>8} {:>6} {:>12} {:>14} {:>10}\n",
+                "states", "path", "snapshots/s", "states/s", "speedup" );
+    for( const size_t stateCount : { 1000, 10000 } ) {
+        const int snapshotCount = 20;
+        std::vector< std::string > jsons;
+        {
+            auto writer = SnapshotLog::Writer::open( logPath );
+            Snapshot snapshot;
+            for( int i = 0; i < snapshotCount; ++i ) {
+                jsons.push_back( Synthetic::statesJson( stateCount, i + 1, 1752437666 + 5 * i ) );
+                OpenSky::parseSnapshot( jsons.back(), snapshot );
+                writer->write( snapshot );
+            }
+        }
+
+        Snapshot snapshot;
+        const double jsonMs = bestOfMs( 3, [ & ] {
+            for( const std::string & json : jsons ) {
+                OpenSky::parseSnapshot( json, snapshot );
+            }
+            sink = snapshot.states.size();
+        } );
+        auto reader = SnapshotLog::Reader::open( logPath );
+        const double logMs = bestOfMs( 3, [ & ] {
+            reader->rewind();
+            while( reader->next( snapshot ) ) {
+            }
+            sink = snapshot.states.size();
+        } );
+
+        const auto row = [ & ]( const char * path, double ms, double speedup ) {
+            fmt::print( "{:>8} {:>6} {:>12.0f} {:>14.0f} {:>9.1f}x\n", stateCount, path,
+                        snapshotCount / ( ms / 1000 ),
+                        snapshotCount * stateCount / ( ms / 1000 ), speedup );
+        };
+        row( "json", jsonMs, 1 );
+        row( "log", logMs, jsonMs / logMs );
+    }
+    std::filesystem::remove( logPath );
+}
+
+// Parses a JSON-lines backfill on a growing number of threads.
+void
+benchJsonLines() {
+    const int snapshotCount = 64;
+    std::string bytes;
+    for( int i = 0; i < snapshotCount; ++i ) {
+        bytes += Synthetic::statesJson( 10000, i + 1, 1752437666 + 5 * i );
+        bytes += '\n';
+    }
+    const double mb = bytes.size() / 1e6;
+
+    fmt::print( "{} cores\n", std::thread::hardware_concurrency() );
+    fmt::print( "{:>8} {:>10} {:>12} {:>10} {:>10}\n", "threads", "ms",
+                "snapshots/s", "MB/s", "speedup" );
+    double oneThreadMs = 0;
+    for( const unsigned threadCount : { 1, 2, 4, 8, 16 } ) {
+        const double ms = bestOfMs( 3, [ & ] {
+            sink = JsonLines::parse( bytes, threadCount ).snapshots.size();
+        } );
+        oneThreadMs = threadCount == 1 ? ms : oneThreadMs;
+        fmt::print( "{:>8} {:>10.1f} {:>12.1f} {:>10.1f} {:>9.2f}x\n", threadCount, ms,
+                    snapshotCount / ( ms / 1000 ), mb / ( ms / 1000 ), oneThreadMs / ms );
+    }
+}
+
+struct Benchmark {
+    const char * name;
+    void ( *run )();
+};
+
+static const Benchmark benchmarks[] = {
+    { "parse", benchParse },
+    { "states", benchStates },
+    { "backends", benchBackends },
+    { "quarantine", benchQuarantine },
+    { "store", benchStore },
+    { "history", benchHistory },
+    { "simplify", benchSimplify },
+    { "tiers", benchTiers },
+    { "reckon", benchReckon },
+    { "project", benchProject },
+    { "pick", benchPick },
+    { "cull", benchCull },
+    { "clusters", benchClusters },
+    { "markers", benchMarkers },
+    { "labels", benchLabels },
+    { "ingest", benchIngest },
+    { "replay", benchReplay },
+    { "jsonl", benchJsonLines },
+};
+
+int
+main( int argc, char ** argv ) {
+    const char * only = argc > 1 ? argv[ 1 ] : nullptr;
+    for( const Benchmark & benchmark : benchmarks ) {
+        if( only && std::strcmp( only, benchmark.name ) != 0 ) {
+            continue;
+        }
+        fmt::print( "--- {} ---\n", benchmark.name );
+        benchmark.run();
+    }
+    return 0;
+}
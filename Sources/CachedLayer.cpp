@@ -0,0 +1,66 @@
+#include <cmath>
+
+#include "CachedLayer.hpp"
+
+namespace {
+
+// Layers cover every pixel their size touches.
+int
+pixels( double size ) {
+    return static_cast< int >( std::ceil( size ) );
+}
+
+} // namespace
+
+bool
+CachedLayer::PaintedView::stale( Vector2 size, uint64_t version ) const {
+    return !_painted || version != _version || pixels( size.width() ) != _width ||
+           pixels( size.height() ) != _height;
+}
+
+void
+CachedLayer::PaintedView::paintedIs( Vector2 size, uint64_t version ) {
+    _painted = true;
+    _width = pixels( size.width() );
+    _height = pixels( size.height() );
+    _version = version;
+}
+
+CachedLayer::~CachedLayer() {
+    if( _loaded ) {
+        rl::UnloadRenderTexture( _texture );
+    }
+}
+
+void
+CachedLayer::beginPaint( Vector2 size ) {
+    const int width = pixels( size.width() );
+    const int height = pixels( size.height() );
+    if( !_loaded || width != _width || height != _height ) {
+        if( _loaded ) {
+            rl::UnloadRenderTexture( _texture );
+        }
+        _texture = rl::LoadRenderTexture( width, height );
+        _loaded = true;
+        _width = width;
+        _height = height;
+    }
+    rl::BeginTextureMode( _texture );
+    rl::ClearBackground( rl::BLANK );
+}
+
+void
+CachedLayer::endPaint( Vector2 size, uint64_t version ) {
+    rl::EndTextureMode();
+    _painted.paintedIs( size, version );
+    ++_paints;
+}
+
+void
+CachedLayer::blit( Vector2 at ) const {
+    // Render textures are stored bottom up.
+    rl::DrawTextureRec( _texture.texture,
+                        { 0, 0, static_cast< float >( _width ),
+                          -static_cast< float >( _height ) },
+                        at.toRlVector2(), rl::WHITE );
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "SizeTypes.hpp"
+
+// A layer of the radar that only changes with the view, such as the border or
+// a lat/lon grid. It is painted into a RenderTexture2D when the view it was
+// painted for goes stale, and otherwise drawn from the texture as one textured
+// quad, however many lines and labels went into it.
+//
+// Views are told apart by a version number that the owner bumps whenever the
+// picture would change: a resize, a pan, a zoom. Moving the layer around the
+// screen doesn't repaint it.
+class CachedLayer {
+public:
+    // The view a layer was last painted for, and whether drawing another needs
+    // it painted again. Kept apart from the texture, so it works without a GL
+    // context.
+    class PaintedView {
+    public:
+        // Whether a layer painted for this can't be drawn for `size` pixels at
+        // `version` as it is.
+        bool stale( Vector2 size, uint64_t version ) const;
+        void paintedIs( Vector2 size, uint64_t version );
+        void invalidate() { _painted = false; }
+
+    private:
+        bool _painted = false;
+        int _width = 0;
+        int _height = 0;
+        uint64_t _version = 0;
+    };
+
+    CachedLayer() = default;
+    CachedLayer( const CachedLayer & ) = delete;
+    CachedLayer & operator=( const CachedLayer & ) = delete;
+    ~CachedLayer();
+
+    // Draws the layer's `size` pixels with their top left at `at`, first calling
+    // `paint()` to paint them afresh if the layer was last painted for another
+    // `version` or size. `paint` draws with the texture's top left at 0/0.
+    template< typename Paint >
+    void draw( Vector2 at, Vector2 size, uint64_t version, Paint && paint ) {
+        if( _painted.stale( size, version ) ) {
+            beginPaint( size );
+            paint();
+            endPaint( size, version );
+        }
+        blit( at );
+    }
+    // Repaints on the next `draw`, whatever the version.
+    void invalidate() { _painted.invalidate(); }
+
+    // How many times the layer was painted, for stats.
+    size_t paints() const { return _paints; }
+
+private:
+    void beginPaint( Vector2 size );
+    void endPaint( Vector2 size, uint64_t version );
+    void blit( Vector2 at ) const;
+
+    rl::RenderTexture2D _texture = {};
+    bool _loaded = false;
+    // The texture's size in pixels.
+    int _width = 0;
+    int _height = 0;
+    PaintedView _painted;
+    size_t _paints = 0;
+};
@@ -0,0 +1,22 @@
+#include <doctest/doctest.h>
+
+#include "CachedLayer.hpp"
+
+// Painting needs a GL context, so this checks when a layer would be painted.
+TEST_CASE( "cached layer repaints only when the view changes" ) {
+    CachedLayer::PaintedView view;
+    CHECK( view.stale( Vector2( 760, 535 ), 1 ) );
+    view.paintedIs( Vector2( 760, 535 ), 1 );
+    CHECK( !view.stale( Vector2( 760, 535 ), 1 ) );
+
+    // Panned or zoomed.
+    CHECK( view.stale( Vector2( 760, 535 ), 2 ) );
+    view.paintedIs( Vector2( 760, 535 ), 2 );
+    // Resized, down to fractions of a pixel.
+    CHECK( view.stale( Vector2( 760, 535.5 ), 2 ) );
+    view.paintedIs( Vector2( 760, 535.5 ), 2 );
+    CHECK( !view.stale( Vector2( 760, 535.75 ), 2 ) );
+
+    view.invalidate();
+    CHECK( view.stale( Vector2( 760, 535.75 ), 2 ) );
+}
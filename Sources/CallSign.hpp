@@ -0,0 +1,78 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string_view>
+
+// An ICAO callsign stored inline: at most 8 characters plus a length byte, so
+// copying one never allocates. Unused characters are zero, which lets equality
+// and hashing look at the characters as a single 64-bit word.
+class CallSign {
+public:
+    static constexpr size_t capacity = 8;
+
+    constexpr CallSign() = default;
+
+    // Copies `text` with surrounding whitespace stripped. Characters past
+    // `capacity` are dropped.
+    static CallSign fromTrimmed( std::string_view text ) {
+        const char * begin = text.data();
+        const char * end = begin + text.size();
+        while( begin < end && isSpace( *begin ) ) {
+            ++begin;
+        }
+        while( end > begin && isSpace( end[ -1 ] ) ) {
+            --end;
+        }
+        CallSign callSign;
+        callSign._size = static_cast< uint8_t >(
+            std::min< size_t >( end - begin, capacity ) );
+        std::memcpy( callSign._chars, begin, callSign._size );
+        return callSign;
+    }
+    // Shown for aircraft that don't report a callsign.
+    static CallSign unknown() { return fromTrimmed( "???" ); }
+
+    std::string_view view() const { return std::string_view( _chars, _size ); }
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    uint64_t word() const {
+        uint64_t word;
+        std::memcpy( &word, _chars, sizeof( word ) );
+        return word;
+    }
+    size_t hash() const {
+        // Fibonacci hashing; std::hash< uint64_t > is the identity on most
+        // standard libraries, which clusters badly for ASCII.
+        const uint64_t h = word() * 0x9e3779b97f4a7c15ull;
+        return static_cast< size_t >( h ^ ( h >> 32 ) );
+    }
+
+    bool operator==( const CallSign & other ) const { return word() == other.word(); }
+    bool operator!=( const CallSign & other ) const { return !( *this == other ); }
+
+private:
+    static constexpr bool isSpace( char c ) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' ||
+               c == '\v';
+    }
+
+    char _chars[ capacity ] = {};
+    uint8_t _size = 0;
+};
+static_assert( sizeof( CallSign ) == 9 );
+
+inline std::string_view
+format_as( const CallSign & callSign ) {
+    return callSign.view();
+}
+
+template<>
+struct std::hash< CallSign > {
+    size_t operator()( const CallSign & callSign ) const noexcept {
+        return callSign.hash();
+    }
+};
@@ -0,0 +1,31 @@
+#include <unordered_set>
+
+#include <doctest/doctest.h>
+#include <fmt/base.h>
+#include <fmt/format.h>
+
+#include "CallSign.hpp"
+
+TEST_CASE( "callsign trims while copying" ) {
+    CHECK( CallSign::fromTrimmed( "JBU1235 " ).view() == "JBU1235" );
+    CHECK( CallSign::fromTrimmed( "  N143NE\t" ).view() == "N143NE" );
+    CHECK( CallSign::fromTrimmed( "        " ).empty() );
+    CHECK( CallSign::fromTrimmed( "" ).empty() );
+    CHECK( CallSign::fromTrimmed( "ABCDEFGHIJ" ).view() == "ABCDEFGH" );
+}
+
+TEST_CASE( "callsign compares and hashes by word" ) {
+    const CallSign a = CallSign::fromTrimmed( "DAL257  " );
+    const CallSign b = CallSign::fromTrimmed( "DAL257" );
+    const CallSign c = CallSign::fromTrimmed( "DAL2570" );
+    CHECK( a == b );
+    CHECK( a != c );
+    CHECK( a.hash() == b.hash() );
+
+    std::unordered_set< CallSign > set{ a, b, c };
+    CHECK( set.size() == 2 );
+}
+
+TEST_CASE( "callsign formats as its characters" ) {
+    CHECK( fmt::format( "<{}>", CallSign::fromTrimmed( " BAW1B " ) ) == "<BAW1B>" );
+}
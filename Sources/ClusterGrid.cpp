@@ -0,0 +1,177 @@
+#include "ClusterGrid.hpp"
+
+ClusterGrid::ClusterGrid() {
+    for( int32_t level = 0; level < levelCount; ++level ) {
+        Level & cells = _levels[ level ];
+        cells.columns = ( ( columns - 1 ) >> level ) + 1;
+        cells.rows = ( ( rows - 1 ) >> level ) + 1;
+        cells.cells.resize( size_t( cells.columns ) * cells.rows );
+        if( level > 0 ) {
+            cells.isChanged.resize( cells.cells.size(), 0 );
+        }
+    }
+}
+
+void
+ClusterGrid::clear() {
+    for( Level & cells : _levels ) {
+        std::fill( cells.cells.begin(), cells.cells.end(), Cell() );
+        std::fill( cells.isChanged.begin(), cells.isChanged.end(), 0 );
+        cells.changed.clear();
+    }
+    std::fill( _cell.begin(), _cell.end(), noCell );
+    _size = 0;
+}
+
+void
+ClusterGrid::changedIs( int32_t level, uint32_t cell ) {
+    Level & cells = _levels[ level ];
+    if( !cells.isChanged[ cell ] ) {
+        cells.isChanged[ cell ] = 1;
+        cells.changed.push_back( cell );
+    }
+}
+
+void
+ClusterGrid::add( FlightSlot slot, int32_t longitudeE6, int32_t latitudeE6 ) {
+    const uint32_t cell =
+        uint32_t( rowOf( 0, latitudeE6 ) * columns + columnOf( 0, longitudeE6 ) );
+    Cell & counted = _levels[ 0 ].cells[ cell ];
+    ++counted.count;
+    counted.longitudeSumE6 += longitudeE6;
+    counted.latitudeSumE6 += latitudeE6;
+    _levels[ 0 ].changed.push_back( cell );
+    _cell[ slot ] = cell;
+    _countedLongitudeE6[ slot ] = longitudeE6;
+    _countedLatitudeE6[ slot ] = latitudeE6;
+    ++_size;
+}
+
+void
+ClusterGrid::remove( FlightSlot slot ) {
+    const uint32_t cell = _cell[ slot ];
+    Cell & counted = _levels[ 0 ].cells[ cell ];
+    --counted.count;
+    counted.longitudeSumE6 -= _countedLongitudeE6[ slot ];
+    counted.latitudeSumE6 -= _countedLatitudeE6[ slot ];
+    _levels[ 0 ].changed.push_back( cell );
+    _cell[ slot ] = noCell;
+    --_size;
+}
+
+ClusterGrid::Cell
+ClusterGrid::mergedAt( int32_t level, int32_t row, int32_t column ) const {
+    const Level & below = _levels[ level - 1 ];
+    Cell sum;
+    for( int32_t childRow = 2 * row; childRow < std::min( 2 * row + 2, below.rows ); ++childRow ) {
+        for( int32_t childColumn = 2 * column;
+             childColumn < std::min( 2 * column + 2, below.columns ); ++childColumn ) {
+            const Cell & child = below.cells[ size_t( childRow ) * below.columns + childColumn ];
+            sum.count += child.count;
+            sum.longitudeSumE6 += child.longitudeSumE6;
+            sum.latitudeSumE6 += child.latitudeSumE6;
+        }
+    }
+    return sum;
+}
+
+void
+ClusterGrid::merge() {
+    _merged = 0;
+    // When most of the fleet moved, going through whole levels in order is
+    // cheaper than visiting the changed cells one by one, and so is every level
+    // above.
+    bool sweep = false;
+    for( int32_t level = 1; level < levelCount; ++level ) {
+        Level & below = _levels[ level - 1 ];
+        Level & cells = _levels[ level ];
+        sweep = sweep || below.changed.size() > below.cells.size() / 8;
+        for( const uint32_t child : below.changed ) {
+            if( level > 1 ) {
+                below.isChanged[ child ] = 0;
+            }
+            if( !sweep ) {
+                const uint32_t row = child / uint32_t( below.columns ) / 2;
+                const uint32_t column = child % uint32_t( below.columns ) / 2;
+                changedIs( level, row * uint32_t( cells.columns ) + column );
+            }
+        }
+        below.changed.clear();
+        if( sweep ) {
+            std::fill( cells.cells.begin(), cells.cells.end(), Cell() );
+            for( int32_t row = 0; row < below.rows; ++row ) {
+                const Cell * children = &below.cells[ size_t( row ) * below.columns ];
+                Cell * parents = &cells.cells[ size_t( row / 2 ) * cells.columns ];
+                for( int32_t column = 0; column < below.columns; ++column ) {
+                    Cell & parent = parents[ column / 2 ];
+                    parent.count += children[ column ].count;
+                    parent.longitudeSumE6 += children[ column ].longitudeSumE6;
+                    parent.latitudeSumE6 += children[ column ].latitudeSumE6;
+                }
+            }
+            _merged += cells.cells.size();
+            continue;
+        }
+        for( const uint32_t parent : cells.changed ) {
+            cells.cells[ parent ] = mergedAt( level, int32_t( parent / uint32_t( cells.columns ) ),
+                                              int32_t( parent % uint32_t( cells.columns ) ) );
+        }
+        _merged += cells.changed.size();
+    }
+    Level & top = _levels[ levelCount - 1 ];
+    for( const uint32_t cell : top.changed ) {
+        top.isChanged[ cell ] = 0;
+    }
+    top.changed.clear();
+}
+
+void
+ClusterGrid::update( const int32_t * longitudesE6, const int32_t * latitudesE6,
+                     const uint8_t * live, size_t slotCount ) {
+    _recounted = 0;
+    // Slots past the end are gone.
+    for( FlightSlot slot = FlightSlot( slotCount ); slot < _cell.size(); ++slot ) {
+        if( _cell[ slot ] != noCell ) {
+            remove( slot );
+        }
+    }
+    _cell.resize( slotCount, noCell );
+    _countedLongitudeE6.resize( slotCount );
+    _countedLatitudeE6.resize( slotCount );
+
+    for( FlightSlot slot = 0; slot < slotCount; ++slot ) {
+        const int32_t longitude = longitudesE6[ slot ];
+        const int32_t latitude = latitudesE6[ slot ];
+        const bool present = live[ slot ] && longitude != StateVector::missingE6;
+        const bool counted = _cell[ slot ] != noCell;
+        if( present && counted && longitude == _countedLongitudeE6[ slot ] &&
+            latitude == _countedLatitudeE6[ slot ] ) {
+            continue;
+        }
+        if( !present && !counted ) {
+            continue;
+        }
+        ++_recounted;
+        if( present && counted ) {
+            const uint32_t cell =
+                uint32_t( rowOf( 0, latitude ) * columns + columnOf( 0, longitude ) );
+            // Most aircraft stay in their cell and only move its middle.
+            if( cell == _cell[ slot ] ) {
+                Cell & moved = _levels[ 0 ].cells[ cell ];
+                moved.longitudeSumE6 += longitude - _countedLongitudeE6[ slot ];
+                moved.latitudeSumE6 += latitude - _countedLatitudeE6[ slot ];
+                _countedLongitudeE6[ slot ] = longitude;
+                _countedLatitudeE6[ slot ] = latitude;
+                _levels[ 0 ].changed.push_back( cell );
+                continue;
+            }
+        }
+        if( counted ) {
+            remove( slot );
+        }
+        if( present ) {
+            add( slot, longitude, latitude );
+        }
+    }
+    merge();
+}
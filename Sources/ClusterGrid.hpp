@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "FlightData.hpp"
+#include "FlightStore.hpp"
+
+// How many aircraft there are, and where their middle is, in each cell of a
+// pyramid of grids, for drawing a zoomed out radar as one badge per cell. The
+// finest level cuts the world into `cellE6` square cells and each level above
+// merges two by two of the one below, so whatever the zoom some level has
+// cells of about the size wanted on screen, and drawing it visits a number of
+// cells set by the screen rather than by the fleet.
+//
+// Cells keep a count and the sums of their slots' positions. `update` only
+// recounts the slots that reported a new position, and only recomputes the
+// cells above the finest ones that changed.
+class ClusterGrid {
+public:
+    static constexpr int32_t cellE6 = 500000;
+    static constexpr int32_t levelCount = 8;
+    static constexpr int32_t columns = 720;
+    static constexpr int32_t rows = 360;
+
+    struct Cluster {
+        uint32_t count;
+        // The mean position of the cell's aircraft.
+        int32_t longitudeE6;
+        int32_t latitudeE6;
+    };
+
+    ClusterGrid();
+
+    // Counts every slot below `slotCount` in the cell of its position, or in
+    // none if it isn't live or has no position.
+    void update( const int32_t * longitudesE6, const int32_t * latitudesE6,
+                 const uint8_t * live, size_t slotCount );
+    void clear();
+
+    // The side of the cells of `level`.
+    static int32_t cellE6At( int32_t level ) { return cellE6 << level; }
+    // Calls `fn( const Cluster & )` for every cell of `level` with aircraft in it
+    // that overlaps `box`.
+    template< typename Fn >
+    void forEachWithin( int32_t level, const GeoBb & box, Fn && fn ) const {
+        const Level & cells = _levels[ level ];
+        const int32_t firstColumn = columnOf( level, toMicroDegrees( box.min.longitude ) );
+        const int32_t lastColumn = columnOf( level, toMicroDegrees( box.max.longitude ) );
+        const int32_t firstRow = rowOf( level, toMicroDegrees( box.min.latitude ) );
+        const int32_t lastRow = rowOf( level, toMicroDegrees( box.max.latitude ) );
+        for( int32_t row = firstRow; row <= lastRow; ++row ) {
+            for( int32_t column = firstColumn; column <= lastColumn; ++column ) {
+                const Cell & cell = cells.cells[ size_t( row ) * cells.columns + column ];
+                if( cell.count > 0 ) {
+                    fn( Cluster{ cell.count,
+                                 int32_t( cell.longitudeSumE6 / int64_t( cell.count ) ),
+                                 int32_t( cell.latitudeSumE6 / int64_t( cell.count ) ) } );
+                }
+            }
+        }
+    }
+
+    size_t size() const { return _size; }
+    // Slots the last `update` counted again, and cells above the finest level
+    // it recomputed.
+    size_t recounted() const { return _recounted; }
+    size_t merged() const { return _merged; }
+
+private:
+    static constexpr uint32_t noCell = UINT32_MAX;
+
+    struct Cell {
+        uint32_t count = 0;
+        int64_t longitudeSumE6 = 0;
+        int64_t latitudeSumE6 = 0;
+    };
+    struct Level {
+        int32_t columns = 0;
+        int32_t rows = 0;
+        std::vector< Cell > cells;
+        // Cells that changed since their parents were last merged: once each,
+        // except on the finest level where a cell is listed for every change
+        // rather than looking up whether it already is.
+        std::vector< uint32_t > changed;
+        std::vector< uint8_t > isChanged;
+    };
+
+    static int32_t columnOf( int32_t level, int32_t longitudeE6 ) {
+        const int64_t column = ( int64_t( longitudeE6 ) + 180 * int64_t( 1000000 ) ) /
+                               cellE6At( level );
+        return int32_t( std::clamp< int64_t >( column, 0, ( ( columns - 1 ) >> level ) ) );
+    }
+    static int32_t rowOf( int32_t level, int32_t latitudeE6 ) {
+        const int64_t row = ( int64_t( latitudeE6 ) + 90 * int64_t( 1000000 ) ) /
+                            cellE6At( level );
+        return int32_t( std::clamp< int64_t >( row, 0, ( ( rows - 1 ) >> level ) ) );
+    }
+    void changedIs( int32_t level, uint32_t cell );
+    void add( FlightSlot slot, int32_t longitudeE6, int32_t latitudeE6 );
+    void remove( FlightSlot slot );
+    // The sum of the cells of the level below under a cell of `level`.
+    Cell mergedAt( int32_t level, int32_t row, int32_t column ) const;
+    // Recomputes the cells above those that changed, level by level.
+    void merge();
+
+    Level _levels[ levelCount ];
+    size_t _size = 0;
+    size_t _recounted = 0;
+    size_t _merged = 0;
+    // Per slot: its cell on the finest level, and the position it was counted at.
+    std::vector< uint32_t > _cell;
+    std::vector< int32_t > _countedLongitudeE6;
+    std::vector< int32_t > _countedLatitudeE6;
+};
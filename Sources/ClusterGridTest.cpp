@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <map>
+#include <tuple>
+#include <vector>
+
+#include <doctest/doctest.h>
+
+#include "ClusterGrid.hpp"
+#include "Synthetic.hpp"
+
+namespace {
+
+struct Columns {
+    std::vector< int32_t > longitudes;
+    std::vector< int32_t > latitudes;
+    std::vector< uint8_t > live;
+
+    void add( double longitude, double latitude, bool isLive = true ) {
+        longitudes.push_back( toMicroDegrees( longitude ) );
+        latitudes.push_back( toMicroDegrees( latitude ) );
+        live.push_back( isLive );
+    }
+    void update( ClusterGrid & grid ) const {
+        grid.update( longitudes.data(), latitudes.data(), live.data(), live.size() );
+    }
+};
+
+using Clusters = std::vector< std::tuple< uint32_t, int32_t, int32_t > >;
+
+Clusters
+within( const ClusterGrid & grid, int32_t level, const GeoBb & box ) {
+    Clusters clusters;
+    grid.forEachWithin( level, box, [ & ]( const ClusterGrid::Cluster & cluster ) {
+        clusters.emplace_back( cluster.count, cluster.longitudeE6, cluster.latitudeE6 );
+    } );
+    return clusters;
+}
+
+const GeoBb world = { { -180, -90 }, { 180, 90 } };
+
+} // namespace
+
+TEST_CASE( "cluster grid counts aircraft per cell on every level" ) {
+    ClusterGrid grid;
+    Columns columns;
+    columns.add( -71.1, 42.3 );
+    columns.add( -71.3, 42.1 );
+    columns.add( -70.9, 42.4 );
+    columns.add( -73.8, 40.6 );
+    columns.add( -71.2, 42.2, false );
+    // No position yet.
+    columns.longitudes.push_back( StateVector::missingE6 );
+    columns.latitudes.push_back( StateVector::missingE6 );
+    columns.live.push_back( 1 );
+    columns.update( grid );
+    CHECK( grid.size() == 4 );
+    CHECK( grid.recounted() == 4 );
+    // Half degree cells split Boston; two degree ones hold all of it, and New
+    // York is in the next one south.
+    const GeoBb boston = { { -71.5, 42 }, { -70.5, 42.5 } };
+    CHECK( within( grid, 0, boston ) ==
+           Clusters{ { 2, -71200000, 42200000 }, { 1, -70900000, 42400000 } } );
+    CHECK( within( grid, 2, world ) ==
+           Clusters{ { 1, -73800000, 40600000 }, { 3, -71100000, 42266666 } } );
+    CHECK( within( grid, ClusterGrid::levelCount - 1, world ) ==
+           Clusters{ { 4, -71775000, 41850000 } } );
+
+    // Unmoved aircraft aren't counted again; moves within a cell shift its
+    // middle, landings and takeoffs change its count.
+    columns.longitudes[ 0 ] = toMicroDegrees( -71.2 );
+    columns.live[ 2 ] = 0;
+    columns.live[ 4 ] = 1;
+    columns.update( grid );
+    CHECK( grid.recounted() == 3 );
+    CHECK( within( grid, 0, boston ) == Clusters{ { 3, -71233333, 42200000 } } );
+    CHECK( within( grid, 2, world ) ==
+           Clusters{ { 1, -73800000, 40600000 }, { 3, -71233333, 42200000 } } );
+
+    // Slots past the end leave.
+    columns.longitudes.resize( 3 );
+    columns.latitudes.resize( 3 );
+    columns.live.resize( 3 );
+    columns.update( grid );
+    CHECK( grid.size() == 2 );
+    CHECK( within( grid, 2, world ) == Clusters{ { 2, -71250000, 42200000 } } );
+    columns.update( grid );
+    CHECK( grid.recounted() == 0 );
+    CHECK( grid.merged() == 0 );
+
+    grid.clear();
+    CHECK( grid.size() == 0 );
+    CHECK( within( grid, 0, world ).empty() );
+    columns.update( grid );
+    CHECK( within( grid, 2, world ) == Clusters{ { 2, -71250000, 42200000 } } );
+}
+
+TEST_CASE( "cluster grid levels add up as aircraft move" ) {
+    Synthetic::XorShift rng( 31 );
+    Columns columns;
+    // Enough that a snapshot moving all of them recomputes whole levels, and one
+    // moving a few recomputes cells.
+    for( int i = 0; i < 40000; ++i ) {
+        columns.add( rng.uniform( -180, 180 ), rng.uniform( -90, 90 ), rng.chance( 0.95 ) );
+    }
+    ClusterGrid grid;
+    for( int snapshot = 0; snapshot < 4; ++snapshot ) {
+        columns.update( grid );
+        const size_t live = size_t( std::count( columns.live.begin(), columns.live.end(), 1 ) );
+        CHECK( grid.size() == live );
+        // Every level counts every aircraft once, and the sizes of the cells match
+        // a count made from scratch.
+        for( int32_t level = 0; level < ClusterGrid::levelCount; ++level ) {
+            std::map< std::pair< int64_t, int64_t >, uint32_t > expected;
+            const int64_t side = ClusterGrid::cellE6At( level );
+            for( size_t slot = 0; slot < columns.live.size(); ++slot ) {
+                if( columns.live[ slot ] ) {
+                    const int64_t column = std::min< int64_t >(
+                        ( columns.longitudes[ slot ] + int64_t( 180000000 ) ) / side,
+                        ( ClusterGrid::columns - 1 ) >> level );
+                    const int64_t row = std::min< int64_t >(
+                        ( columns.latitudes[ slot ] + int64_t( 90000000 ) ) / side,
+                        ( ClusterGrid::rows - 1 ) >> level );
+                    ++expected[ { row, column } ];
+                }
+            }
+            std::vector< uint32_t > counts;
+            for( const auto & [ cell, count ] : expected ) {
+                counts.push_back( count );
+            }
+            std::vector< uint32_t > found;
+            for( const auto & cluster : within( grid, level, world ) ) {
+                found.push_back( std::get< 0 >( cluster ) );
+            }
+            REQUIRE( found == counts );
+        }
+        // Most aircraft fly a little, some a long way, some land or take off; every
+        // other snapshot only a few do.
+        const double moving = snapshot % 2 ? 0.9 : 0.01;
+        for( size_t slot = 0; slot < columns.live.size(); ++slot ) {
+            if( !rng.chance( moving ) ) {
+                continue;
+            }
+            const double reach = rng.chance( 0.05 ) ? 20 : 0.05;
+            columns.longitudes[ slot ] = std::clamp(
+                columns.longitudes[ slot ] + toMicroDegrees( rng.uniform( -reach, reach ) ),
+                -180000000, 180000000 );
+            columns.latitudes[ slot ] = std::clamp(
+                columns.latitudes[ slot ] + toMicroDegrees( rng.uniform( -reach, reach ) ),
+                -90000000, 90000000 );
+            if( rng.chance( 0.02 ) ) {
+                columns.live[ slot ] = !columns.live[ slot ];
+            }
+        }
+    }
+}
@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <cmath>
+
+#include "DeadReckoning.hpp"
+#include "Simd.hpp"
+
+namespace {
+
+constexpr FlightId noFlight = UINT32_MAX;
+
+} // namespace
+
+void
+DeadReckoning::resize( size_t slotCount ) {
+    _slotCount = slotCount;
+    const size_t padded = Simd::paddedSize( slotCount );
+    if( padded <= _id.size() ) {
+        return;
+    }
+    _id.resize( padded, noFlight );
+    _baseLongitudeE6.resize( padded, StateVector::missingE6 );
+    _baseLatitudeE6.resize( padded, StateVector::missingE6 );
+    _baseTime.resize( padded, 0 );
+    _longitudeRate.resize( padded, 0 );
+    _latitudeRate.resize( padded, 0 );
+    _longitudeCorrection.resize( padded, 0 );
+    _latitudeCorrection.resize( padded, 0 );
+    _correctionStart.resize( padded, 0 );
+    _longitudeE6.resize( padded, StateVector::missingE6 );
+    _latitudeE6.resize( padded, StateVector::missingE6 );
+}
+
+void
+DeadReckoning::snapshotIs( const FlightStore & flights, double now ) {
+    // Where everything is drawn right now, which is where corrections start.
+    advance( now );
+    resize( flights.slotCount() );
+    _epoch = std::floor( now );
+
+    const std::vector< uint8_t > & live = flights.liveMask();
+    const std::vector< FlightId > & ids = flights.ids();
+    float fastestLongitude = 0;
+    float fastestLatitude = 0;
+    _settlesAt = now;
+    for( FlightSlot slot = 0; slot < _slotCount; ++slot ) {
+        const StateVector stateVector =
+            live[ slot ] ? flights.stateVector( slot ) : StateVector();
+        if( !stateVector.hasPosition() ) {
+            _id[ slot ] = noFlight;
+            _baseLongitudeE6[ slot ] = StateVector::missingE6;
+            _baseLatitudeE6[ slot ] = StateVector::missingE6;
+            _longitudeRate[ slot ] = 0;
+            _latitudeRate[ slot ] = 0;
+            _longitudeCorrection[ slot ] = 0;
+            _latitudeCorrection[ slot ] = 0;
+            continue;
+        }
+
+        const double fixed = stateVector.lastContact ?
+                                 double( stateVector.lastContact ) - stateVector.positionAge() :
+                                 now;
+        double longitudeRate = 0;
+        double latitudeRate = 0;
+        if( std::abs( stateVector.velocity ) <= maxSpeed &&
+            std::isfinite( stateVector.trueTrack ) ) {
+            const double track = toRadians( stateVector.trueTrack );
+            const double latitude = toRadians( fromMicroDegrees( stateVector.latitudeE6 ) );
+            latitudeRate = stateVector.velocity * std::cos( track ) / metersPerMicroDegree;
+            longitudeRate = stateVector.velocity * std::sin( track ) /
+                            ( metersPerMicroDegree * std::max( std::cos( latitude ), 0.01 ) );
+        }
+        _baseLongitudeE6[ slot ] = stateVector.longitudeE6;
+        _baseLatitudeE6[ slot ] = stateVector.latitudeE6;
+        _baseTime[ slot ] = static_cast< float >( fixed - _epoch );
+        _longitudeRate[ slot ] = static_cast< float >( longitudeRate );
+        _latitudeRate[ slot ] = static_cast< float >( latitudeRate );
+        fastestLongitude = std::max( fastestLongitude, std::abs( _longitudeRate[ slot ] ) );
+        fastestLatitude = std::max( fastestLatitude, std::abs( _latitudeRate[ slot ] ) );
+
+        // Start from the drawn position if this is the aircraft that was drawn.
+        double longitudeCorrection = 0;
+        double latitudeCorrection = 0;
+        if( _id[ slot ] == ids[ slot ] && _longitudeE6[ slot ] != StateVector::missingE6 ) {
+            const double dt = std::clamp( now - fixed, 0.0, double( maxExtrapolation ) );
+            longitudeCorrection =
+                _longitudeE6[ slot ] - ( stateVector.longitudeE6 + longitudeRate * dt );
+            latitudeCorrection =
+                _latitudeE6[ slot ] - ( stateVector.latitudeE6 + latitudeRate * dt );
+            if( std::abs( longitudeCorrection ) > maxCorrection ||
+                std::abs( latitudeCorrection ) > maxCorrection ) {
+                longitudeCorrection = 0;
+                latitudeCorrection = 0;
+            }
+        }
+        _id[ slot ] = ids[ slot ];
+        _longitudeCorrection[ slot ] = static_cast< float >( longitudeCorrection );
+        _latitudeCorrection[ slot ] = static_cast< float >( latitudeCorrection );
+        _correctionStart[ slot ] = static_cast< float >( now - _epoch );
+        if( longitudeRate != 0 || latitudeRate != 0 ) {
+            _settlesAt = std::max( _settlesAt, fixed + maxExtrapolation );
+        }
+        if( longitudeCorrection != 0 || latitudeCorrection != 0 ) {
+            _settlesAt = std::max( _settlesAt, now + blendSeconds );
+        }
+    }
+    // Extrapolation stops after `maxExtrapolation`, and corrections only fade.
+    // Saturated rather than overflowed by a wild velocity.
+    const auto reach = []( float fastest ) {
+        return int32_t( std::min( double( fastest ) * maxExtrapolation + maxCorrection + 1,
+                                  360 * microDegreesPerDegree ) );
+    };
+    _longitudeReachE6 = reach( fastestLongitude );
+    _latitudeReachE6 = reach( fastestLatitude );
+    _settled = false;
+    advance( now );
+}
+
+void
+DeadReckoning::advance( double now ) {
+    // Times are floats relative to the epoch, so the last step may land a
+    // little after `settlesAt`; a second later it certainly has.
+    const bool settled = now >= _settlesAt + 1;
+    if( settled && _settled ) {
+        return;
+    }
+    using namespace Simd;
+    const Float4 t = splat( static_cast< float >( now - _epoch ) );
+    const Float4 zero = splat( 0.0f );
+    const Float4 one = splat( 1.0f );
+    const Float4 horizon = splat( maxExtrapolation );
+    const Float4 fade = splat( 1 / blendSeconds );
+    for( size_t i = 0; i < Simd::paddedSize( _slotCount ); i += lanes ) {
+        const Float4 dt = min( max( t - load( &_baseTime[ i ] ), zero ), horizon );
+        const Float4 weight = max( one - ( t - load( &_correctionStart[ i ] ) ) * fade, zero );
+        const Float4 longitudeOffset = load( &_longitudeRate[ i ] ) * dt +
+                                       load( &_longitudeCorrection[ i ] ) * weight;
+        const Float4 latitudeOffset = load( &_latitudeRate[ i ] ) * dt +
+                                      load( &_latitudeCorrection[ i ] ) * weight;
+        // Aircraft without a position have zero rates and corrections, so they
+        // stay at `missingE6`.
+        store( &_longitudeE6[ i ], load( &_baseLongitudeE6[ i ] ) + toInt( longitudeOffset ) );
+        store( &_latitudeE6[ i ], load( &_baseLatitudeE6[ i ] ) + toInt( latitudeOffset ) );
+    }
+    ++_version;
+    _settled = settled;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "FlightStore.hpp"
+
+// Where every aircraft of a FlightStore should be drawn between reports. Each
+// snapshot rebases the aircraft on their latest position, velocity and track;
+// each frame then moves them along that track to the frame's time in one
+// vectorized pass over the columns. Reports rarely land exactly where the
+// previous one was heading, so a rebased aircraft starts from where it was drawn
+// and the difference fades out over `blendSeconds` instead of jumping.
+//
+// Columns are indexed by FlightSlot, like the store's, and padded to whole
+// vectors.
+class DeadReckoning {
+public:
+    // Reports older than this stop moving rather than drift on.
+    static constexpr float maxExtrapolation = 30;
+    static constexpr float blendSeconds = 1;
+    // A correction larger than this, in micro-degrees, is a jump in the data
+    // rather than drift, and is applied at once.
+    static constexpr float maxCorrection = 20000;
+    // Ground speeds above this, in m/s, are bad data and extrapolate like a
+    // missing one; it also keeps every offset well inside an int32_t.
+    static constexpr float maxSpeed = 1000;
+
+    // Rebases every aircraft of `flights` on its current columns. `now` is the
+    // Unix time the frame clock stands at, which fixes the positions the
+    // corrections start from.
+    void snapshotIs( const FlightStore & flights, double now );
+    // Moves every aircraft to where it should be at `now`.
+    void advance( double now );
+
+    // Micro-degrees as of the last `advance`, `StateVector::missingE6` for
+    // aircraft without a position. At least `slotCount` long.
+    const std::vector< int32_t > & longitudesE6() const { return _longitudeE6; }
+    const std::vector< int32_t > & latitudesE6() const { return _latitudeE6; }
+    size_t slotCount() const { return _slotCount; }
+    // How far, in micro-degrees, any aircraft can be drawn from the position it
+    // last reported until the next snapshot.
+    int32_t longitudeReachE6() const { return _longitudeReachE6; }
+    int32_t latitudeReachE6() const { return _latitudeReachE6; }
+    // The Unix time after which no aircraft moves until the next snapshot.
+    double settlesAt() const { return _settlesAt; }
+    // Changes whenever the positions may have, so that what is made from them
+    // can be kept until it does. Once everything settled, `advance` leaves them
+    // as they are and so does this.
+    uint64_t version() const { return _version; }
+    GeoCoord position( FlightSlot slot ) const {
+        return { fromMicroDegrees( _longitudeE6[ slot ] ),
+                 fromMicroDegrees( _latitudeE6[ slot ] ) };
+    }
+
+private:
+    void resize( size_t slotCount );
+
+    size_t _slotCount = 0;
+    int32_t _longitudeReachE6 = 0;
+    int32_t _latitudeReachE6 = 0;
+    double _settlesAt = 0;
+    // Whether the positions were last worked out after everything settled.
+    bool _settled = false;
+    uint64_t _version = 0;
+    // Times are seconds since `_epoch`, which moves to every snapshot so that
+    // floats keep sub-millisecond resolution.
+    double _epoch = 0;
+    std::vector< FlightId > _id;
+
+    // Position and time of the latest report, and velocity in micro-degrees per
+    // second.
+    std::vector< int32_t > _baseLongitudeE6;
+    std::vector< int32_t > _baseLatitudeE6;
+    std::vector< float > _baseTime;
+    std::vector< float > _longitudeRate;
+    std::vector< float > _latitudeRate;
+    // Offset from the extrapolated position at `_correctionStart`, in
+    // micro-degrees, fading to nothing over `blendSeconds`.
+    std::vector< float > _longitudeCorrection;
+    std::vector< float > _latitudeCorrection;
+    std::vector< float > _correctionStart;
+
+    std::vector< int32_t > _longitudeE6;
+    std::vector< int32_t > _latitudeE6;
+};
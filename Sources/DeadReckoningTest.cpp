@@ -0,0 +1,148 @@
+#include <cmath>
+#include <cstdlib>
+
+#include <doctest/doctest.h>
+
+#include "DeadReckoning.hpp"
+
+namespace {
+
+constexpr uint32_t t0 = 1752437660;
+
+StateVector
+moving( Icao24 icao24, double longitude, double latitude, float velocity, float track,
+        uint32_t lastContact = t0 ) {
+    StateVector stateVector;
+    stateVector.icao24 = icao24;
+    stateVector.longitudeE6 = toMicroDegrees( longitude );
+    stateVector.latitudeE6 = toMicroDegrees( latitude );
+    stateVector.velocity = velocity;
+    stateVector.trueTrack = track;
+    stateVector.lastContact = lastContact;
+    stateVector.positionAgeIs( 0 );
+    return stateVector;
+}
+
+void
+apply( FlightStore & flights, DeadReckoning & reckoning, double now,
+       std::initializer_list< StateVector > states ) {
+    flights.beginSnapshot();
+    for( const StateVector & stateVector : states ) {
+        flights.upsert( stateVector );
+    }
+    flights.endSnapshot();
+    reckoning.snapshotIs( flights, now );
+}
+
+} // namespace
+
+TEST_CASE( "dead reckoning moves aircraft along their track" ) {
+    FlightStore flights;
+    DeadReckoning reckoning;
+    StateVector parked = moving( 0x000003, -71.0, 42.0, 0, 0 );
+    StateVector unknown = moving( 0x000004, -71.0, 42.0, 200, 0 );
+    unknown.trueTrack = StateVector::missing;
+    StateVector nowhere = moving( 0x000005, 0, 0, 200, 0 );
+    nowhere.longitudeE6 = StateVector::missingE6;
+    nowhere.latitudeE6 = StateVector::missingE6;
+    apply( flights, reckoning, t0,
+           { moving( 0x000001, -71.0, 0.0, 100, 90 ), moving( 0x000002, -71.0, 42.0, 100, 0 ),
+             parked, unknown, nowhere } );
+    const FlightSlot east = flights.find( 0x000001 );
+    const FlightSlot north = flights.find( 0x000002 );
+    REQUIRE( reckoning.slotCount() == 5 );
+    CHECK( reckoning.longitudesE6()[ east ] == -71000000 );
+
+    reckoning.advance( t0 + 10 );
+    // 1 km at the equator is 8.99 thousandths of a degree either way; north of it
+    // only latitude moves.
+    CHECK( std::abs( reckoning.longitudesE6()[ east ] - ( -71000000 + 8993 ) ) <= 2 );
+    CHECK( std::abs( reckoning.latitudesE6()[ east ] ) <= 1 );
+    CHECK( std::abs( reckoning.latitudesE6()[ north ] - ( 42000000 + 8993 ) ) <= 2 );
+    CHECK( reckoning.longitudesE6()[ flights.find( 0x000003 ) ] == -71000000 );
+    CHECK( reckoning.longitudesE6()[ flights.find( 0x000004 ) ] == -71000000 );
+    CHECK( reckoning.longitudesE6()[ flights.find( 0x000005 ) ] == StateVector::missingE6 );
+
+    // Stale reports stop after `maxExtrapolation`, and the clock can't go back
+    // past the report.
+    reckoning.advance( t0 + 1000 );
+    const int32_t stopped = reckoning.latitudesE6()[ north ];
+    CHECK( std::abs( stopped - ( 42000000 + 8993 * 3 ) ) <= 5 );
+    reckoning.advance( t0 - 100 );
+    CHECK( reckoning.latitudesE6()[ north ] == 42000000 );
+
+    // Nothing gets further from its report than the reach.
+    CHECK( stopped - 42000000 <= reckoning.latitudeReachE6() );
+    CHECK( 8993 * 3 <= reckoning.longitudeReachE6() );
+    CHECK( reckoning.latitudeReachE6() <=
+           8993 * 3 + int32_t( DeadReckoning::maxCorrection ) + 10 );
+    // Nothing moves after the last moving report runs out.
+    CHECK( reckoning.settlesAt() == double( t0 ) + DeadReckoning::maxExtrapolation );
+    // From then on the positions, and their version, stay put.
+    reckoning.advance( t0 + 1000 );
+    const uint64_t settled = reckoning.version();
+    reckoning.advance( t0 + 2000 );
+    CHECK( reckoning.version() == settled );
+    CHECK( reckoning.latitudesE6()[ north ] == stopped );
+
+    // Parked aircraft never move.
+    apply( flights, reckoning, t0 + 60, { parked } );
+    CHECK( reckoning.settlesAt() == t0 + 60 );
+    CHECK( reckoning.version() != settled );
+}
+
+TEST_CASE( "dead reckoning blends into new reports" ) {
+    FlightStore flights;
+    DeadReckoning reckoning;
+    apply( flights, reckoning, t0, { moving( 0x000001, -71.0, 42.0, 100, 0 ) } );
+    const FlightSlot slot = flights.find( 0x000001 );
+    reckoning.advance( t0 + 5 );
+    const int32_t drawn = reckoning.latitudesE6()[ slot ];
+
+    // The new report puts the aircraft 100 m west of where it was heading.
+    const StateVector report =
+        moving( 0x000001, -71.0 - 0.0012, 42.0 + 0.0045, 100, 0, t0 + 5 );
+    apply( flights, reckoning, t0 + 5, { report } );
+    CHECK( reckoning.latitudesE6()[ slot ] == drawn );
+    CHECK( reckoning.settlesAt() == double( t0 + 5 ) + DeadReckoning::maxExtrapolation );
+    CHECK( std::abs( reckoning.longitudesE6()[ slot ] - -71000000 ) <= 1 );
+
+    // Halfway through the blend it is halfway over; after it, on the report's line.
+    reckoning.advance( t0 + 5.0 + DeadReckoning::blendSeconds / 2 );
+    CHECK( std::abs( reckoning.longitudesE6()[ slot ] - ( -71000000 - 600 ) ) <= 2 );
+    reckoning.advance( t0 + 5.0 + DeadReckoning::blendSeconds );
+    CHECK( reckoning.longitudesE6()[ slot ] == report.longitudeE6 );
+
+    SUBCASE( "jumps aren't blended" ) {
+        apply( flights, reckoning, t0 + 10,
+               { moving( 0x000001, -72.0, 42.0, 100, 0, t0 + 10 ) } );
+        CHECK( reckoning.longitudesE6()[ slot ] == -72000000 );
+    }
+    SUBCASE( "a new aircraft in a reused slot isn't blended" ) {
+        apply( flights, reckoning, t0 + 10, {} );
+        apply( flights, reckoning, t0 + 15,
+               { moving( 0x000002, -71.001, 42.0, 100, 0, t0 + 15 ) } );
+        REQUIRE( flights.find( 0x000002 ) == slot );
+        CHECK( reckoning.longitudesE6()[ slot ] == -71001000 );
+    }
+}
+
+TEST_CASE( "dead reckoning ignores impossible speeds" ) {
+    FlightStore flights;
+    DeadReckoning reckoning;
+    // Finite, but enough to overflow the rates near the pole.
+    apply( flights, reckoning, t0,
+           { moving( 0x000001, 179.9, 89.99, 3e38f, 45 ),
+             moving( 0x000002, -179.9, -89.99, -3e38f, 225 ),
+             moving( 0x000003, -71.0, 42.0, DeadReckoning::maxSpeed, 0 ) } );
+    reckoning.advance( t0 + 1000 );
+    CHECK( reckoning.longitudesE6()[ flights.find( 0x000001 ) ] == 179900000 );
+    CHECK( reckoning.latitudesE6()[ flights.find( 0x000001 ) ] == 89990000 );
+    CHECK( reckoning.longitudesE6()[ flights.find( 0x000002 ) ] == -179900000 );
+    CHECK( reckoning.latitudesE6()[ flights.find( 0x000002 ) ] == -89990000 );
+    // The fastest plausible aircraft still moves, and the reach covers it.
+    const int32_t fastest = reckoning.latitudesE6()[ flights.find( 0x000003 ) ] - 42000000;
+    CHECK( std::abs( fastest - 89932 * 3 ) <= 50 );
+    CHECK( fastest <= reckoning.latitudeReachE6() );
+    CHECK( reckoning.longitudeReachE6() <= 360 * microDegreesPerDegree );
+}
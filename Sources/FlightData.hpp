@@ -1,12 +1,12 @@
 #pragma once
 
+#include <cmath>
+#include <cstdint>
+#include <limits>
 #include <string>
 
-#include <nlohmann/json.hpp>
-
-#include "Dile/Dile.hpp"
-
-#include "Layout.hpp"
+#include "CallSign.hpp"
+#include "Icao24.hpp"
 #include "SizeTypes.hpp"
 
 struct GeoCoord {
@@ -15,6 +15,28 @@ struct GeoCoord {
 };
 std::string format_as( const GeoCoord & geoCoord );
 
+// Stored coordinates are fixed-point micro-degrees: about 11 cm of latitude per
+// unit, and the full +-180 degrees fit in an int32.
+constexpr double microDegreesPerDegree = 1e6;
+inline int32_t
+toMicroDegrees( double degrees ) {
+    return static_cast< int32_t >( std::lround( degrees * microDegreesPerDegree ) );
+}
+inline double
+fromMicroDegrees( int32_t microDegrees ) {
+    return microDegrees / microDegreesPerDegree;
+}
+
+// For the flat-earth approximations used over the few kilometers an aircraft
+// covers between reports, on a spherical earth.
+constexpr double pi = 3.14159265358979323846;
+constexpr double metersPerDegree = 6371000 * pi / 180;
+constexpr double metersPerMicroDegree = metersPerDegree / microDegreesPerDegree;
+inline double
+toRadians( double degrees ) {
+    return degrees * ( pi / 180 );
+}
+
 struct GeoBb {
     GeoCoord min;
     GeoCoord max;
@@ -22,30 +44,75 @@ struct GeoBb {
     Vector2 relativePosition( GeoCoord coord );
 };
 
-struct FlightData {
-    std::string callSign;
-    GeoCoord position;
-};
-std::string format_as( const FlightData & flightData );
-
-class OpenSky {
-public:
-    static FlightData parseState( const nlohmann::json & state );
-};
+// One aircraft's state vector from an OpenSky /states/all response, packed into
+// 48 bytes. Numbers the response leaves null are NaN or a sentinel. The origin
+// country and sensor ids aren't kept, and time_position is folded into
+// `positionAge`.
+struct StateVector {
+    static constexpr float missing = std::numeric_limits< float >::quiet_NaN();
+    static constexpr int32_t missingE6 = INT32_MIN;
+    static constexpr uint16_t noSquawk = UINT16_MAX;
+    // `positionAge` saturates here, which also stands for "unknown".
+    static constexpr uint8_t maxPositionAge = 15;
 
-class Radar: public ComponentV2 {
-public:
-    Radar( Dile::LayoutManager & layoutManager ): ComponentV2( layoutManager ) {};
+    Icao24 icao24 = invalidIcao24;
+    // Unix time of the last message from the transponder, 0 if unknown.
+    uint32_t lastContact = 0;
+    // Micro-degrees, `missingE6` if unknown.
+    int32_t longitudeE6 = missingE6;
+    int32_t latitudeE6 = missingE6;
+    // Meters.
+    float baroAltitude = missing;
+    float geoAltitude = missing;
+    // Ground speed in m/s.
+    float velocity = missing;
+    // Degrees clockwise from north.
+    float trueTrack = missing;
+    // m/s, positive when climbing.
+    float verticalRate = missing;
+    CallSign callSign;
+    // onGround:1 spi:1 positionSource:2 positionAge:4, from the low bit up.
+    uint8_t flags = maxPositionAge << positionAgeShift;
+    // The four octal digits as a number, e.g. 07700.
+    uint16_t squawk = noSquawk;
 
-    void flightDataPush( const FlightData & flightData ) {
-        _flightData.push_back( flightData );
+    bool onGround() const { return flags & onGroundBit; }
+    void onGroundIs( bool val ) { setBits( onGroundBit, val ? onGroundBit : 0 ); }
+    bool spi() const { return flags & spiBit; }
+    void spiIs( bool val ) { setBits( spiBit, val ? spiBit : 0 ); }
+    // 0 ADS-B, 1 ASTERIX, 2 MLAT, 3 FLARM.
+    uint8_t positionSource() const {
+        return ( flags & positionSourceMask ) >> positionSourceShift;
+    }
+    void positionSourceIs( uint8_t val ) {
+        setBits( positionSourceMask, ( val << positionSourceShift ) & positionSourceMask );
+    }
+    // Whole seconds between the last position update and `lastContact`.
+    uint8_t positionAge() const { return flags >> positionAgeShift; }
+    void positionAgeIs( int64_t seconds ) {
+        const int64_t age = seconds < 0 || seconds > maxPositionAge ? maxPositionAge
+                                                                    : seconds;
+        setBits( positionAgeMask, static_cast< uint8_t >( age << positionAgeShift ) );
     }
-    void geoBbIs( const GeoBb & val ) { _geoBb = val; }
 
-    void drawFlight( Vector2 radarAt, Vector2 mousePos, FlightData flightData );
-    void draw( const DrawContext & ctx ) override;
+    bool hasPosition() const {
+        return longitudeE6 != missingE6 && latitudeE6 != missingE6;
+    }
+    GeoCoord position() const {
+        return { fromMicroDegrees( longitudeE6 ), fromMicroDegrees( latitudeE6 ) };
+    }
 
 private:
-    std::vector< FlightData > _flightData;
-    GeoBb _geoBb;
+    static constexpr uint8_t onGroundBit = 1 << 0;
+    static constexpr uint8_t spiBit = 1 << 1;
+    static constexpr int positionSourceShift = 2;
+    static constexpr uint8_t positionSourceMask = 0x3 << positionSourceShift;
+    static constexpr int positionAgeShift = 4;
+    static constexpr uint8_t positionAgeMask = 0xf << positionAgeShift;
+
+    void setBits( uint8_t mask, uint8_t bits ) {
+        flags = static_cast< uint8_t >( ( flags & ~mask ) | bits );
+    }
 };
+static_assert( sizeof( StateVector ) == 48 );
+std::string format_as( const StateVector & stateVector );
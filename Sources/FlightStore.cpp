@@ -0,0 +1,143 @@
+#include "FlightStore.hpp"
+
+FlightSlot
+FlightStore::insert( const StateVector & stateVector ) {
+    FlightSlot slot;
+    if( !_freeSlots.empty() ) {
+        slot = _freeSlots.back();
+        _freeSlots.pop_back();
+    } else {
+        slot = static_cast< FlightSlot >( slotCount() );
+        _live.push_back( 0 );
+        _longitudeE6.push_back( 0 );
+        _latitudeE6.push_back( 0 );
+        _baroAltitude.push_back( 0 );
+        _geoAltitude.push_back( 0 );
+        _velocity.push_back( 0 );
+        _trueTrack.push_back( 0 );
+        _verticalRate.push_back( 0 );
+        _lastContact.push_back( 0 );
+        _flags.push_back( 0 );
+        _squawk.push_back( 0 );
+        _callSign.emplace_back();
+        _id.push_back( 0 );
+        _icao24.push_back( invalidIcao24 );
+        _seenIn.push_back( 0 );
+    }
+
+    _live[ slot ] = 1;
+    assign( slot, stateVector );
+    _id[ slot ] = _nextId++;
+    _icao24[ slot ] = stateVector.icao24;
+    _seenIn[ slot ] = _snapshot;
+    if( stateVector.icao24 != invalidIcao24 ) {
+        const bool inserted = _index.insert( stateVector.icao24, slot );
+        assert( inserted && "use upsert for aircraft that may be stored already" );
+        (void)inserted;
+    }
+    ++_size;
+    return slot;
+}
+
+void
+FlightStore::erase( FlightSlot slot ) {
+    assert( live( slot ) );
+    if( _icao24[ slot ] != invalidIcao24 ) {
+        _index.erase( _icao24[ slot ] );
+    }
+    _live[ slot ] = 0;
+    _freeSlots.push_back( slot );
+    --_size;
+}
+
+void
+FlightStore::clear() {
+    _live.clear();
+    _longitudeE6.clear();
+    _latitudeE6.clear();
+    _baroAltitude.clear();
+    _geoAltitude.clear();
+    _velocity.clear();
+    _trueTrack.clear();
+    _verticalRate.clear();
+    _lastContact.clear();
+    _flags.clear();
+    _squawk.clear();
+    _callSign.clear();
+    _id.clear();
+    _icao24.clear();
+    _seenIn.clear();
+    _index.clear();
+    _freeSlots.clear();
+    _size = 0;
+}
+
+void
+FlightStore::beginSnapshot() {
+    ++_snapshot;
+    _changes.inserted.clear();
+    _changes.removed.clear();
+    _changes.updated = 0;
+}
+
+FlightSlot
+FlightStore::upsert( const StateVector & stateVector ) {
+    if( stateVector.icao24 == invalidIcao24 ) {
+        return invalidSlot;
+    }
+    const FlightSlot slot = _index.find( stateVector.icao24 );
+    if( slot == invalidSlot ) {
+        const FlightSlot inserted = insert( stateVector );
+        _changes.inserted.push_back( inserted );
+        return inserted;
+    }
+    assign( slot, stateVector );
+    _seenIn[ slot ] = _snapshot;
+    ++_changes.updated;
+    return slot;
+}
+
+const FlightStore::SnapshotChanges &
+FlightStore::endSnapshot() {
+    for( FlightSlot slot = 0; slot < slotCount(); ++slot ) {
+        if( _live[ slot ] && _seenIn[ slot ] != _snapshot ) {
+            erase( slot );
+            _changes.removed.push_back( slot );
+        }
+    }
+    return _changes;
+}
+
+StateVector
+FlightStore::stateVector( FlightSlot slot ) const {
+    assert( live( slot ) );
+    StateVector stateVector;
+    stateVector.icao24 = _icao24[ slot ];
+    stateVector.lastContact = _lastContact[ slot ];
+    stateVector.longitudeE6 = _longitudeE6[ slot ];
+    stateVector.latitudeE6 = _latitudeE6[ slot ];
+    stateVector.baroAltitude = _baroAltitude[ slot ];
+    stateVector.geoAltitude = _geoAltitude[ slot ];
+    stateVector.velocity = _velocity[ slot ];
+    stateVector.trueTrack = _trueTrack[ slot ];
+    stateVector.verticalRate = _verticalRate[ slot ];
+    stateVector.callSign = _callSign[ slot ];
+    stateVector.flags = _flags[ slot ];
+    stateVector.squawk = _squawk[ slot ];
+    return stateVector;
+}
+
+void
+FlightStore::assign( FlightSlot slot, const StateVector & stateVector ) {
+    _longitudeE6[ slot ] = stateVector.longitudeE6;
+    _latitudeE6[ slot ] = stateVector.latitudeE6;
+    _baroAltitude[ slot ] = stateVector.baroAltitude;
+    _geoAltitude[ slot ] = stateVector.geoAltitude;
+    _velocity[ slot ] = stateVector.velocity;
+    _trueTrack[ slot ] = stateVector.trueTrack;
+    _verticalRate[ slot ] = stateVector.verticalRate;
+    _lastContact[ slot ] = stateVector.lastContact;
+    _flags[ slot ] = stateVector.flags;
+    _squawk[ slot ] = stateVector.squawk;
+    _callSign[ slot ] = stateVector.callSign;
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <assert.h>
+#include <cstdint>
+#include <vector>
+
+#include "FlightData.hpp"
+#include "Icao24.hpp"
+
+using FlightSlot = uint32_t;
+using FlightId = uint32_t;
+
+// Struct-of-arrays storage for tracked aircraft. Every aircraft owns a slot whose
+// index stays the same for as long as the aircraft is stored, so per-frame passes
+// walk only the columns they need and other structures can refer to an aircraft
+// by slot. Slots freed by `erase` are reused by later inserts; the id column tells
+// the old and new occupant apart.
+//
+// Aircraft with a valid icao24 address are also indexed by it, which is how
+// snapshots are applied: `beginSnapshot`, `upsert` every state of the snapshot,
+// then `endSnapshot` erases the aircraft the snapshot no longer mentions.
+class FlightStore {
+public:
+    static constexpr FlightSlot invalidSlot = UINT32_MAX;
+
+    // What applying one snapshot changed. Removed slots are already free, but keep
+    // their last values until the next insert reuses them.
+    struct SnapshotChanges {
+        std::vector< FlightSlot > inserted;
+        std::vector< FlightSlot > removed;
+        size_t updated = 0;
+    };
+
+    FlightSlot insert( const StateVector & stateVector );
+    void erase( FlightSlot slot );
+    void clear();
+
+    FlightSlot find( Icao24 icao24 ) const { return _index.find( icao24 ); }
+
+    void beginSnapshot();
+    // Updates the aircraft with `stateVector.icao24` in place, or inserts it. States
+    // without a valid address can't be tracked across snapshots and are dropped.
+    FlightSlot upsert( const StateVector & stateVector );
+    const SnapshotChanges & endSnapshot();
+
+    void positionIs( FlightSlot slot, const GeoCoord & position ) {
+        assert( live( slot ) );
+        _longitudeE6[ slot ] = toMicroDegrees( position.longitude );
+        _latitudeE6[ slot ] = toMicroDegrees( position.latitude );
+    }
+
+    // Number of slots, live or free. Every column is this long.
+    size_t slotCount() const { return _live.size(); }
+    // Number of live aircraft.
+    size_t size() const { return _size; }
+    bool live( FlightSlot slot ) const {
+        return slot < slotCount() && _live[ slot ];
+    }
+
+    const std::vector< uint8_t > & liveMask() const { return _live; }
+    // Micro-degrees, `StateVector::missingE6` until the aircraft reports a position.
+    const std::vector< int32_t > & longitudesE6() const { return _longitudeE6; }
+    const std::vector< int32_t > & latitudesE6() const { return _latitudeE6; }
+    const std::vector< float > & baroAltitudes() const { return _baroAltitude; }
+    const std::vector< float > & geoAltitudes() const { return _geoAltitude; }
+    const std::vector< float > & velocities() const { return _velocity; }
+    const std::vector< float > & trueTracks() const { return _trueTrack; }
+    const std::vector< float > & verticalRates() const { return _verticalRate; }
+    const std::vector< uint32_t > & lastContacts() const { return _lastContact; }
+    // `StateVector::flags`.
+    const std::vector< uint8_t > & stateFlags() const { return _flags; }
+    const std::vector< uint16_t > & squawks() const { return _squawk; }
+    const std::vector< CallSign > & callSigns() const { return _callSign; }
+    const std::vector< FlightId > & ids() const { return _id; }
+    const std::vector< Icao24 > & icao24s() const { return _icao24; }
+
+    GeoCoord position( FlightSlot slot ) const {
+        return { fromMicroDegrees( _longitudeE6[ slot ] ),
+                 fromMicroDegrees( _latitudeE6[ slot ] ) };
+    }
+    // Gathers the columns of `slot` back into a record.
+    StateVector stateVector( FlightSlot slot ) const;
+
+private:
+    // Copies everything but the icao24 address, which is fixed for a slot's
+    // occupant, into the columns of `slot`.
+    void assign( FlightSlot slot, const StateVector & stateVector );
+
+    std::vector< uint8_t > _live;
+    std::vector< int32_t > _longitudeE6;
+    std::vector< int32_t > _latitudeE6;
+    std::vector< float > _baroAltitude;
+    std::vector< float > _geoAltitude;
+    std::vector< float > _velocity;
+    std::vector< float > _trueTrack;
+    std::vector< float > _verticalRate;
+    std::vector< uint32_t > _lastContact;
+    std::vector< uint8_t > _flags;
+    std::vector< uint16_t > _squawk;
+    std::vector< CallSign > _callSign;
+    std::vector< FlightId > _id;
+    std::vector< Icao24 > _icao24;
+    // The snapshot each aircraft was last seen in.
+    std::vector< uint32_t > _seenIn;
+
+    Icao24Map _index;
+    uint32_t _snapshot = 0;
+    SnapshotChanges _changes;
+
+    std::vector< FlightSlot > _freeSlots;
+    FlightId _nextId = 0;
+    size_t _size = 0;
+};
+static_assert( Icao24Map::notFound == FlightStore::invalidSlot );
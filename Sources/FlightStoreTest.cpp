@@ -0,0 +1,102 @@
+#include <cstring>
+
+#include <doctest/doctest.h>
+
+#include "FlightStore.hpp"
+
+namespace {
+
+StateVector
+makeFlight( const char * callSign, double longitude, double latitude ) {
+    StateVector stateVector;
+    stateVector.callSign = CallSign::fromTrimmed( callSign );
+    stateVector.longitudeE6 = toMicroDegrees( longitude );
+    stateVector.latitudeE6 = toMicroDegrees( latitude );
+    return stateVector;
+}
+
+} // namespace
+
+TEST_CASE( "flight store keeps slots stable" ) {
+    FlightStore store;
+    const FlightSlot a = store.insert( makeFlight( "JBU1235", -71.0, 42.3 ) );
+    const FlightSlot b = store.insert( makeFlight( "DAL1724", -71.1, 42.4 ) );
+    const FlightSlot c = store.insert( makeFlight( "BAW1B", -70.9, 42.2 ) );
+    REQUIRE( store.size() == 3 );
+    CHECK( store.callSigns()[ b ].view() == "DAL1724" );
+
+    store.positionIs( b, { -71.2, 42.5 } );
+    store.erase( a );
+    CHECK( store.size() == 2 );
+    CHECK_FALSE( store.live( a ) );
+    CHECK( store.live( b ) );
+    CHECK( store.longitudesE6()[ b ] == -71200000 );
+    CHECK( store.latitudesE6()[ b ] == 42500000 );
+    CHECK( store.position( b ).longitude == -71.2 );
+    CHECK( store.callSigns()[ c ].view() == "BAW1B" );
+
+    SUBCASE( "freed slots are reused with a new id" ) {
+        const FlightId oldId = store.ids()[ a ];
+        const FlightSlot d = store.insert( makeFlight( "N143NE", -71.0, 42.3 ) );
+        CHECK( d == a );
+        CHECK( store.ids()[ d ] != oldId );
+        CHECK( store.slotCount() == 3 );
+        CHECK( store.stateVector( d ).callSign.view() == "N143NE" );
+    }
+}
+
+TEST_CASE( "icao24 map survives churn" ) {
+    Icao24Map map;
+    for( Icao24 key = 0; key < 5000; ++key ) {
+        CHECK( map.insert( key * 7, key ) );
+    }
+    CHECK_FALSE( map.insert( 7, 0 ) );
+    for( Icao24 key = 0; key < 5000; key += 2 ) {
+        CHECK( map.erase( key * 7 ) );
+    }
+    CHECK( map.size() == 2500 );
+    for( Icao24 key = 0; key < 5000; ++key ) {
+        CHECK( map.find( key * 7 ) == ( key % 2 ? key : Icao24Map::notFound ) );
+    }
+}
+
+TEST_CASE( "snapshots upsert by icao24" ) {
+    FlightStore store;
+    StateVector a = makeFlight( "JBU1235", -71.0, 42.3 );
+    a.icao24 = 0xad4804;
+    StateVector b = makeFlight( "DAL1724", -71.1, 42.4 );
+    b.icao24 = 0xa38c66;
+
+    store.beginSnapshot();
+    const FlightSlot slotA = store.upsert( a );
+    const FlightSlot slotB = store.upsert( b );
+    CHECK( store.endSnapshot().inserted.size() == 2 );
+
+    // `a` moves, `b` disappears and `c` shows up.
+    a.longitudeE6 = -71050000;
+    a.latitudeE6 = 42350000;
+    a.velocity = 72.5f;
+    a.squawk = 01200;
+    StateVector c = makeFlight( "BAW1B", -70.9, 42.2 );
+    c.icao24 = 0x405bfe;
+    store.beginSnapshot();
+    CHECK( store.upsert( a ) == slotA );
+    store.upsert( c );
+    const FlightStore::SnapshotChanges & changes = store.endSnapshot();
+    CHECK( changes.updated == 1 );
+    REQUIRE( changes.inserted.size() == 1 );
+    REQUIRE( changes.removed.size() == 1 );
+    CHECK( changes.removed[ 0 ] == slotB );
+
+    CHECK( store.size() == 2 );
+    CHECK( store.longitudesE6()[ slotA ] == -71050000 );
+    CHECK( store.velocities()[ slotA ] == 72.5f );
+    CHECK( store.squawks()[ slotA ] == 01200 );
+    const StateVector gathered = store.stateVector( slotA );
+    CHECK( std::memcmp( &gathered, &a, sizeof( a ) ) == 0 );
+    CHECK( store.find( 0xa38c66 ) == FlightStore::invalidSlot );
+    CHECK( store.find( 0x405bfe ) == changes.inserted[ 0 ] );
+
+    StateVector anonymous = makeFlight( "N143NE", -71.0, 42.3 );
+    CHECK( store.upsert( anonymous ) == FlightStore::invalidSlot );
+}
@@ -0,0 +1,33 @@
+#include <algorithm>
+
+#include "FrameScheduler.hpp"
+
+bool
+FrameScheduler::due( double now ) const {
+    if( !_invalid && !_animating ) {
+        return false;
+    }
+    return !_drawnOnce || _maxFps <= 0 || now >= nextFrame();
+}
+
+double
+FrameScheduler::wait( double now ) const {
+    if( !_invalid && !_animating ) {
+        return _drawnOnce && now - _lastFrame < activeSeconds ? activeWait : idleWait;
+    }
+    if( !_drawnOnce || _maxFps <= 0 ) {
+        return 0;
+    }
+    // The same sum as in `due`, so that waiting this long makes a frame due.
+    return std::clamp( nextFrame() - now, 0.0, 1 / _maxFps );
+}
+
+double
+FrameScheduler::drawn( double now ) {
+    const double elapsed = _drawnOnce ? std::max( now - _lastFrame, 0.0 ) : 0;
+    _lastFrame = now;
+    _drawnOnce = true;
+    _invalid = false;
+    ++_frames;
+    return elapsed;
+}
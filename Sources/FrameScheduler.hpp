@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+
+// Decides when a window needs drawing, so that a window nobody touches and
+// nothing moves in sleeps instead of drawing the same picture at the refresh
+// rate. A frame is drawn after something changed what the window shows, such
+// as input, new data or a resize, and for as long as something on it moves by
+// itself. Frames can be capped to `maxFps`; between them, and while idle, the
+// loop waits `wait` seconds before looking for changes again.
+//
+// Times are seconds on any steady clock, such as `rl::GetTime`.
+class FrameScheduler {
+public:
+    // How often an idle loop looks for changes that don't wake it, such as new
+    // data or input during a sleep. For `activeSeconds` after a frame that is
+    // every frame at 60 Hz, so that the cursor and keys get answered as if it
+    // drew; after that a few times a second, which is soon enough for data that
+    // comes every few seconds and nearly free.
+    static constexpr double activeWait = 1.0 / 60;
+    static constexpr double activeSeconds = 1;
+    static constexpr double idleWait = 0.25;
+
+    // Frames are at least 1 / `val` seconds apart; 0 doesn't cap them.
+    void maxFpsIs( double val ) { _maxFps = val; }
+    double maxFps() const { return _maxFps; }
+    // What is shown changed; the next frame is drawn as soon as it is due.
+    void invalidate() { _invalid = true; }
+    // Whether something moves by itself as of the frame just drawn, and so
+    // needs another one.
+    void animatingIs( bool val ) { _animating = val; }
+    bool animating() const { return _animating; }
+
+    // Whether to draw a frame at `now`.
+    bool due( double now ) const;
+    // How long to wait at `now` before looking again: until the next frame is
+    // due if one is wanted, else `activeWait` or `idleWait`.
+    double wait( double now ) const;
+    // Records a frame drawn at `now`, and returns the seconds since the last
+    // one, 0 for the first.
+    double drawn( double now );
+
+    uint64_t frames() const { return _frames; }
+
+private:
+    // When the next frame may be drawn under `maxFps`.
+    double nextFrame() const { return _lastFrame + 1 / _maxFps; }
+
+    double _maxFps = 0;
+    bool _invalid = true;
+    bool _animating = false;
+    bool _drawnOnce = false;
+    double _lastFrame = 0;
+    uint64_t _frames = 0;
+};
@@ -0,0 +1,75 @@
+#include <doctest/doctest.h>
+
+#include "FrameScheduler.hpp"
+
+TEST_CASE( "frame scheduler draws only when something changed or moves" ) {
+    FrameScheduler frames;
+    // The first frame is always drawn.
+    CHECK( frames.due( 100 ) );
+    CHECK( frames.wait( 100 ) == 0 );
+    CHECK( frames.drawn( 100 ) == 0 );
+
+    // Idle: nothing to draw, and the loop looks again a frame later, or once it
+    // has been idle for a while, a little later.
+    CHECK( !frames.due( 100.5 ) );
+    CHECK( frames.wait( 100.5 ) == FrameScheduler::activeWait );
+    CHECK( frames.wait( 101.5 ) == FrameScheduler::idleWait );
+    CHECK( !frames.due( 130 ) );
+
+    // Input, data or a resize: one frame, which knows how long it has been.
+    frames.invalidate();
+    CHECK( frames.due( 130 ) );
+    CHECK( frames.drawn( 130 ) == 30 );
+    CHECK( !frames.due( 130.1 ) );
+
+    // Uncapped, an animation draws whenever the loop comes round.
+    frames.animatingIs( true );
+    CHECK( frames.due( 130.001 ) );
+    CHECK( frames.wait( 130.001 ) == 0 );
+    frames.drawn( 130.001 );
+
+    // Capped at 10 fps, it waits out the rest of each tenth of a second, and so
+    // does input.
+    frames.maxFpsIs( 10 );
+    CHECK( !frames.due( 130.05 ) );
+    CHECK( frames.wait( 130.05 ) == doctest::Approx( 0.051 ) );
+    frames.invalidate();
+    CHECK( !frames.due( 130.05 ) );
+    CHECK( frames.due( 130.102 ) );
+    CHECK( frames.drawn( 130.102 ) == doctest::Approx( 0.101 ) );
+
+    // Once it stops, so do frames.
+    frames.animatingIs( false );
+    CHECK( !frames.due( 131 ) );
+    CHECK( frames.wait( 131 ) == FrameScheduler::activeWait );
+    CHECK( frames.wait( 132 ) == FrameScheduler::idleWait );
+    CHECK( frames.frames() == 4 );
+}
+
+TEST_CASE( "frame scheduler lets an idle window sleep" ) {
+    // A loop like the radar's, capped at 30 fps: a snapshot sets aircraft
+    // moving for 30 s, and then nothing happens for ten minutes.
+    FrameScheduler frames;
+    frames.maxFpsIs( 30 );
+    const double settlesAt = 30;
+    double now = 0;
+    uint64_t moving = 0;
+    uint64_t idleFrames = 0;
+    uint64_t idleWakeups = 0;
+    while( now < 630 ) {
+        if( now >= settlesAt + FrameScheduler::activeSeconds ) {
+            ++idleWakeups;
+        }
+        if( frames.due( now ) ) {
+            frames.drawn( now );
+            frames.animatingIs( now < settlesAt );
+            ++( now < settlesAt ? moving : idleFrames );
+        } else {
+            now += frames.wait( now );
+        }
+    }
+    CHECK( moving == doctest::Approx( 30 * 30 ).epsilon( 0.01 ) );
+    // The frame that found everything settled is the last one.
+    CHECK( idleFrames == 1 );
+    CHECK( idleWakeups <= uint64_t( 600 / FrameScheduler::idleWait ) );
+}
@@ -0,0 +1,132 @@
+#include <algorithm>
+
+#include "GeoGrid.hpp"
+#include "Simd.hpp"
+
+GeoGrid::GeoGrid(): _head( size_t( columns ) * rows, FlightStore::invalidSlot ) {}
+
+void
+GeoGrid::clear() {
+    std::fill( _head.begin(), _head.end(), FlightStore::invalidSlot );
+    std::fill( _cell.begin(), _cell.end(), noCell );
+    std::fill( _cornerLongitudeE6.begin(), _cornerLongitudeE6.end(), noCorner );
+    std::fill( _cornerLatitudeE6.begin(), _cornerLatitudeE6.end(), noCorner );
+    _size = 0;
+}
+
+int32_t
+GeoGrid::columnOf( int32_t longitudeE6 ) {
+    // Widened, so that the slack can't overflow.
+    const int64_t column = ( int64_t( longitudeE6 ) + 180 * cellE6 ) / cellE6;
+    return int32_t( std::clamp< int64_t >( column, 0, columns - 1 ) );
+}
+
+int32_t
+GeoGrid::rowOf( int32_t latitudeE6 ) {
+    const int64_t row = ( int64_t( latitudeE6 ) + 90 * cellE6 ) / cellE6;
+    return int32_t( std::clamp< int64_t >( row, 0, rows - 1 ) );
+}
+
+void
+GeoGrid::link( FlightSlot slot, uint32_t cell ) {
+    const FlightSlot head = _head[ cell ];
+    _cell[ slot ] = cell;
+    _cornerLongitudeE6[ slot ] = int32_t( cell % columns ) * cellE6 - 180 * cellE6;
+    _cornerLatitudeE6[ slot ] = int32_t( cell / columns ) * cellE6 - 90 * cellE6;
+    _previous[ slot ] = FlightStore::invalidSlot;
+    _next[ slot ] = head;
+    if( head != FlightStore::invalidSlot ) {
+        _previous[ head ] = slot;
+    }
+    _head[ cell ] = slot;
+    ++_size;
+}
+
+void
+GeoGrid::unlink( FlightSlot slot ) {
+    const FlightSlot previous = _previous[ slot ];
+    const FlightSlot next = _next[ slot ];
+    if( previous != FlightStore::invalidSlot ) {
+        _next[ previous ] = next;
+    } else {
+        _head[ _cell[ slot ] ] = next;
+    }
+    if( next != FlightStore::invalidSlot ) {
+        _previous[ next ] = previous;
+    }
+    _cell[ slot ] = noCell;
+    _cornerLongitudeE6[ slot ] = noCorner;
+    _cornerLatitudeE6[ slot ] = noCorner;
+    --_size;
+}
+
+void
+GeoGrid::place( FlightSlot slot, bool present ) {
+    ++_relinked;
+    if( _cell[ slot ] != noCell ) {
+        unlink( slot );
+    }
+    if( present ) {
+        const int32_t row = rowOf( _latitudesE6[ slot ] );
+        link( slot, uint32_t( row * columns + columnOf( _longitudesE6[ slot ] ) ) );
+    }
+}
+
+void
+GeoGrid::update( const int32_t * longitudesE6, const int32_t * latitudesE6,
+                 const uint8_t * live, size_t slotCount ) {
+    _longitudesE6 = longitudesE6;
+    _latitudesE6 = latitudesE6;
+    _relinked = 0;
+    // Slots past the end are gone.
+    for( FlightSlot slot = FlightSlot( slotCount ); slot < _cell.size(); ++slot ) {
+        if( _cell[ slot ] != noCell ) {
+            unlink( slot );
+        }
+    }
+    _cell.resize( slotCount, noCell );
+    _cornerLongitudeE6.resize( slotCount, noCorner );
+    _cornerLatitudeE6.resize( slotCount, noCorner );
+    _next.resize( slotCount );
+    _previous.resize( slotCount );
+
+    // A slot is stale if it should be in the grid but strayed out of its loose
+    // cell, or shouldn't be but is. Missing positions are never near a corner.
+    using namespace Simd;
+    const Int4 low = splat( -slackE6 );
+    const Int4 high = splat( cellE6 + slackE6 );
+    const Int4 missing = splat( StateVector::missingE6 );
+    const Int4 outside = splat( noCorner );
+    size_t slot = 0;
+    for( ; slot + lanes <= slotCount; slot += lanes ) {
+        const Int4 longitude = load( longitudesE6 + slot );
+        const Int4 corner = load( &_cornerLongitudeE6[ slot ] );
+        const Int4 east = ( Int4 )( ( Uint4 )longitude - ( Uint4 )corner );
+        const Int4 north = ( Int4 )( ( Uint4 )load( latitudesE6 + slot ) -
+                                     ( Uint4 )load( &_cornerLatitudeE6[ slot ] ) );
+        const Int4 present = ( Int4{ live[ slot ], live[ slot + 1 ], live[ slot + 2 ],
+                                     live[ slot + 3 ] } != 0 ) &
+                             ( longitude != missing );
+        const Int4 inside = ( east >= low ) & ( east < high ) & ( north >= low ) &
+                            ( north < high );
+        const Int4 stale = ( present & ~inside ) | ( ~present & ( corner != outside ) );
+        if( stale[ 0 ] | stale[ 1 ] | stale[ 2 ] | stale[ 3 ] ) {
+            for( size_t lane = 0; lane < lanes; ++lane ) {
+                if( stale[ lane ] ) {
+                    place( FlightSlot( slot + lane ), present[ lane ] );
+                }
+            }
+        }
+    }
+    for( ; slot < slotCount; ++slot ) {
+        const int32_t longitude = longitudesE6[ slot ];
+        const bool present = live[ slot ] && longitude != StateVector::missingE6;
+        const int64_t east = int64_t( longitude ) - _cornerLongitudeE6[ slot ];
+        const int64_t north = int64_t( latitudesE6[ slot ] ) - _cornerLatitudeE6[ slot ];
+        const bool inside = east >= -slackE6 && east < cellE6 + slackE6 &&
+                            north >= -slackE6 && north < cellE6 + slackE6;
+        if( present ? !inside : _cell[ slot ] != noCell ) {
+            place( slot, present );
+        }
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "FlightData.hpp"
+#include "FlightStore.hpp"
+
+// Which aircraft are inside a geographic box, so that the radar only projects
+// and draws the ones in view. The world is cut into `cellE6` square cells, each
+// with a doubly linked list of the slots in it threaded through per-slot
+// columns, like PickGrid's.
+//
+// The grid is loose: a slot stays in its cell until it strays more than
+// `slackE6` outside it, and queries widen their box by as much. Aircraft cover
+// a few hundredths of a cell between snapshots and one flying along a cell
+// edge isn't relinked back and forth, so `update` is a vectorized pass that
+// relinks almost nothing.
+class GeoGrid {
+public:
+    static constexpr int32_t cellE6 = 1000000;
+    static constexpr int32_t slackE6 = cellE6 / 4;
+    static constexpr int32_t columns = 360;
+    static constexpr int32_t rows = 180;
+
+    GeoGrid();
+
+    // Moves every slot below `slotCount` to the cell of its position, or out of
+    // the grid if it isn't live or has no position. Queries read the positions
+    // from `longitudesE6` and `latitudesE6`, which must outlive them.
+    void update( const int32_t * longitudesE6, const int32_t * latitudesE6,
+                 const uint8_t * live, size_t slotCount );
+    void clear();
+
+    // Calls `fn( FlightSlot )` for every slot inside `box`, in no particular
+    // order.
+    template< typename Fn >
+    void forEachWithin( const GeoBb & box, Fn && fn ) const {
+        const int32_t west = toMicroDegrees( box.min.longitude );
+        const int32_t south = toMicroDegrees( box.min.latitude );
+        const int32_t east = toMicroDegrees( box.max.longitude );
+        const int32_t north = toMicroDegrees( box.max.latitude );
+        const int32_t firstColumn = columnOf( west - slackE6 );
+        const int32_t lastColumn = columnOf( east + slackE6 );
+        const int32_t firstRow = rowOf( south - slackE6 );
+        const int32_t lastRow = rowOf( north + slackE6 );
+        for( int32_t row = firstRow; row <= lastRow; ++row ) {
+            for( int32_t column = firstColumn; column <= lastColumn; ++column ) {
+                for( FlightSlot slot = _head[ row * columns + column ];
+                     slot != FlightStore::invalidSlot; slot = _next[ slot ] ) {
+                    const int32_t longitude = _longitudesE6[ slot ];
+                    const int32_t latitude = _latitudesE6[ slot ];
+                    if( longitude >= west && longitude <= east && latitude >= south &&
+                        latitude <= north ) {
+                        fn( slot );
+                    }
+                }
+            }
+        }
+    }
+
+    size_t size() const { return _size; }
+    // Slots the last `update` moved in, out or between cells.
+    size_t relinked() const { return _relinked; }
+
+private:
+    static constexpr uint32_t noCell = UINT32_MAX;
+    // The corner of slots outside the grid: far enough from any position that
+    // none is ever within the slack of it.
+    static constexpr int32_t noCorner = 1000000000;
+
+    static int32_t columnOf( int32_t longitudeE6 );
+    static int32_t rowOf( int32_t latitudeE6 );
+    void link( FlightSlot slot, uint32_t cell );
+    void unlink( FlightSlot slot );
+    // Relinks `slot` into the cell its position is in, or out of the grid.
+    void place( FlightSlot slot, bool present );
+
+    size_t _size = 0;
+    size_t _relinked = 0;
+    // First slot of each cell's list, row by row from the south west.
+    std::vector< FlightSlot > _head;
+
+    // Per slot: its cell, the south west corner of that cell, and its
+    // neighbours in the cell's list.
+    std::vector< uint32_t > _cell;
+    std::vector< int32_t > _cornerLongitudeE6;
+    std::vector< int32_t > _cornerLatitudeE6;
+    std::vector< FlightSlot > _next;
+    std::vector< FlightSlot > _previous;
+    // The positions of the last `update`.
+    const int32_t * _longitudesE6 = nullptr;
+    const int32_t * _latitudesE6 = nullptr;
+};
@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <vector>
+
+#include <doctest/doctest.h>
+
+#include "GeoGrid.hpp"
+#include "Synthetic.hpp"
+
+namespace {
+
+struct Columns {
+    std::vector< int32_t > longitudes;
+    std::vector< int32_t > latitudes;
+    std::vector< uint8_t > live;
+
+    void add( double longitude, double latitude, bool isLive = true ) {
+        longitudes.push_back( toMicroDegrees( longitude ) );
+        latitudes.push_back( toMicroDegrees( latitude ) );
+        live.push_back( isLive );
+    }
+    void update( GeoGrid & grid ) const {
+        grid.update( longitudes.data(), latitudes.data(), live.data(), live.size() );
+    }
+};
+
+std::vector< FlightSlot >
+within( const GeoGrid & grid, const GeoBb & box ) {
+    std::vector< FlightSlot > slots;
+    grid.forEachWithin( box, [ & ]( FlightSlot slot ) { slots.push_back( slot ); } );
+    std::sort( slots.begin(), slots.end() );
+    return slots;
+}
+
+const GeoBb boston = { { -71.245840, 42.183094 }, { -70.777170, 42.529427 } };
+
+} // namespace
+
+TEST_CASE( "geo grid finds the aircraft in a box" ) {
+    GeoGrid grid;
+    Columns columns;
+    columns.add( -71.0, 42.3 );
+    columns.add( -70.9, 42.4 );
+    columns.add( -73.8, 40.6 );
+    columns.add( -71.1, 42.2, false );
+    columns.add( 2.5, 49.0 );
+    // No position yet.
+    columns.longitudes.push_back( StateVector::missingE6 );
+    columns.latitudes.push_back( StateVector::missingE6 );
+    columns.live.push_back( 1 );
+    columns.update( grid );
+    CHECK( grid.size() == 4 );
+    CHECK( grid.relinked() == 4 );
+    CHECK( within( grid, boston ) == std::vector< FlightSlot >{ 0, 1 } );
+    CHECK( within( grid, { { -180, -90 }, { 180, 90 } } ) ==
+           std::vector< FlightSlot >{ 0, 1, 2, 4 } );
+
+    // Small moves stay in the cell, even across its edge.
+    columns.longitudes[ 0 ] = toMicroDegrees( -70.95 );
+    columns.longitudes[ 1 ] = toMicroDegrees( -71.05 );
+    columns.update( grid );
+    CHECK( grid.relinked() == 0 );
+    CHECK( within( grid, boston ) == std::vector< FlightSlot >{ 0, 1 } );
+    CHECK( within( grid, { { -71.1, 42.2 }, { -71.0, 42.5 } } ) ==
+           std::vector< FlightSlot >{ 1 } );
+
+    // Far moves, landings and takeoffs relink.
+    columns.longitudes[ 2 ] = toMicroDegrees( -71.2 );
+    columns.latitudes[ 2 ] = toMicroDegrees( 42.5 );
+    columns.live[ 0 ] = 0;
+    columns.live[ 3 ] = 1;
+    columns.longitudes[ 5 ] = toMicroDegrees( -70.8 );
+    columns.latitudes[ 5 ] = toMicroDegrees( 42.3 );
+    columns.update( grid );
+    CHECK( grid.relinked() == 4 );
+    CHECK( grid.size() == 5 );
+    CHECK( within( grid, boston ) == std::vector< FlightSlot >{ 1, 2, 3, 5 } );
+
+    // Slots past the end leave.
+    columns.longitudes.resize( 3 );
+    columns.latitudes.resize( 3 );
+    columns.live.resize( 3 );
+    columns.update( grid );
+    CHECK( grid.size() == 2 );
+    CHECK( within( grid, boston ) == std::vector< FlightSlot >{ 1, 2 } );
+
+    grid.clear();
+    CHECK( grid.size() == 0 );
+    CHECK( within( grid, boston ).empty() );
+    columns.update( grid );
+    CHECK( grid.size() == 2 );
+}
+
+TEST_CASE( "geo grid agrees with a brute force search" ) {
+    // Not a whole number of vectors, so the update has a tail.
+    const size_t count = 4003;
+    Synthetic::XorShift rng( 21 );
+    Columns columns;
+    for( size_t i = 0; i < count; ++i ) {
+        columns.add( rng.uniform( -80, -60 ), rng.uniform( 35, 50 ), rng.chance( 0.9 ) );
+    }
+    GeoGrid grid;
+    for( int step = 0; step < 5; ++step ) {
+        columns.update( grid );
+        for( int query = 0; query < 50; ++query ) {
+            const double west = rng.uniform( -82, -60 );
+            const double south = rng.uniform( 33, 50 );
+            const GeoBb box = { { west, south },
+                                { west + rng.uniform( 0, 4 ), south + rng.uniform( 0, 3 ) } };
+            std::vector< FlightSlot > expected;
+            for( FlightSlot slot = 0; slot < count; ++slot ) {
+                const double longitude = fromMicroDegrees( columns.longitudes[ slot ] );
+                const double latitude = fromMicroDegrees( columns.latitudes[ slot ] );
+                if( columns.live[ slot ] && longitude >= box.min.longitude &&
+                    longitude <= box.max.longitude && latitude >= box.min.latitude &&
+                    latitude <= box.max.latitude ) {
+                    expected.push_back( slot );
+                }
+            }
+            REQUIRE( within( grid, box ) == expected );
+        }
+        // Everything drifts up to a third of a cell, and some aircraft come and go.
+        for( size_t i = 0; i < count; ++i ) {
+            columns.longitudes[ i ] += toMicroDegrees( rng.uniform( -0.3, 0.3 ) );
+            columns.latitudes[ i ] += toMicroDegrees( rng.uniform( -0.3, 0.3 ) );
+            if( rng.chance( 0.05 ) ) {
+                columns.live[ i ] = !columns.live[ i ];
+            }
+        }
+    }
+}
@@ -0,0 +1,88 @@
+#include <assert.h>
+
+#include "Icao24.hpp"
+
+uint32_t
+Icao24Map::find( Icao24 key ) const {
+    for( size_t i = bucket( key );; i = ( i + 1 ) & _mask ) {
+        const Entry & entry = _entries[ i ];
+        if( entry.key == key ) {
+            return entry.value;
+        }
+        if( entry.key == invalidIcao24 ) {
+            return notFound;
+        }
+    }
+}
+
+bool
+Icao24Map::insert( Icao24 key, uint32_t value ) {
+    assert( key != invalidIcao24 );
+    if( 2 * ( _size + 1 ) > _entries.size() ) {
+        rehash( 2 * _entries.size() );
+    }
+    for( size_t i = bucket( key );; i = ( i + 1 ) & _mask ) {
+        Entry & entry = _entries[ i ];
+        if( entry.key == key ) {
+            return false;
+        }
+        if( entry.key == invalidIcao24 ) {
+            entry = { key, value };
+            ++_size;
+            return true;
+        }
+    }
+}
+
+bool
+Icao24Map::erase( Icao24 key ) {
+    size_t hole = bucket( key );
+    while( _entries[ hole ].key != key ) {
+        if( _entries[ hole ].key == invalidIcao24 ) {
+            return false;
+        }
+        hole = ( hole + 1 ) & _mask;
+    }
+
+    // Walk the rest of the probe run and move back every entry whose home bucket
+    // doesn't lie cyclically between the hole and its current position.
+    for( size_t i = ( hole + 1 ) & _mask; _entries[ i ].key != invalidIcao24;
+         i = ( i + 1 ) & _mask ) {
+        const size_t home = bucket( _entries[ i ].key );
+        const bool stays = hole < i ? ( hole < home && home <= i )
+                                    : ( hole < home || home <= i );
+        if( !stays ) {
+            _entries[ hole ] = _entries[ i ];
+            hole = i;
+        }
+    }
+    _entries[ hole ].key = invalidIcao24;
+    --_size;
+    return true;
+}
+
+void
+Icao24Map::clear() {
+    for( Entry & entry : _entries ) {
+        entry.key = invalidIcao24;
+    }
+    _size = 0;
+}
+
+void
+Icao24Map::rehash( size_t capacity ) {
+    assert( ( capacity & ( capacity - 1 ) ) == 0 );
+    std::vector< Entry > old( capacity, Entry{ invalidIcao24, 0 } );
+    old.swap( _entries );
+    _mask = capacity - 1;
+    _shift = 32;
+    for( size_t c = capacity; c > 1; c >>= 1 ) {
+        --_shift;
+    }
+    _size = 0;
+    for( const Entry & entry : old ) {
+        if( entry.key != invalidIcao24 ) {
+            insert( entry.key, entry.value );
+        }
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// An ICAO 24-bit transponder address, packed into the low bits of a uint32_t.
+using Icao24 = uint32_t;
+constexpr Icao24 invalidIcao24 = UINT32_MAX;
+
+// Parses the hex form OpenSky uses (e.g. "ad4804"). Returns `invalidIcao24` for
+// anything that isn't 1 to 6 hex digits.
+inline Icao24
+icao24FromHex( std::string_view hex ) {
+    if( hex.empty() || hex.size() > 6 ) {
+        return invalidIcao24;
+    }
+    Icao24 result = 0;
+    for( const char c : hex ) {
+        uint32_t digit;
+        if( c >= '0' && c <= '9' ) {
+            digit = c - '0';
+        } else if( c >= 'a' && c <= 'f' ) {
+            digit = c - 'a' + 10;
+        } else if( c >= 'A' && c <= 'F' ) {
+            digit = c - 'A' + 10;
+        } else {
+            return invalidIcao24;
+        }
+        result = ( result << 4 ) | digit;
+    }
+    return result;
+}
+
+// Open-addressing map from icao24 address to a 32-bit value (a flight slot).
+// Linear probing over a power-of-two table that is kept at most half full. Erase
+// shifts the rest of the probe run back instead of leaving tombstones, so lookups
+// don't degrade as aircraft come and go over a long run.
+class Icao24Map {
+public:
+    static constexpr uint32_t notFound = UINT32_MAX;
+
+    Icao24Map() { rehash( 16 ); }
+
+    size_t size() const { return _size; }
+
+    uint32_t find( Icao24 key ) const;
+    // Returns false, leaving the map unchanged, if `key` is already present.
+    bool insert( Icao24 key, uint32_t value );
+    // Returns false if `key` was not present.
+    bool erase( Icao24 key );
+    void clear();
+
+private:
+    struct Entry {
+        Icao24 key;
+        uint32_t value;
+    };
+
+    size_t bucket( Icao24 key ) const {
+        // Fibonacci hashing spreads the sequential addresses airlines are
+        // allocated in blocks of.
+        return static_cast< uint32_t >( key * 0x9e3779b1u ) >> _shift;
+    }
+    void rehash( size_t capacity );
+
+    std::vector< Entry > _entries;
+    size_t _mask = 0;
+    int _shift = 0;
+    size_t _size = 0;
+};
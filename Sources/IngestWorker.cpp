@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+
+#include <fmt/base.h>
+#include <fmt/format.h>
+
+#include "IngestWorker.hpp"
+#include "MappedFile.hpp"
+#include "OpenSky.hpp"
+#include "SnapshotLog.hpp"
+
+IngestWorker::IngestWorker( Source source, size_t queueCapacity ):
+    _source( std::move( source ) ),
+    _ready( queueCapacity ),
+    // Every snapshot is either ready, free, being filled or held by the render
+    // thread, so the free queue never needs more room than this.
+    _free( queueCapacity + 2 ) {
+    _thread = std::thread( [ this ] { run(); } );
+}
+
+IngestWorker::~IngestWorker() {
+    stop();
+    _thread.join();
+}
+
+std::unique_ptr< Snapshot >
+IngestWorker::poll() {
+    if( auto snapshot = _ready.pop() ) {
+        return std::move( *snapshot );
+    }
+    return nullptr;
+}
+
+void
+IngestWorker::recycle( std::unique_ptr< Snapshot > snapshot ) {
+    // Dropping it is fine too; the worker will allocate a new one.
+    _free.push( snapshot );
+}
+
+bool
+IngestWorker::sleepFor( double seconds ) {
+    std::unique_lock< std::mutex > lock( _sleepMutex );
+    return !_sleepCv.wait_for( lock, std::chrono::duration< double >( seconds ),
+                               [ this ] { return stopping(); } );
+}
+
+void
+IngestWorker::stop() {
+    {
+        std::lock_guard< std::mutex > lock( _sleepMutex );
+        _stopping.store( true, std::memory_order_release );
+    }
+    _sleepCv.notify_all();
+}
+
+void
+IngestWorker::run() {
+    runSource();
+    _finished.store( true, std::memory_order_release );
+}
+
+void
+IngestWorker::runSource() {
+    while( !stopping() ) {
+        std::unique_ptr< Snapshot > snapshot;
+        if( auto recycled = _free.pop() ) {
+            snapshot = std::move( *recycled );
+        } else {
+            snapshot = std::make_unique< Snapshot >();
+        }
+
+        if( !_source( *this, *snapshot ) ) {
+            return;
+        }
+        // The render thread drains the queue every frame, so this only spins if
+        // it has stalled.
+        while( !_ready.push( snapshot ) ) {
+            if( !sleepFor( 0.001 ) ) {
+                return;
+            }
+        }
+    }
+}
+
+IngestWorker::Source
+IngestWorker::fileSource( std::string path, double intervalSeconds ) {
+    bool first = true;
+    return [ path = std::move( path ), intervalSeconds, first ](
+               IngestWorker & worker, Snapshot & snapshot ) mutable {
+        if( !first && ( intervalSeconds <= 0 || !worker.sleepFor( intervalSeconds ) ) ) {
+            return false;
+        }
+        first = false;
+
+        const auto file = MappedFile::open( path );
+        if( !file ) {
+            fmt::print( stderr, "Couldn't open snapshot {}\n", path );
+            return false;
+        }
+        if( !OpenSky::parseSnapshot( file->bytes(), snapshot ) ) {
+            fmt::print( stderr, "Couldn't parse snapshot {}\n", path );
+            return false;
+        }
+        return true;
+    };
+}
+
+IngestWorker::Source
+IngestWorker::directorySource( const std::string & directory,
+                               double intervalSeconds ) {
+    std::vector< std::string > paths;
+    std::error_code error;
+    for( const auto & entry :
+         std::filesystem::directory_iterator( directory, error ) ) {
+        if( entry.is_regular_file() && entry.path().extension() == ".json" ) {
+            paths.push_back( entry.path().string() );
+        }
+    }
+    if( error ) {
+        fmt::print( stderr, "Couldn't list {}: {}\n", directory, error.message() );
+    }
+    std::sort( paths.begin(), paths.end() );
+
+    // std::function needs a copyable target, and the prefetched mapping isn't.
+    struct Replay {
+        std::vector< std::string > paths;
+        size_t index = 0;
+        std::optional< MappedFile > next;
+    };
+    auto replay = std::make_shared< Replay >();
+    replay->paths = std::move( paths );
+
+    return [ replay, intervalSeconds ]( IngestWorker & worker, Snapshot & snapshot ) {
+        const std::vector< std::string > & paths = replay->paths;
+        while( replay->index < paths.size() ) {
+            if( replay->index > 0 && intervalSeconds > 0 &&
+                !worker.sleepFor( intervalSeconds ) ) {
+                return false;
+            }
+            const std::string & path = paths[ replay->index++ ];
+            std::optional< MappedFile > file = replay->next
+                ? std::move( replay->next )
+                : MappedFile::open( path );
+            replay->next.reset();
+
+            if( replay->index < paths.size() ) {
+                replay->next = MappedFile::open( paths[ replay->index ] );
+                if( replay->next ) {
+                    replay->next->prefetch();
+                }
+            }
+            if( file && OpenSky::parseSnapshot( file->bytes(), snapshot ) ) {
+                return true;
+            }
+            fmt::print( stderr, "Skipping unreadable snapshot {}\n", path );
+        }
+        return false;
+    };
+}
+
+IngestWorker::Source
+IngestWorker::logSource( const std::string & path, double speed ) {
+    std::shared_ptr< SnapshotLog::Reader > reader;
+    if( auto opened = SnapshotLog::Reader::open( path ) ) {
+        reader = std::make_shared< SnapshotLog::Reader >( std::move( *opened ) );
+    } else {
+        fmt::print( stderr, "Couldn't open snapshot log {}\n", path );
+    }
+
+    std::optional< int64_t > previousTime;
+    return [ reader, speed, previousTime ](
+               IngestWorker & worker, Snapshot & snapshot ) mutable {
+        if( !reader || !reader->next( snapshot ) ) {
+            return false;
+        }
+        if( speed > 0 && previousTime && snapshot.time > *previousTime &&
+            !worker.sleepFor( ( snapshot.time - *previousTime ) / speed ) ) {
+            return false;
+        }
+        previousTime = snapshot.time;
+        return true;
+    };
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "Snapshot.hpp"
+#include "SpscQueue.hpp"
+
+// Reads and parses snapshots on a background thread and hands them to the render
+// thread through a lock-free single-producer/single-consumer queue, so parsing a
+// large snapshot never stalls a frame. Snapshots travel back through a second
+// queue once applied and are refilled in place, so a steady stream of snapshots
+// doesn't allocate.
+class IngestWorker {
+public:
+    // Fills `snapshot` with the next snapshot, taking as long as it needs to (use
+    // `sleepFor` to wait between polls). Returns false once there is nothing more
+    // to ingest, which ends the worker.
+    using Source = std::function< bool( IngestWorker & worker, Snapshot & snapshot ) >;
+
+    explicit IngestWorker( Source source, size_t queueCapacity = 4 );
+    ~IngestWorker();
+
+    // Render thread: the next parsed snapshot, if one is ready. Hand it back with
+    // `recycle` once it has been applied.
+    std::unique_ptr< Snapshot > poll();
+    void recycle( std::unique_ptr< Snapshot > snapshot );
+
+    // Worker thread: waits `seconds`, or less if the worker is being stopped.
+    // Returns false if it is.
+    bool sleepFor( double seconds );
+
+    bool stopping() const { return _stopping.load( std::memory_order_acquire ); }
+    void stop();
+    // Whether the source has run dry. Snapshots it produced may still be waiting
+    // in `poll`.
+    bool finished() const { return _finished.load( std::memory_order_acquire ); }
+
+    // A source that parses the /states/all response in `path` every
+    // `intervalSeconds`, or just once if `intervalSeconds` is zero.
+    static Source fileSource( std::string path, double intervalSeconds = 0 );
+    // A source that replays the recorded /states/all responses (*.json) in
+    // `directory` in file name order, one every `intervalSeconds`. The next file
+    // is prefetched while the current one is parsed.
+    static Source directorySource( const std::string & directory,
+                                   double intervalSeconds = 0 );
+    // A source that replays a binary snapshot log (see SnapshotLog.hpp), spacing
+    // snapshots by their recorded times divided by `speed`. A `speed` of zero
+    // replays as fast as the render thread takes them.
+    static Source logSource( const std::string & path, double speed = 1 );
+
+private:
+    void run();
+    void runSource();
+
+    Source _source;
+    SpscQueue< std::unique_ptr< Snapshot > > _ready;
+    SpscQueue< std::unique_ptr< Snapshot > > _free;
+
+    std::atomic< bool > _stopping{ false };
+    std::atomic< bool > _finished{ false };
+    std::mutex _sleepMutex;
+    std::condition_variable _sleepCv;
+    std::thread _thread;
+};
@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "JsonLines.hpp"
+#include "OpenSky.hpp"
+
+namespace JsonLines {
+
+namespace {
+
+// More chunks than threads, so a thread that drew short lines picks up more work
+// instead of idling while the others finish.
+constexpr size_t chunksPerThread = 4;
+
+bool
+isBlank( std::string_view line ) {
+    return line.find_first_not_of( " \t\r" ) == std::string_view::npos;
+}
+
+struct ChunkResult {
+    std::vector< Snapshot > snapshots;
+    size_t badLines = 0;
+};
+
+void
+parseChunk( std::string_view chunk, ChunkResult & result ) {
+    while( !chunk.empty() ) {
+        const size_t end = chunk.find( '\n' );
+        const std::string_view line = chunk.substr( 0, end );
+        chunk.remove_prefix( end == std::string_view::npos ? chunk.size() : end + 1 );
+        if( isBlank( line ) ) {
+            continue;
+        }
+        result.snapshots.emplace_back();
+        if( !OpenSky::parseSnapshot( line, result.snapshots.back() ) ) {
+            result.snapshots.pop_back();
+            ++result.badLines;
+        }
+    }
+}
+
+} // namespace
+
+std::vector< std::string_view >
+splitLines( std::string_view bytes, size_t chunkCount ) {
+    std::vector< std::string_view > chunks;
+    const size_t target = bytes.size() / std::max< size_t >( chunkCount, 1 ) + 1;
+    while( !bytes.empty() ) {
+        size_t end = bytes.find( '\n', std::min( target, bytes.size() ) - 1 );
+        end = end == std::string_view::npos ? bytes.size() : end + 1;
+        chunks.push_back( bytes.substr( 0, end ) );
+        bytes.remove_prefix( end );
+    }
+    return chunks;
+}
+
+namespace {
+
+unsigned
+threadsFor( unsigned threadCount ) {
+    return threadCount ? threadCount : std::max( std::thread::hardware_concurrency(), 1u );
+}
+
+// Parses every line of `bytes` on `threadCount` threads, appending the snapshots
+// to `batch` in file order.
+void
+parseInto( std::string_view bytes, unsigned threadCount, Batch & batch ) {
+    const std::vector< std::string_view > chunks =
+        splitLines( bytes, threadCount * chunksPerThread );
+    std::vector< ChunkResult > results( chunks.size() );
+
+    std::atomic< size_t > nextChunk{ 0 };
+    const auto work = [ & ] {
+        for( size_t i = nextChunk++; i < chunks.size(); i = nextChunk++ ) {
+            parseChunk( chunks[ i ], results[ i ] );
+        }
+    };
+    std::vector< std::thread > threads;
+    for( unsigned i = 1; i < std::min< size_t >( threadCount, chunks.size() ); ++i ) {
+        threads.emplace_back( work );
+    }
+    work();
+    for( std::thread & thread : threads ) {
+        thread.join();
+    }
+
+    size_t snapshotCount = batch.snapshots.size();
+    for( const ChunkResult & result : results ) {
+        snapshotCount += result.snapshots.size();
+    }
+    batch.snapshots.reserve( snapshotCount );
+    for( ChunkResult & result : results ) {
+        batch.badLines += result.badLines;
+        for( Snapshot & snapshot : result.snapshots ) {
+            batch.stats += snapshot.stats;
+            batch.snapshots.push_back( std::move( snapshot ) );
+        }
+    }
+}
+
+void
+sortByTime( std::vector< Snapshot > & snapshots ) {
+    // Recordings are nearly always in order already.
+    const auto byTime = []( const Snapshot & a, const Snapshot & b ) {
+        return a.time < b.time;
+    };
+    if( !std::is_sorted( snapshots.begin(), snapshots.end(), byTime ) ) {
+        std::stable_sort( snapshots.begin(), snapshots.end(), byTime );
+    }
+}
+
+} // namespace
+
+Batch
+parse( std::string_view bytes, unsigned threadCount ) {
+    Batch batch;
+    parseInto( bytes, threadsFor( threadCount ), batch );
+    sortByTime( batch.snapshots );
+    return batch;
+}
+
+bool
+stream( std::string_view bytes, const SnapshotFn & onSnapshot, Batch & totals,
+        unsigned threadCount, size_t windowBytes ) {
+    threadCount = threadsFor( threadCount );
+    // The snapshots parsed but not handed over yet, in time order, and the
+    // totals so far.
+    Batch pending;
+    int64_t handedOver = INT64_MIN;
+    bool going = true;
+    while( going && !bytes.empty() ) {
+        size_t end = bytes.size() <= windowBytes ?
+                         std::string_view::npos :
+                         bytes.find( '\n', std::max< size_t >( windowBytes, 1 ) - 1 );
+        end = end == std::string_view::npos ? bytes.size() : end + 1;
+        // Held back snapshots come first, so equal times keep their file order.
+        parseInto( bytes.substr( 0, end ), threadCount, pending );
+        bytes.remove_prefix( end );
+        sortByTime( pending.snapshots );
+
+        const size_t ready = bytes.empty() ?
+                                 pending.snapshots.size() :
+                                 pending.snapshots.size() -
+                                     std::min( pending.snapshots.size(), reorderSnapshots );
+        size_t handed = 0;
+        while( going && handed < ready ) {
+            const Snapshot & snapshot = pending.snapshots[ handed++ ];
+            if( snapshot.time < handedOver ) {
+                ++pending.lateSnapshots;
+            }
+            handedOver = std::max( handedOver, snapshot.time );
+            going = onSnapshot( snapshot );
+        }
+        pending.snapshots.erase( pending.snapshots.begin(),
+                                 pending.snapshots.begin() + std::ptrdiff_t( handed ) );
+    }
+    totals.badLines = pending.badLines;
+    totals.stats = pending.stats;
+    totals.lateSnapshots = pending.lateSnapshots;
+    return going;
+}
+
+} // namespace JsonLines
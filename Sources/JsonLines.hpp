@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+#include "ParseStats.hpp"
+#include "Snapshot.hpp"
+
+// Batch ingestion of JSON-lines files holding one /states/all response per line,
+// as collected for backfills. The file is cut into line-aligned chunks that a
+// pool of threads parses independently, each into its own snapshots, and the
+// results are merged back into time order. Days of recordings don't fit in
+// memory once parsed, so `stream` does that a window of the file at a time.
+namespace JsonLines {
+
+// About how much of the file `stream` parses at once: a hundred or so snapshots
+// of a busy sky.
+constexpr size_t windowBytes = size_t( 256 ) << 20;
+// How many snapshots `stream` holds back from each window to sort with the
+// next; recordings are nearly always in order, and rarely by more than a few.
+constexpr size_t reorderSnapshots = 32;
+
+struct Batch {
+    // Sorted by time; snapshots with equal times keep their file order.
+    std::vector< Snapshot > snapshots;
+    // Non-blank lines that weren't valid JSON.
+    size_t badLines = 0;
+    // Row counts over all snapshots.
+    ParseStats stats;
+    // Snapshots `stream` found older than some it had already handed over, and
+    // handed over out of order.
+    size_t lateSnapshots = 0;
+};
+
+using SnapshotFn = std::function< bool( const Snapshot & ) >;
+
+// Cuts `bytes` into at most `chunkCount` pieces of about equal size, each ending
+// just after a newline (or at the end of `bytes`), so no line is split.
+std::vector< std::string_view > splitLines( std::string_view bytes, size_t chunkCount );
+
+// Parses every line of `bytes` on `threadCount` threads, or one per core if
+// `threadCount` is zero.
+Batch parse( std::string_view bytes, unsigned threadCount = 0 );
+
+// Parses `bytes` like `parse`, but `windowBytes` of whole lines at a time, and
+// hands each window's snapshots to `onSnapshot` in time order before parsing
+// the next, so memory stays bounded however long the file. Stops and returns
+// false as soon as `onSnapshot` does. `totals` gets the counts; its snapshots
+// stay empty.
+bool stream( std::string_view bytes, const SnapshotFn & onSnapshot, Batch & totals,
+             unsigned threadCount = 0, size_t windowBytes = JsonLines::windowBytes );
+
+} // namespace JsonLines
@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <doctest/doctest.h>
+
+#include "JsonLines.hpp"
+#include "OpenSky.hpp"
+#include "Synthetic.hpp"
+
+TEST_CASE( "json lines split on line boundaries" ) {
+    const std::string bytes = "aaaa\nbb\ncccccc\nd\n\neeeee";
+    for( size_t chunkCount = 1; chunkCount <= 8; ++chunkCount ) {
+        CAPTURE( chunkCount );
+        const auto chunks = JsonLines::splitLines( bytes, chunkCount );
+        CHECK( chunks.size() <= chunkCount );
+        std::string joined;
+        for( size_t i = 0; i < chunks.size(); ++i ) {
+            CHECK( !chunks[ i ].empty() );
+            if( i + 1 < chunks.size() ) {
+                CHECK( chunks[ i ].back() == '\n' );
+            }
+            joined += chunks[ i ];
+        }
+        CHECK( joined == bytes );
+    }
+    CHECK( JsonLines::splitLines( "", 4 ).empty() );
+}
+
+TEST_CASE( "json lines parse in parallel into time order" ) {
+    // Out of order, with a blank line, a bad line and no trailing newline.
+    const int64_t times[] = { 1000, 1010, 1005, 1020, 1015, 1035, 1025, 1030 };
+    std::string bytes;
+    for( size_t i = 0; i < std::size( times ); ++i ) {
+        bytes += Synthetic::statesJson( 50 + i, uint32_t( i + 1 ), times[ i ] );
+        bytes += i == 3 ? "\n\n{\"time\":\n" : "\n";
+    }
+    bytes.pop_back();
+
+    for( const unsigned threadCount : { 1u, 2u, 3u, 16u } ) {
+        CAPTURE( threadCount );
+        const JsonLines::Batch batch = JsonLines::parse( bytes, threadCount );
+        CHECK( batch.badLines == 1 );
+        REQUIRE( batch.snapshots.size() == std::size( times ) );
+        size_t stateCount = 0;
+        for( size_t i = 0; i < batch.snapshots.size(); ++i ) {
+            const Snapshot & snapshot = batch.snapshots[ i ];
+            CHECK( snapshot.time == 1000 + 5 * int64_t( i ) );
+            stateCount += snapshot.states.size();
+
+            // Same states as parsing that line on its own.
+            const size_t line = std::find( std::begin( times ), std::end( times ),
+                                           snapshot.time ) - std::begin( times );
+            Snapshot expected;
+            REQUIRE( OpenSky::parseSnapshot(
+                Synthetic::statesJson( 50 + line, uint32_t( line + 1 ), snapshot.time ),
+                expected ) );
+            REQUIRE( expected.states.size() == snapshot.states.size() );
+            CHECK( std::memcmp( expected.states.data(), snapshot.states.data(),
+                                expected.states.size() * sizeof( StateVector ) ) == 0 );
+        }
+        CHECK( batch.stats.accepted() == stateCount );
+    }
+}
+
+TEST_CASE( "json lines stream a window at a time" ) {
+    // Neighbours swapped throughout, which the held back snapshots put right,
+    // and one snapshot further behind than they reach.
+    std::vector< int64_t > times;
+    for( int64_t i = 0; i < 60; ++i ) {
+        times.push_back( 1000 + 5 * ( i % 2 ? i - 1 : i + 1 ) );
+    }
+    times[ 50 ] = 900;
+    std::string bytes;
+    for( size_t i = 0; i < times.size(); ++i ) {
+        bytes += Synthetic::statesJson( 3, uint32_t( i + 1 ), times[ i ] );
+        bytes += i == 20 ? "\n{\"time\":\n" : "\n";
+    }
+
+    const JsonLines::Batch whole = JsonLines::parse( bytes, 2 );
+    for( const size_t windowBytes : { size_t( 1 ), size_t( 1000 ), bytes.size() } ) {
+        CAPTURE( windowBytes );
+        std::vector< int64_t > streamed;
+        JsonLines::Batch totals;
+        CHECK( JsonLines::stream(
+            bytes,
+            [ & ]( const Snapshot & snapshot ) {
+                streamed.push_back( snapshot.time );
+                return true;
+            },
+            totals, 2, windowBytes ) );
+        CHECK( totals.snapshots.empty() );
+        CHECK( totals.badLines == 1 );
+        CHECK( totals.stats.accepted() == whole.stats.accepted() );
+        REQUIRE( streamed.size() == times.size() );
+
+        const bool oneWindow = windowBytes == bytes.size();
+        CHECK( totals.lateSnapshots == ( oneWindow ? 0u : 1u ) );
+        // In order but for the one that fell too far behind.
+        std::vector< int64_t > rest;
+        std::copy_if( streamed.begin(), streamed.end(), std::back_inserter( rest ),
+                      []( int64_t time ) { return time != 900; } );
+        CHECK( std::is_sorted( rest.begin(), rest.end() ) );
+        if( oneWindow ) {
+            CHECK( streamed.front() == 900 );
+        }
+    }
+
+    // Stops as soon as the callback does.
+    size_t seen = 0;
+    JsonLines::Batch totals;
+    CHECK( !JsonLines::stream(
+        bytes, [ & ]( const Snapshot & ) { return ++seen < 3; }, totals, 2, 1 ) );
+    CHECK( seen == 3 );
+}
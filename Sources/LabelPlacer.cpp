@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <cmath>
+
+#include "LabelPlacer.hpp"
+
+namespace {
+
+// Bits `low` to `high` of a word, both included.
+inline uint64_t
+bitsBetween( int32_t low, int32_t high ) {
+    const uint64_t upTo = high == 63 ? ~uint64_t( 0 ) : ( uint64_t( 1 ) << ( high + 1 ) ) - 1;
+    return upTo & ~( ( uint64_t( 1 ) << low ) - 1 );
+}
+
+} // namespace
+
+void
+LabelPlacer::viewIs( Vector2 origin, Vector2 size ) {
+    _origin = origin;
+    _extent = size;
+    _columns = std::max( 0, static_cast< int32_t >( std::ceil( size.width() / cellSize ) ) );
+    _rows = std::max( 0, static_cast< int32_t >( std::ceil( size.height() / cellSize ) ) );
+    _words = ( _columns + 63 ) / 64;
+    _occupied.assign( size_t( _words ) * _rows, 0 );
+}
+
+void
+LabelPlacer::clear() {
+    std::fill( _occupied.begin(), _occupied.end(), 0 );
+}
+
+bool
+LabelPlacer::cellsOf( float left, float top, float width, float height,
+                      Cells & cells ) const {
+    const float x = left - static_cast< float >( _origin.x() );
+    const float y = top - static_cast< float >( _origin.y() );
+    // Also false for NaN.
+    if( !( x + width >= 0 && y + height >= 0 && x < _extent.width() &&
+           y < _extent.height() ) ) {
+        return false;
+    }
+    // Truncating is flooring here: negative coordinates clamp to the first cell
+    // either way, and the far edges aren't negative.
+    cells.firstColumn = std::max( 0, static_cast< int32_t >( x / cellSize ) );
+    cells.lastColumn = std::min( _columns - 1, static_cast< int32_t >( ( x + width ) / cellSize ) );
+    cells.firstRow = std::max( 0, static_cast< int32_t >( y / cellSize ) );
+    cells.lastRow = std::min( _rows - 1, static_cast< int32_t >( ( y + height ) / cellSize ) );
+    return cells.firstColumn <= cells.lastColumn && cells.firstRow <= cells.lastRow;
+}
+
+bool
+LabelPlacer::isFree( const Cells & cells ) const {
+    const int32_t firstWord = cells.firstColumn / 64;
+    const int32_t lastWord = cells.lastColumn / 64;
+    for( int32_t row = cells.firstRow; row <= cells.lastRow; ++row ) {
+        const uint64_t * words = &_occupied[ size_t( row ) * _words ];
+        for( int32_t word = firstWord; word <= lastWord; ++word ) {
+            const int32_t low = std::max( cells.firstColumn - word * 64, 0 );
+            const int32_t high = std::min( cells.lastColumn - word * 64, 63 );
+            if( words[ word ] & bitsBetween( low, high ) ) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void
+LabelPlacer::claim( const Cells & cells ) {
+    const int32_t firstWord = cells.firstColumn / 64;
+    const int32_t lastWord = cells.lastColumn / 64;
+    for( int32_t row = cells.firstRow; row <= cells.lastRow; ++row ) {
+        uint64_t * words = &_occupied[ size_t( row ) * _words ];
+        for( int32_t word = firstWord; word <= lastWord; ++word ) {
+            const int32_t low = std::max( cells.firstColumn - word * 64, 0 );
+            const int32_t high = std::min( cells.lastColumn - word * 64, 63 );
+            words[ word ] |= bitsBetween( low, high );
+        }
+    }
+}
+
+void
+LabelPlacer::occupy( float x, float y, float radius ) {
+    Cells cells;
+    if( cellsOf( x - radius, y - radius, 2 * radius, 2 * radius, cells ) ) {
+        claim( cells );
+    }
+}
+
+uint64_t
+LabelPlacer::windowAt( int32_t row, int32_t column ) const {
+    const uint64_t * words = &_occupied[ size_t( row ) * _words ];
+    const int32_t word = column / 64;
+    const int32_t shift = column % 64;
+    uint64_t bits = words[ word ] >> shift;
+    if( shift > 0 && word + 1 < _words ) {
+        bits |= words[ word + 1 ] << ( 64 - shift );
+    }
+    return bits;
+}
+
+bool
+LabelPlacer::tryPlace( const Label & label, float gap ) {
+    const float w = label.width;
+    const float h = label.height;
+    // Beside the aircraft first, then level with it, then above and below.
+    const float lefts[ candidateCount ] = { label.x + gap,     label.x + gap,
+                                            label.x - gap - w, label.x - gap - w,
+                                            label.x + gap,     label.x - gap - w,
+                                            label.x - w / 2,   label.x - w / 2 };
+    const float tops[ candidateCount ] = { label.y - gap - h, label.y + gap,
+                                           label.y - gap - h, label.y + gap,
+                                           label.y - h / 2,   label.y - h / 2,
+                                           label.y - gap - h, label.y + gap };
+
+    // Most labels in a busy area fit nowhere, so the rows around the aircraft are
+    // fetched once, as a word per row, and every candidate is tested against
+    // them with a mask.
+    Cells around;
+    if( !cellsOf( label.x - gap - w, label.y - gap - h, 2 * ( gap + w ), 2 * ( gap + h ),
+                  around ) ) {
+        return false;
+    }
+    uint64_t window[ windowRows ];
+    const bool windowed = around.lastColumn - around.firstColumn < 64 &&
+                          around.lastRow - around.firstRow < windowRows;
+    if( windowed ) {
+        for( int32_t row = around.firstRow; row <= around.lastRow; ++row ) {
+            window[ row - around.firstRow ] = windowAt( row, around.firstColumn );
+        }
+    }
+
+    const bool placedBefore = _placedIn[ label.slot ] == _frame - 1;
+    const uint8_t before = placedBefore ? _spot[ label.slot ] : notPlaced;
+    for( uint8_t attempt = 0; attempt <= candidateCount; ++attempt ) {
+        // The spot from last time, then all of them in order.
+        const uint8_t spot = attempt == 0 ? before : uint8_t( attempt - 1 );
+        if( spot == notPlaced || ( attempt > 0 && spot == before ) ) {
+            continue;
+        }
+        Cells cells;
+        if( !cellsOf( lefts[ spot ], tops[ spot ], w, h, cells ) ) {
+            continue;
+        }
+        bool free = true;
+        // Rounding can put a candidate's edge a cell past the window.
+        if( windowed && cells.firstColumn >= around.firstColumn &&
+            cells.lastColumn - around.firstColumn < 64 && cells.firstRow >= around.firstRow &&
+            cells.lastRow - around.firstRow < windowRows ) {
+            const uint64_t mask = bitsBetween( cells.firstColumn - around.firstColumn,
+                                               cells.lastColumn - around.firstColumn );
+            for( int32_t row = cells.firstRow; row <= cells.lastRow && free; ++row ) {
+                free = !( window[ row - around.firstRow ] & mask );
+            }
+        } else {
+            free = isFree( cells );
+        }
+        if( free ) {
+            claim( cells );
+            _spot[ label.slot ] = spot;
+            _placedIn[ label.slot ] = _frame;
+            _placements.push_back( { label.slot, lefts[ spot ], tops[ spot ] } );
+            return true;
+        }
+    }
+    return false;
+}
+
+const std::vector< LabelPlacer::Placement > &
+LabelPlacer::place( const Label * labels, size_t count, float gap ) {
+    ++_frame;
+    _placements.clear();
+    FlightSlot slotEnd = 0;
+    for( size_t i = 0; i < count; ++i ) {
+        slotEnd = std::max( slotEnd, labels[ i ].slot + 1 );
+    }
+    if( slotEnd > _spot.size() ) {
+        _spot.resize( slotEnd, notPlaced );
+        _placedIn.resize( slotEnd, 0 );
+    }
+    // Labels placed last time keep their priority over newcomers.
+    for( size_t i = 0; i < count; ++i ) {
+        if( _placedIn[ labels[ i ].slot ] == _frame - 1 ) {
+            tryPlace( labels[ i ], gap );
+        }
+    }
+    for( size_t i = 0; i < count; ++i ) {
+        if( _placedIn[ labels[ i ].slot ] < _frame - 1 ) {
+            tryPlace( labels[ i ], gap );
+        }
+    }
+    return _placements;
+}
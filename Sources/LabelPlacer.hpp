@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "FlightStore.hpp"
+#include "SizeTypes.hpp"
+
+// Greedy placement of callsign labels next to their aircraft, without overlaps.
+// The radar is covered by an occupancy grid of `cellSize` pixel cells kept as
+// one bit per cell, so testing or claiming a label's rectangle is a few word
+// operations per row it spans. Each label tries up to `candidateCount` spots
+// around its aircraft and takes the first free one; labels that fit nowhere
+// are left out.
+//
+// Placements are stable from frame to frame: labels that were placed last time
+// go first, and each tries the spot it had before anything else, so a label
+// only jumps when something else has taken its place.
+class LabelPlacer {
+public:
+    static constexpr float cellSize = 4;
+    static constexpr uint8_t candidateCount = 8;
+    static constexpr uint8_t notPlaced = UINT8_MAX;
+    // Labels up to this many cells tall, and 64 wide with their gaps, are
+    // placed from a window of words fetched once.
+    static constexpr int32_t windowRows = 16;
+
+    struct Label {
+        FlightSlot slot;
+        // The aircraft's position, and the text's size.
+        float x;
+        float y;
+        float width;
+        float height;
+    };
+    struct Placement {
+        FlightSlot slot;
+        // Top left of the text.
+        float left;
+        float top;
+    };
+
+    // Covers the `size` pixels whose top left is at `origin`, and empties the
+    // grid.
+    void viewIs( Vector2 origin, Vector2 size );
+    // Empties the grid for a new frame; placements are remembered.
+    void clear();
+    // Keeps labels off the square around a marker.
+    void occupy( float x, float y, float radius );
+    // Places `labels`, in order except that labels placed last time go first.
+    // Labels keep `gap` pixels from their aircraft.
+    const std::vector< Placement > & place( const Label * labels, size_t count, float gap );
+
+    const std::vector< Placement > & placements() const { return _placements; }
+    // Which spot a slot's label took last, or `notPlaced`.
+    uint8_t candidate( FlightSlot slot ) const {
+        return slot < _spot.size() && _placedIn[ slot ] == _frame ? _spot[ slot ] : notPlaced;
+    }
+
+private:
+    struct Cells {
+        int32_t firstColumn;
+        int32_t lastColumn;
+        int32_t firstRow;
+        int32_t lastRow;
+    };
+    // The cells under a rectangle, clipped to the grid; false if it is off the
+    // grid entirely.
+    bool cellsOf( float left, float top, float width, float height, Cells & cells ) const;
+    bool isFree( const Cells & cells ) const;
+    // The 64 cells of `row` from `column` on, one bit each.
+    uint64_t windowAt( int32_t row, int32_t column ) const;
+    void claim( const Cells & cells );
+    // Tries the candidates of `label`, its last spot first.
+    bool tryPlace( const Label & label, float gap );
+
+    Vector2 _origin;
+    Vector2 _extent;
+    int32_t _columns = 0;
+    int32_t _rows = 0;
+    // 64-bit words per row.
+    int32_t _words = 0;
+    std::vector< uint64_t > _occupied;
+
+    // Counts `place` calls. Per slot: the candidate its label took last, and in
+    // which call.
+    uint32_t _frame = 1;
+    std::vector< uint8_t > _spot;
+    std::vector< uint32_t > _placedIn;
+    std::vector< Placement > _placements;
+};
@@ -0,0 +1,104 @@
+#include <vector>
+
+#include <doctest/doctest.h>
+
+#include "LabelPlacer.hpp"
+#include "Synthetic.hpp"
+
+namespace {
+
+using Label = LabelPlacer::Label;
+using Placement = LabelPlacer::Placement;
+
+bool
+overlaps( const Placement & a, const Placement & b, float width, float height ) {
+    return a.left < b.left + width && b.left < a.left + width && a.top < b.top + height &&
+           b.top < a.top + height;
+}
+
+} // namespace
+
+TEST_CASE( "label placer keeps labels apart and in place" ) {
+    LabelPlacer placer;
+    placer.viewIs( Vector2( 100, 50 ), Vector2( 400, 300 ) );
+    std::vector< Label > labels = { { 0, 200, 200, 40, 10 },
+                                    { 1, 205, 200, 40, 10 },
+                                    { 2, 400, 100, 40, 10 } };
+    placer.place( labels.data(), labels.size(), 4 );
+    REQUIRE( placer.placements().size() == 3 );
+    // The first takes the first spot, up and to the right; the one next to it
+    // has to go elsewhere.
+    CHECK( placer.candidate( 0 ) == 0 );
+    CHECK( placer.placements()[ 0 ].left == 204 );
+    CHECK( placer.placements()[ 0 ].top == 186 );
+    CHECK( placer.candidate( 1 ) != 0 );
+    CHECK( placer.candidate( 2 ) == 0 );
+    const uint8_t second = placer.candidate( 1 );
+
+    // Aircraft 1 moves a little and now comes first, but everyone keeps their
+    // spot: nobody jitters.
+    labels = { { 1, 205.5f, 200.5f, 40, 10 },
+               { 0, 200.5f, 200.5f, 40, 10 },
+               { 2, 400.5f, 100, 40, 10 } };
+    placer.clear();
+    placer.place( labels.data(), labels.size(), 4 );
+    CHECK( placer.candidate( 0 ) == 0 );
+    CHECK( placer.candidate( 1 ) == second );
+    CHECK( placer.candidate( 2 ) == 0 );
+
+    // A newcomer doesn't push anyone out, and a marker keeps labels off it.
+    labels.push_back( { 3, 202, 201, 40, 10 } );
+    placer.clear();
+    placer.occupy( 440, 90, 3 );
+    placer.place( labels.data(), labels.size(), 4 );
+    CHECK( placer.candidate( 0 ) == 0 );
+    CHECK( placer.candidate( 1 ) == second );
+    CHECK( placer.candidate( 2 ) != 0 );
+    CHECK( placer.candidate( 2 ) != LabelPlacer::notPlaced );
+
+    // Off the radar, nothing.
+    labels = { { 4, 900, 900, 40, 10 } };
+    placer.clear();
+    placer.place( labels.data(), labels.size(), 4 );
+    CHECK( placer.placements().empty() );
+    CHECK( placer.candidate( 0 ) == LabelPlacer::notPlaced );
+    CHECK( placer.candidate( 4 ) == LabelPlacer::notPlaced );
+}
+
+TEST_CASE( "label placer never overlaps labels" ) {
+    const size_t count = 3000;
+    Synthetic::XorShift rng( 23 );
+    std::vector< Label > labels;
+    for( FlightSlot slot = 0; slot < count; ++slot ) {
+        labels.push_back( { slot, float( rng.uniform( 0, 800 ) ), float( rng.uniform( 0, 600 ) ),
+                            36, 10 } );
+    }
+    LabelPlacer placer;
+    placer.viewIs( Vector2( 0, 0 ), Vector2( 800, 600 ) );
+    std::vector< uint8_t > spots( count, LabelPlacer::notPlaced );
+    for( int frame = 0; frame < 3; ++frame ) {
+        placer.clear();
+        const std::vector< Placement > & placed = placer.place( labels.data(), count, 4 );
+        CHECK( placed.size() > 200 );
+        for( size_t i = 0; i < placed.size(); ++i ) {
+            for( size_t j = i + 1; j < placed.size(); ++j ) {
+                REQUIRE( !overlaps( placed[ i ], placed[ j ], 36, 10 ) );
+            }
+        }
+        // Drifting half a pixel, almost every label stays where it was.
+        if( frame > 0 ) {
+            size_t kept = 0;
+            for( const Placement & placement : placed ) {
+                kept += placer.candidate( placement.slot ) == spots[ placement.slot ];
+            }
+            CHECK( kept > placed.size() * 9 / 10 );
+        }
+        for( FlightSlot slot = 0; slot < count; ++slot ) {
+            spots[ slot ] = placer.candidate( slot );
+        }
+        for( Label & label : labels ) {
+            label.x += float( rng.uniform( -0.5, 0.5 ) );
+            label.y += float( rng.uniform( -0.5, 0.5 ) );
+        }
+    }
+}
@@ -1,10 +1,15 @@
 
+#include <algorithm>
 #include <assert.h>
+#include <chrono>
 #include <cmath>
+#include <cstdlib>
+#include <filesystem>
 #include <iostream>
 #include <mutex>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <vector>
 
@@ -18,7 +23,13 @@ namespace rl {
 #include "raylib.h"
 }
 
+#include "FrameScheduler.hpp"
+#include "IngestWorker.hpp"
+#include "JsonLines.hpp"
 #include "Layout.hpp"
+#include "MappedFile.hpp"
+#include "OpenSky.hpp"
+#include "SnapshotLog.hpp"
 
 using Latitude = double;
 using Longitude = double;
@@ -223,12 +234,26 @@ mainMain() {
 
     Repl repl{};
     EmbeddedJanet janet{};
+    FrameScheduler frames;
 
     while( !rl::WindowShouldClose() ) {
         if ( const auto & line = repl.poll() ) {
             janet.eval( *line );
             repl.readyForNextInput();
+            frames.invalidate();
         }
+        if( rl::GetKeyPressed() != 0 || rl::IsWindowResized() ) {
+            frames.invalidate();
+        }
+        // The REPL doesn't wake an event wait, so idle frames sleep a little and
+        // look again.
+        const double now = rl::GetTime();
+        if( !frames.due( now ) ) {
+            rl::WaitTime( frames.wait( now ) );
+            rl::PollInputEvents();
+            continue;
+        }
+        frames.drawn( now );
 
         rl::BeginDrawing();
         rl::ClearBackground( rl::RAYWHITE );
@@ -247,7 +272,101 @@ mainMain() {
     return 0;
 }
 
-extern int testRadar();
+// Writes every snapshot of a JSON-lines backfill to `writer`, parsed on all
+// cores a window at a time so days of recordings fit in memory. The mapping is
+// read ahead sequentially, not prefetched whole.
+bool
+recordJsonLines( SnapshotLog::Writer & writer, const std::string & input,
+                 ParseStats & stats ) {
+    const auto file = MappedFile::open( input );
+    if( !file ) {
+        fmt::print( stderr, "Couldn't open {}\n", input );
+        return false;
+    }
+    JsonLines::Batch totals;
+    const bool written = JsonLines::stream(
+        file->bytes(), [ & ]( const Snapshot & snapshot ) { return writer.write( snapshot ); },
+        totals );
+    if( totals.badLines ) {
+        fmt::print( stderr, "Skipped {} lines that aren't JSON\n", totals.badLines );
+    }
+    if( totals.lateSnapshots ) {
+        fmt::print( stderr, "Wrote {} snapshots out of time order\n", totals.lateSnapshots );
+    }
+    stats += totals.stats;
+    return written;
+}
+
+// `flight_tracker record <log> <snapshot.json | directory | backfill.jsonl>`:
+// parses recorded /states/all responses and writes each one to a binary snapshot
+// log.
+int
+recordCommand( const std::string & logPath, const std::string & input ) {
+    auto writer = SnapshotLog::Writer::open( logPath );
+    if( !writer ) {
+        fmt::print( stderr, "Couldn't create {}\n", logPath );
+        return 1;
+    }
+
+    ParseStats stats;
+    if( std::filesystem::path( input ).extension() == ".jsonl" ) {
+        if( !recordJsonLines( *writer, input, stats ) ) {
+            fmt::print( stderr, "Couldn't record {} to {}\n", input, logPath );
+            return 1;
+        }
+    } else {
+        IngestWorker ingest( std::filesystem::is_directory( input )
+                                 ? IngestWorker::directorySource( input )
+                                 : IngestWorker::fileSource( input ) );
+        while( true ) {
+            const bool finished = ingest.finished();
+            if( auto snapshot = ingest.poll() ) {
+                stats += snapshot->stats;
+                if( !writer->write( *snapshot ) ) {
+                    fmt::print( stderr, "Couldn't write to {}\n", logPath );
+                    return 1;
+                }
+                ingest.recycle( std::move( snapshot ) );
+            } else if( finished ) {
+                break;
+            } else {
+                std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+            }
+        }
+    }
+    fmt::print( "Recorded {} snapshots to {}\n", writer->snapshotCount(), logPath );
+    if( stats.quarantined() ) {
+        fmt::print( "Quarantined {} of {} states:\n", stats.quarantined(),
+                    stats.accepted() + stats.quarantined() );
+        for( size_t i = 1; i < stateStatusCount; ++i ) {
+            if( stats.rows[ i ] ) {
+                fmt::print( "  {:<16} {}\n", StateStatus( i ), stats.rows[ i ] );
+            }
+        }
+    }
+    return 0;
+}
+
+extern int runRadar( IngestWorker::Source source, double maxFps );
+
+// `flight_tracker replay <log> [speed | max]`: shows a recorded log on the radar
+// at 1x, `speed`x or as fast as it can be drawn.
+int
+replayCommand( const std::string & logPath, const std::string & speedArg, double maxFps ) {
+    double speed = 1;
+    if( speedArg == "max" ) {
+        speed = 0;
+    } else if( !speedArg.empty() ) {
+        speed = std::strtod( speedArg.c_str(), nullptr );
+        if( speed <= 0 ) {
+            fmt::print( stderr, "Replay speed must be positive or \"max\"\n" );
+            return 1;
+        }
+    }
+    return runRadar( IngestWorker::logSource( logPath, speed ), maxFps );
+}
+
+extern int testRadar( double maxFps );
 extern int testScrollingText();
 extern int testVStack();
 
@@ -256,9 +375,34 @@ extern int testLayout1d();
 extern int testRectangleV2();
 
 int
-main() {
+main( int argc, char ** argv ) {
+    // FTL_PARSER=nlohmann falls back to the reference parser.
+    if( const char * parser = std::getenv( "FTL_PARSER" );
+        parser && std::string_view( parser ) == "nlohmann" ) {
+        OpenSky::backendIs( OpenSky::Backend::nlohmann );
+    }
+    // FTL_MAX_FPS=n caps the frames drawn while something moves.
+    double maxFps = 0;
+    if( const char * fps = std::getenv( "FTL_MAX_FPS" ) ) {
+        maxFps = std::max( std::strtod( fps, nullptr ), 0.0 );
+    }
+
+    const std::string command = argc > 1 ? argv[ 1 ] : "";
+    if( command == "record" && argc == 4 ) {
+        return recordCommand( argv[ 2 ], argv[ 3 ] );
+    } else if( command == "replay" && ( argc == 3 || argc == 4 ) ) {
+        return replayCommand( argv[ 2 ], argc == 4 ? argv[ 3 ] : "", maxFps );
+    } else if( !command.empty() ) {
+        fmt::print( stderr,
+                    "usage: {0}\n"
+                    "       {0} record <log> <snapshot.json | directory | backfill.jsonl>\n"
+                    "       {0} replay <log> [speed | max]\n",
+                    argv[ 0 ] );
+        return 1;
+    }
+
     // return mainMain();
-    return testRadar();
+    return testRadar( maxFps );
     // return testScrollingText();
     // return testVStack();
 
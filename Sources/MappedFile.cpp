@@ -0,0 +1,72 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "MappedFile.hpp"
+
+std::optional< MappedFile >
+MappedFile::open( const std::string & path ) {
+    const int fd = ::open( path.c_str(), O_RDONLY );
+    if( fd < 0 ) {
+        return std::nullopt;
+    }
+    struct stat st;
+    if( fstat( fd, &st ) != 0 ) {
+        ::close( fd );
+        return std::nullopt;
+    }
+    const size_t size = static_cast< size_t >( st.st_size );
+    if( size == 0 ) {
+        // mmap rejects empty mappings.
+        ::close( fd );
+        return MappedFile( nullptr, 0 );
+    }
+
+    void * data = mmap( nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    // The mapping keeps its own reference to the file.
+    ::close( fd );
+    if( data == MAP_FAILED ) {
+        return std::nullopt;
+    }
+    madvise( data, size, MADV_SEQUENTIAL );
+    return MappedFile( data, size );
+}
+
+MappedFile::MappedFile( MappedFile && other ) noexcept:
+    _data( other._data ), _size( other._size ) {
+    other._data = nullptr;
+    other._size = 0;
+}
+
+MappedFile &
+MappedFile::operator=( MappedFile && other ) noexcept {
+    if( this != &other ) {
+        unmap();
+        _data = other._data;
+        _size = other._size;
+        other._data = nullptr;
+        other._size = 0;
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    unmap();
+}
+
+void
+MappedFile::prefetch() const {
+    if( _data ) {
+        madvise( _data, _size, MADV_WILLNEED );
+    }
+}
+
+void
+MappedFile::unmap() {
+    if( _data ) {
+        munmap( _data, _size );
+        _data = nullptr;
+        _size = 0;
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// A whole file mapped read-only into memory, so it can be parsed in place
+// without copying it through stream buffers. Unmapped on destruction.
+class MappedFile {
+public:
+    // Maps `path` and advises the kernel it will be read sequentially. Returns
+    // nullopt if the file can't be opened or mapped.
+    static std::optional< MappedFile > open( const std::string & path );
+
+    MappedFile( MappedFile && other ) noexcept;
+    MappedFile & operator=( MappedFile && other ) noexcept;
+    MappedFile( const MappedFile & ) = delete;
+    MappedFile & operator=( const MappedFile & ) = delete;
+    ~MappedFile();
+
+    std::string_view bytes() const {
+        return std::string_view( static_cast< const char * >( _data ), _size );
+    }
+    size_t size() const { return _size; }
+
+    // Starts reading the whole file in the background, so it is resident by the
+    // time it is parsed.
+    void prefetch() const;
+
+private:
+    MappedFile( void * data, size_t size ): _data( data ), _size( size ) {}
+    void unmap();
+
+    void * _data = nullptr;
+    size_t _size = 0;
+};
@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <cstddef>
+
+#include "MarkerBatch.hpp"
+
+namespace rl {
+#include <raymath.h>
+#include <rlgl.h>
+}
+
+namespace {
+
+// Each marker is a quad around its center, a pixel larger than the circle so
+// that the edge has room to fade out.
+const char * const vertexShader = R"(
+#version 330
+in vec2 corner;
+in vec3 marker;
+in vec4 color;
+uniform mat4 mvp;
+out vec2 offset;
+out float radius;
+out vec4 tint;
+void main() {
+    offset = corner * ( marker.z + 1.0 );
+    radius = marker.z;
+    tint = color;
+    gl_Position = mvp * vec4( marker.xy + offset, 0.0, 1.0 );
+}
+)";
+
+const char * const fragmentShader = R"(
+#version 330
+in vec2 offset;
+in float radius;
+in vec4 tint;
+out vec4 finalColor;
+void main() {
+    float coverage = clamp( radius + 0.5 - length( offset ), 0.0, 1.0 );
+    if( coverage <= 0.0 ) {
+        discard;
+    }
+    finalColor = vec4( tint.rgb, tint.a * coverage );
+}
+)";
+
+// Two triangles.
+const float corners[] = { -1, -1, 1, -1, 1, 1, -1, -1, 1, 1, -1, 1 };
+
+} // namespace
+
+MarkerBatch::~MarkerBatch() {
+    if( !_instanced ) {
+        return;
+    }
+    rl::rlUnloadVertexArray( _vertexArray );
+    rl::rlUnloadVertexBuffer( _cornerBuffer );
+    rl::rlUnloadVertexBuffer( _instanceBuffer );
+    rl::UnloadShader( _shader );
+}
+
+bool
+MarkerBatch::load() {
+    if( rl::rlGetVersion() < rl::RL_OPENGL_33 || rl::rlGetVersion() == rl::RL_OPENGL_ES_20 ) {
+        return false;
+    }
+    _shader = rl::LoadShaderFromMemory( vertexShader, fragmentShader );
+    if( !rl::IsShaderValid( _shader ) ) {
+        return false;
+    }
+    _mvpLocation = rl::GetShaderLocation( _shader, "mvp" );
+    const int cornerLocation = rl::GetShaderLocationAttrib( _shader, "corner" );
+    _markerLocation = rl::GetShaderLocationAttrib( _shader, "marker" );
+    _colorLocation = rl::GetShaderLocationAttrib( _shader, "color" );
+
+    _vertexArray = rl::rlLoadVertexArray();
+    rl::rlEnableVertexArray( _vertexArray );
+    _cornerBuffer = rl::rlLoadVertexBuffer( corners, sizeof( corners ), false );
+    rl::rlSetVertexAttribute( cornerLocation, 2, RL_FLOAT, false, 0, 0 );
+    rl::rlEnableVertexAttribute( cornerLocation );
+    rl::rlDisableVertexArray();
+    return true;
+}
+
+void
+MarkerBatch::reserveInstances( size_t count ) {
+    if( count <= _instanceCapacity ) {
+        return;
+    }
+    _instanceCapacity = std::max( count, 2 * _instanceCapacity );
+    rl::rlEnableVertexArray( _vertexArray );
+    if( _instanceBuffer ) {
+        rl::rlUnloadVertexBuffer( _instanceBuffer );
+    }
+    _instanceBuffer = rl::rlLoadVertexBuffer(
+        nullptr, static_cast< int >( _instanceCapacity * sizeof( Marker ) ), true );
+    rl::rlSetVertexAttribute( _markerLocation, 3, RL_FLOAT, false, sizeof( Marker ), 0 );
+    rl::rlSetVertexAttributeDivisor( _markerLocation, 1 );
+    rl::rlEnableVertexAttribute( _markerLocation );
+    rl::rlSetVertexAttribute( _colorLocation, 4, RL_UNSIGNED_BYTE, true, sizeof( Marker ),
+                              offsetof( Marker, color ) );
+    rl::rlSetVertexAttributeDivisor( _colorLocation, 1 );
+    rl::rlEnableVertexAttribute( _colorLocation );
+    rl::rlDisableVertexArray();
+}
+
+void
+MarkerBatch::draw() {
+    _drawCalls = 0;
+    if( _markers.empty() ) {
+        return;
+    }
+    if( !_loaded ) {
+        _loaded = true;
+        _instanced = load();
+    }
+    if( !_instanced ) {
+        for( const Marker & marker : _markers ) {
+            rl::DrawCircleV( { marker.x, marker.y }, marker.radius, marker.color );
+        }
+        return;
+    }
+
+    // Whatever raylib has batched so far goes first, so that markers land on top.
+    rl::rlDrawRenderBatchActive();
+    reserveInstances( _markers.size() );
+    rl::rlEnableVertexArray( _vertexArray );
+    rl::rlUpdateVertexBuffer( _instanceBuffer, _markers.data(),
+                              static_cast< int >( _markers.size() * sizeof( Marker ) ), 0 );
+    rl::rlEnableShader( _shader.id );
+    rl::rlSetUniformMatrix( _mvpLocation, rl::MatrixMultiply( rl::rlGetMatrixModelview(),
+                                                              rl::rlGetMatrixProjection() ) );
+    rl::rlDrawVertexArrayInstanced( 0, 6, static_cast< int >( _markers.size() ) );
+    rl::rlDisableShader();
+    rl::rlDisableVertexArray();
+    _drawCalls = 1;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "SizeTypes.hpp"
+
+// A frame's aircraft markers, drawn in one call. Markers are collected into a
+// column of 16-byte instances, uploaded into one vertex buffer that only grows,
+// and drawn as instanced quads that a small shader cuts into antialiased
+// circles; raylib's `DrawCircleV` instead tessellates 36 triangles per marker
+// through the immediate-mode batch, and flushes it every 300 or so.
+//
+// Instancing needs OpenGL 3.3, raylib's desktop default. Anywhere else markers
+// fall back to `DrawCircleV`.
+class MarkerBatch {
+public:
+    struct Marker {
+        float x;
+        float y;
+        float radius;
+        rl::Color color;
+    };
+    static_assert( sizeof( Marker ) == 16 );
+
+    MarkerBatch() = default;
+    MarkerBatch( const MarkerBatch & ) = delete;
+    MarkerBatch & operator=( const MarkerBatch & ) = delete;
+    ~MarkerBatch();
+
+    void clear() { _markers.clear(); }
+    void add( Vector2 at, float radius, rl::Color color ) {
+        _markers.push_back(
+            { static_cast< float >( at.x() ), static_cast< float >( at.y() ), radius, color } );
+    }
+    // Draws everything added since `clear`, over whatever was drawn before.
+    void draw();
+
+    size_t size() const { return _markers.size(); }
+    const std::vector< Marker > & markers() const { return _markers; }
+    // Instanced draw calls the last `draw` made: one, or none if it had nothing
+    // to draw or fell back to `DrawCircleV`.
+    size_t drawCalls() const { return _drawCalls; }
+
+private:
+    // Compiles the shader and creates the buffers; false if instancing isn't
+    // available.
+    bool load();
+    // Makes room for `count` instances and points the instance attributes at
+    // the buffer.
+    void reserveInstances( size_t count );
+
+    std::vector< Marker > _markers;
+    size_t _drawCalls = 0;
+
+    bool _loaded = false;
+    bool _instanced = false;
+    rl::Shader _shader = {};
+    int _mvpLocation = -1;
+    int _markerLocation = -1;
+    int _colorLocation = -1;
+    unsigned int _vertexArray = 0;
+    unsigned int _cornerBuffer = 0;
+    unsigned int _instanceBuffer = 0;
+    size_t _instanceCapacity = 0;
+};
@@ -0,0 +1,243 @@
+#include <atomic>
+
+#include "OpenSky.hpp"
+#include "StateBuilder.hpp"
+#include "StructuralParser.hpp"
+
+StateStatus
+OpenSky::parseState( const nlohmann::json & state, StateVector & stateVector ) {
+    using value_t = nlohmann::json::value_t;
+    if( !state.is_array() ) {
+        return StateStatus::notArray;
+    }
+
+    StateBuilder builder;
+    builder.begin();
+    int field = 0;
+    for( const nlohmann::json & value : state ) {
+        switch( value.type() ) {
+        case value_t::number_integer:
+        case value_t::number_unsigned:
+        case value_t::number_float:
+            builder.number( field, value.get< double >() );
+            break;
+        case value_t::string:
+            builder.string( field, value.get_ref< const std::string & >() );
+            break;
+        case value_t::boolean: builder.boolean( field, value.get< bool >() ); break;
+        case value_t::null: builder.null( field ); break;
+        case value_t::array: builder.container( field, true ); break;
+        default: builder.container( field, false ); break;
+        }
+        ++field;
+    }
+    return builder.finish( field, stateVector );
+}
+
+namespace {
+
+// SAX handler that picks the fields of each state out of the token stream of a
+// /states/all response. Depth 1 is the response object, depth 2 the "states"
+// array and depth 3 a single state vector.
+class StatesSax {
+public:
+    using json = nlohmann::json;
+
+    StatesSax( const OpenSky::StateFn & onState ): _onState( onState ) {}
+
+    const OpenSky::StatesHeader & header() const { return _header; }
+
+    bool null() {
+        if( inState() ) {
+            _builder.null( _field );
+        }
+        return scalar();
+    }
+    bool boolean( bool val ) {
+        if( inState() ) {
+            _builder.boolean( _field, val );
+        }
+        return scalar();
+    }
+    bool number_integer( json::number_integer_t val ) {
+        return number( static_cast< double >( val ) );
+    }
+    bool number_unsigned( json::number_unsigned_t val ) {
+        return number( static_cast< double >( val ) );
+    }
+    bool number_float( json::number_float_t val, const json::string_t & text ) {
+        return number( val, text );
+    }
+    bool string( json::string_t & val ) {
+        if( inState() ) {
+            _builder.string( _field, val );
+        }
+        return scalar();
+    }
+    bool binary( json::binary_t & ) { return scalar(); }
+
+    bool key( json::string_t & val ) {
+        if( _depth == 1 ) {
+            _key = val == "time"   ? Key::time :
+                   val == "states" ? Key::states :
+                                     Key::other;
+        }
+        return true;
+    }
+
+    bool start_object( std::size_t ) {
+        ++_depth;
+        if( _depth == 3 && _inStates ) {
+            _header.stats.count( StateStatus::notArray );
+        } else if( _depth == 4 && _inState ) {
+            _builder.container( _field, false );
+        }
+        return true;
+    }
+    bool end_object() {
+        return endContainer();
+    }
+    bool start_array( std::size_t ) {
+        ++_depth;
+        if( _depth == 2 && _key == Key::states ) {
+            _inStates = true;
+        } else if( _depth == 3 && _inStates ) {
+            _inState = true;
+            _field = 0;
+            _builder.begin();
+        } else if( _depth == 4 && _inState ) {
+            _builder.container( _field, true );
+        }
+        return true;
+    }
+    bool end_array() {
+        if( _depth == 3 && _inState ) {
+            _inState = false;
+            const StateStatus status = _builder.finish( _field, _stateVector );
+            _header.stats.count( status );
+            if( status == StateStatus::ok ) {
+                _onState( _stateVector );
+            }
+        } else if( _depth == 2 && _inStates ) {
+            _inStates = false;
+        }
+        return endContainer();
+    }
+
+    bool parse_error( std::size_t, const std::string &,
+                      const nlohmann::detail::exception & ) {
+        return false;
+    }
+
+private:
+    enum class Key { other, time, states };
+
+    bool inState() const { return _depth == 3 && _inState; }
+
+    // A nested container inside a state (the sensor ids) still occupies one field.
+    bool endContainer() {
+        if( _depth == 4 && _inState ) {
+            ++_field;
+        }
+        --_depth;
+        return true;
+    }
+
+    bool scalar() {
+        if( inState() ) {
+            ++_field;
+        } else if( _depth == 2 && _inStates ) {
+            _header.stats.count( StateStatus::notArray );
+        }
+        return true;
+    }
+
+    bool number( double val, std::string_view text = {} ) {
+        if( inState() ) {
+            _builder.number( _field, val, text );
+        } else if( _depth == 1 && _key == Key::time && isUnixTime( val ) ) {
+            _header.time = static_cast< int64_t >( val );
+        }
+        return scalar();
+    }
+
+    const OpenSky::StateFn & _onState;
+    OpenSky::StatesHeader _header;
+
+    int _depth = 0;
+    Key _key = Key::other;
+    bool _inStates = false;
+    bool _inState = false;
+    int _field = 0;
+    StateBuilder _builder;
+    StateVector _stateVector;
+};
+
+} // namespace
+
+namespace {
+
+std::atomic< OpenSky::Backend > currentBackend = OpenSky::Backend::structural;
+
+} // namespace
+
+OpenSky::Backend
+OpenSky::backend() {
+    return currentBackend.load( std::memory_order_relaxed );
+}
+
+void
+OpenSky::backendIs( Backend backend ) {
+    currentBackend.store( backend, std::memory_order_relaxed );
+}
+
+std::string_view
+format_as( OpenSky::Backend backend ) {
+    switch( backend ) {
+    case OpenSky::Backend::nlohmann: return "nlohmann";
+    case OpenSky::Backend::structural: return "structural";
+    }
+    return "unknown";
+}
+
+std::optional< OpenSky::StatesHeader >
+OpenSky::streamStates( std::string_view json, const StateFn & onState ) {
+    return streamStates( json, onState, backend() );
+}
+
+std::optional< OpenSky::StatesHeader >
+OpenSky::streamStates( std::string_view json, const StateFn & onState,
+                       Backend backend ) {
+    if( backend == Backend::structural ) {
+        return StructuralParser::streamStates( json, onState );
+    }
+    StatesSax sax( onState );
+    if( !nlohmann::json::sax_parse( json.data(), json.data() + json.size(),
+                                    &sax ) ) {
+        return std::nullopt;
+    }
+    return sax.header();
+}
+
+std::optional< OpenSky::StatesHeader >
+OpenSky::streamStates( std::istream & json, const StateFn & onState ) {
+    StatesSax sax( onState );
+    if( !nlohmann::json::sax_parse( json, &sax ) ) {
+        return std::nullopt;
+    }
+    return sax.header();
+}
+
+bool
+OpenSky::parseSnapshot( std::string_view json, Snapshot & snapshot ) {
+    snapshot.states.clear();
+    const auto header = streamStates( json, [ & ]( const StateVector & stateVector ) {
+        snapshot.states.push_back( stateVector );
+    } );
+    if( !header ) {
+        return false;
+    }
+    snapshot.time = header->time;
+    snapshot.stats = header->stats;
+    return true;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <optional>
+#include <string_view>
+
+#include <nlohmann/json.hpp>
+
+#include "FlightData.hpp"
+#include "ParseStats.hpp"
+#include "Snapshot.hpp"
+
+class OpenSky {
+public:
+    // Which parser reads responses from memory. Both accept the same texts and
+    // produce byte-identical states; structural is several times faster.
+    enum class Backend { nlohmann, structural };
+    static Backend backend();
+    static void backendIs( Backend backend );
+
+    using StateFn = std::function< void( const StateVector & ) >;
+
+    // What a /states/all response says about itself, besides the states.
+    struct StatesHeader {
+        // 0 if missing or not a Unix time.
+        int64_t time = 0;
+        ParseStats stats;
+    };
+
+    // Validates and reads all fields of one state in a single pass. Never throws:
+    // a malformed row yields the reason instead, and `stateVector` must then be
+    // ignored. Null fields are left at their `StateVector` default.
+    static StateStatus parseState( const nlohmann::json & state,
+                                   StateVector & stateVector );
+
+    // Stream a /states/all response without building a DOM. Each valid state is
+    // handed to `onState` as soon as its closing bracket has been read; malformed
+    // ones are only counted in the header's stats. Returns nullopt if the input
+    // is not valid JSON. Uses `backend()` unless told otherwise; streams are
+    // always read by nlohmann.
+    static std::optional< StatesHeader > streamStates( std::string_view json,
+                                                       const StateFn & onState );
+    static std::optional< StatesHeader >
+    streamStates( std::string_view json, const StateFn & onState, Backend backend );
+    static std::optional< StatesHeader > streamStates( std::istream & json,
+                                                       const StateFn & onState );
+
+    // Streams `json` into `snapshot`, reusing its storage. Returns false if the
+    // input is not valid JSON; malformed rows alone don't fail the snapshot.
+    static bool parseSnapshot( std::string_view json, Snapshot & snapshot );
+};
+std::string_view format_as( OpenSky::Backend backend );
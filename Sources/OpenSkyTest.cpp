@@ -0,0 +1,253 @@
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include <doctest/doctest.h>
+
+#include "MappedFile.hpp"
+#include "OpenSky.hpp"
+#include "Synthetic.hpp"
+
+namespace {
+
+std::string
+readFile( const char * path ) {
+    std::ifstream f( path );
+    std::stringstream ss;
+    ss << f.rdbuf();
+    return ss.str();
+}
+
+std::vector< StateVector >
+parseDom( const std::string & json, ParseStats * stats = nullptr ) {
+    std::vector< StateVector > result;
+    ParseStats domStats;
+    const nlohmann::json data = nlohmann::json::parse( json );
+    for( const auto & state : data[ "states" ] ) {
+        StateVector stateVector;
+        const StateStatus status = OpenSky::parseState( state, stateVector );
+        domStats.count( status );
+        if( status == StateStatus::ok ) {
+            result.push_back( stateVector );
+        }
+    }
+    if( stats ) {
+        *stats = domStats;
+    }
+    return result;
+}
+
+std::vector< StateVector >
+parseStreaming( const std::string & json, ParseStats * stats = nullptr ) {
+    std::vector< StateVector > result;
+    const auto header = OpenSky::streamStates(
+        json, [ & ]( const StateVector & stateVector ) {
+            result.push_back( stateVector );
+        } );
+    REQUIRE( header );
+    CHECK( header->stats.accepted() == result.size() );
+    if( stats ) {
+        *stats = header->stats;
+    }
+    return result;
+}
+
+void
+checkSame( const std::vector< StateVector > & expected,
+           const std::vector< StateVector > & actual ) {
+    REQUIRE( expected.size() == actual.size() );
+    for( size_t i = 0; i < expected.size(); ++i ) {
+        CAPTURE( i );
+        // Byte-wise, so that NaNs for null fields compare equal too.
+        CHECK( std::memcmp( &expected[ i ], &actual[ i ], sizeof( StateVector ) ) == 0 );
+    }
+}
+
+} // namespace
+
+TEST_CASE( "streaming parse matches DOM parse" ) {
+    SUBCASE( "sample data" ) {
+        const std::string json = readFile( FTL_SAMPLE_DATA );
+        REQUIRE( !json.empty() );
+        checkSame( parseDom( json ), parseStreaming( json ) );
+    }
+    SUBCASE( "synthetic" ) {
+        const std::string json = Synthetic::statesJson( 2000, 7 );
+        checkSame( parseDom( json ), parseStreaming( json ) );
+    }
+}
+
+TEST_CASE( "state vectors keep every field" ) {
+    const std::string json = R"({"time":1752437666,"states":[
+        ["a39155","N329SF  ","United States",1752437660,1752437665,-71.2118,42.4658,
+         1501.14,false,103.82,97.69,-4.88,[1,2],1584.96,"1303",true,2],
+        ["ad4804",null,"United States",null,1752437664,null,null,
+         null,true,0,null,null,null,null,"8888",false,0]]})";
+    const std::vector< StateVector > states = parseStreaming( json );
+    checkSame( parseDom( json ), states );
+    REQUIRE( states.size() == 2 );
+
+    const StateVector & full = states[ 0 ];
+    CHECK( full.icao24 == 0xa39155 );
+    CHECK( full.callSign.view() == "N329SF" );
+    CHECK( full.lastContact == 1752437665 );
+    CHECK( full.positionAge() == 5 );
+    CHECK( full.longitudeE6 == -71211800 );
+    CHECK( full.latitudeE6 == 42465800 );
+    CHECK( full.baroAltitude == 1501.14f );
+    CHECK( full.geoAltitude == 1584.96f );
+    CHECK( full.velocity == 103.82f );
+    CHECK( full.trueTrack == 97.69f );
+    CHECK( full.verticalRate == -4.88f );
+    CHECK( !full.onGround() );
+    CHECK( full.spi() );
+    CHECK( full.positionSource() == 2 );
+    CHECK( full.squawk == 01303 );
+
+    const StateVector & sparse = states[ 1 ];
+    CHECK( sparse.callSign == CallSign::unknown() );
+    CHECK( !sparse.hasPosition() );
+    CHECK( std::isnan( sparse.baroAltitude ) );
+    CHECK( std::isnan( sparse.trueTrack ) );
+    CHECK( sparse.onGround() );
+    CHECK( sparse.positionAge() == StateVector::maxPositionAge );
+    CHECK( sparse.squawk == StateVector::noSquawk );
+}
+
+TEST_CASE( "coordinates are rounded to micro-degrees from their text" ) {
+    const std::string json = R"({"time":1,"states":[
+        ["000001","A",null,1,1,-71.0148,42.3661,null,false,null,null,null,null,null,null,false,0],
+        ["000002","A",null,1,1,0.0000005,-0.0000005,null,false,null,null,null,null,null,null,false,0],
+        ["000003","A",null,1,1,12.34567849,-12.3456785,null,false,null,null,null,null,null,null,false,0],
+        ["000004","A",null,1,1,-180,90,null,false,null,null,null,null,null,null,false,0],
+        ["000005","A",null,1,1,1.5e1,-2.5E-1,null,false,null,null,null,null,null,null,false,0]]})";
+    const std::vector< StateVector > states = parseStreaming( json );
+    REQUIRE( states.size() == 5 );
+    CHECK( states[ 0 ].longitudeE6 == -71014800 );
+    CHECK( states[ 0 ].latitudeE6 == 42366100 );
+    CHECK( states[ 1 ].longitudeE6 == 1 );
+    CHECK( states[ 1 ].latitudeE6 == -1 );
+    CHECK( states[ 2 ].longitudeE6 == 12345678 );
+    CHECK( states[ 2 ].latitudeE6 == -12345679 );
+    CHECK( states[ 3 ].longitudeE6 == -180000000 );
+    CHECK( states[ 3 ].latitudeE6 == 90000000 );
+    CHECK( states[ 4 ].longitudeE6 == 15000000 );
+    CHECK( states[ 4 ].latitudeE6 == -250000 );
+}
+
+TEST_CASE( "malformed rows are quarantined" ) {
+    const std::string json = R"({"time":1752437666,"states":[
+        ["a39155","N329SF  ","United States",1752437660,1752437665,-71.2118,42.4658,
+         1501.14,false,103.82,97.69,-4.88,null,1584.96,"1303",false,0],
+        {"icao24":"405bfe"},
+        null,
+        ["405bfe","BAW1B   ","United Kingdom",1752437666,1752437666],
+        ["zz5bfe","BAW1B   ","United Kingdom",1752437666,1752437666,-70.8,42.4,
+         null,false,null,null,null,null,null,null,false,0],
+        [null,"BAW1B   ","United Kingdom",1752437666,1752437666,-70.8,42.4,
+         null,false,null,null,null,null,null,null,false,0],
+        ["405bfe",7,"United Kingdom",1752437666,1752437666,-70.8,42.4,
+         null,false,null,null,null,null,null,null,false,0],
+        ["405bfe","BAW1B   ","United Kingdom",1752437666,1752437666,-70.8,42.4,
+         "high",false,null,null,null,{},null,null,false,0],
+        ["405bfe","BAW1B   ","United Kingdom",1752437666,1752437666,-270.8,42.4,
+         null,false,null,null,null,null,null,null,false,0],
+        ["405bfe","BAW1B   ","United Kingdom",1752437666,1752437666,-70.8,null,
+         null,false,null,null,null,null,null,null,false,0],
+        ["a38c66","DAL1724 ","United States",1752437664,1752437665,-71.0208,42.3633,
+         null,true,1.29,14.06,null,null,null,null,false,0,4]]})";
+    ParseStats streamed;
+    ParseStats dom;
+    const std::vector< StateVector > states = parseStreaming( json, &streamed );
+    checkSame( parseDom( json, &dom ), states );
+    CHECK( dom.rows == streamed.rows );
+
+    REQUIRE( states.size() == 2 );
+    CHECK( states[ 0 ].icao24 == 0xa39155 );
+    CHECK( states[ 1 ].icao24 == 0xa38c66 );
+    CHECK( streamed.accepted() == 2 );
+    CHECK( streamed.quarantined() == 9 );
+    CHECK( streamed.rows[ size_t( StateStatus::notArray ) ] == 2 );
+    CHECK( streamed.rows[ size_t( StateStatus::tooFewFields ) ] == 1 );
+    CHECK( streamed.rows[ size_t( StateStatus::badIcao24 ) ] == 2 );
+    CHECK( streamed.rows[ size_t( StateStatus::wrongType ) ] == 2 );
+    CHECK( streamed.rows[ size_t( StateStatus::outOfRange ) ] == 2 );
+
+    SUBCASE( "synthetic" ) {
+        const std::string noisy = Synthetic::statesJson( 2000, 7, 1752437666, 0.05 );
+        checkSame( parseDom( noisy, &dom ), parseStreaming( noisy, &streamed ) );
+        CHECK( dom.rows == streamed.rows );
+        CHECK( streamed.accepted() + streamed.quarantined() == 2000 );
+        CHECK( streamed.quarantined() > 0 );
+    }
+}
+
+TEST_CASE( "numbers too big for their fields are quarantined" ) {
+    // Valid JSON every one, but none fits an integer or float field.
+    const std::string json = R"({"time":1e300,"states":[
+        ["a39155","N329SF  ","United States",1e300,1752437665,-71.2118,42.4658,
+         1501.14,false,103.82,97.69,-4.88,null,1584.96,"1303",false,0],
+        ["a39155","N329SF  ","United States",-1e300,1752437665,-71.2118,42.4658,
+         1501.14,false,103.82,97.69,-4.88,null,1584.96,"1303",false,0],
+        ["a39155","N329SF  ","United States",1752437660,1752437665,-71.2118,42.4658,
+         1501.14,false,1e300,97.69,-4.88,null,1584.96,"1303",false,0],
+        ["a39155","N329SF  ","United States",1752437660,1752437665,-71.2118,42.4658,
+         -1e39,false,103.82,1e39,1e39,null,-1e300,"1303",false,0],
+        ["a38c66","DAL1724 ","United States",1752437664,1752437665,-71.0208,42.3633,
+         null,true,1.29,14.06,null,null,null,null,false,0,4]]})";
+    for( const OpenSky::Backend backend :
+         { OpenSky::Backend::nlohmann, OpenSky::Backend::structural } ) {
+        CAPTURE( backend );
+        std::vector< StateVector > states;
+        const auto header = OpenSky::streamStates(
+            json, [ & ]( const StateVector & stateVector ) { states.push_back( stateVector ); },
+            backend );
+        REQUIRE( header );
+        CHECK( header->time == 0 );
+        CHECK( header->stats.accepted() == 1 );
+        CHECK( header->stats.rows[ size_t( StateStatus::outOfRange ) ] == 4 );
+        REQUIRE( states.size() == 1 );
+        CHECK( states[ 0 ].icao24 == 0xa38c66 );
+    }
+    ParseStats dom;
+    CHECK( parseDom( json, &dom ).size() == 1 );
+    CHECK( dom.rows[ size_t( StateStatus::outOfRange ) ] == 4 );
+}
+
+TEST_CASE( "icao24 addresses are packed" ) {
+    CHECK( icao24FromHex( "ad4804" ) == 0xad4804 );
+    CHECK( icao24FromHex( "405BFE" ) == 0x405bfe );
+    CHECK( icao24FromHex( "" ) == invalidIcao24 );
+    CHECK( icao24FromHex( "1234567" ) == invalidIcao24 );
+    CHECK( icao24FromHex( "a3g000" ) == invalidIcao24 );
+}
+
+TEST_CASE( "streaming parse reads the header" ) {
+    const std::string json = Synthetic::statesJson( 3, 1, 1234 );
+    const auto header = OpenSky::streamStates( json, []( const StateVector & ) {} );
+    REQUIRE( header );
+    CHECK( header->time == 1234 );
+    CHECK( header->stats.accepted() == 3 );
+    CHECK( header->stats.quarantined() == 0 );
+}
+
+TEST_CASE( "streaming parse rejects malformed input" ) {
+    const auto header = OpenSky::streamStates(
+        R"({"time":1,"states":[["abc","X",)", []( const StateVector & ) {} );
+    CHECK( !header );
+}
+
+TEST_CASE( "snapshots parse in place from a mapped file" ) {
+    CHECK( !MappedFile::open( "/nonexistent/snapshot.json" ) );
+
+    const auto file = MappedFile::open( FTL_SAMPLE_DATA );
+    REQUIRE( file );
+    CHECK( file->bytes() == readFile( FTL_SAMPLE_DATA ) );
+
+    Snapshot snapshot;
+    REQUIRE( OpenSky::parseSnapshot( file->bytes(), snapshot ) );
+    CHECK( snapshot.time == 1752437666 );
+    checkSame( parseDom( readFile( FTL_SAMPLE_DATA ) ), snapshot.states );
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+// Why a row of a /states/all response was accepted or quarantined. Only the
+// first problem found in a row is reported.
+enum class StateStatus : uint8_t {
+    ok,
+    // The row isn't a JSON array.
+    notArray,
+    // Fewer than the 17 fields every state has.
+    tooFewFields,
+    // The icao24 address is missing or isn't 1-6 hex digits.
+    badIcao24,
+    // A field holds a JSON type it never has, e.g. a number for the callsign.
+    wrongType,
+    // A number outside its field's range, or only one of longitude and latitude.
+    outOfRange,
+};
+constexpr size_t stateStatusCount = size_t( StateStatus::outOfRange ) + 1;
+
+inline std::string_view
+format_as( StateStatus status ) {
+    constexpr std::string_view names[ stateStatusCount ] = {
+        "ok", "not an array", "too few fields", "bad icao24", "wrong type",
+        "out of range" };
+    return names[ size_t( status ) ];
+}
+
+// Per-reason row counts of one or more parsed responses.
+struct ParseStats {
+    std::array< size_t, stateStatusCount > rows{};
+
+    void count( StateStatus status ) { ++rows[ size_t( status ) ]; }
+    size_t accepted() const { return rows[ size_t( StateStatus::ok ) ]; }
+    size_t quarantined() const {
+        size_t total = 0;
+        for( size_t i = 1; i < stateStatusCount; ++i ) {
+            total += rows[ i ];
+        }
+        return total;
+    }
+    ParseStats & operator+=( const ParseStats & other ) {
+        for( size_t i = 0; i < stateStatusCount; ++i ) {
+            rows[ i ] += other.rows[ i ];
+        }
+        return *this;
+    }
+};
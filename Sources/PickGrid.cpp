@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <cmath>
+
+#include "PickGrid.hpp"
+#include "Simd.hpp"
+
+void
+PickGrid::viewIs( Vector2 origin, Vector2 size ) {
+    if( origin.x() == _origin.x() && origin.y() == _origin.y() &&
+        size.width() == _extent.width() && size.height() == _extent.height() ) {
+        return;
+    }
+    _origin = origin;
+    _extent = size;
+    _columns = std::max( 0, static_cast< int32_t >( std::ceil( size.width() / cellSize ) ) );
+    _rows = std::max( 0, static_cast< int32_t >( std::ceil( size.height() / cellSize ) ) );
+    _head.assign( size_t( _columns ) * _rows, FlightStore::invalidSlot );
+    std::fill( _cell.begin(), _cell.end(), noCell );
+    _size = 0;
+}
+
+void
+PickGrid::clear() {
+    std::fill( _head.begin(), _head.end(), FlightStore::invalidSlot );
+    std::fill( _cell.begin(), _cell.end(), noCell );
+    _size = 0;
+}
+
+uint32_t
+PickGrid::cellAt( float x, float y ) const {
+    // Also false for NaN.
+    if( !( x >= 0 && y >= 0 && x < _extent.width() && y < _extent.height() ) ) {
+        return noCell;
+    }
+    const int32_t column = std::min( static_cast< int32_t >( x / cellSize ), _columns - 1 );
+    const int32_t row = std::min( static_cast< int32_t >( y / cellSize ), _rows - 1 );
+    return static_cast< uint32_t >( row * _columns + column );
+}
+
+int32_t
+PickGrid::clampColumn( float column ) const {
+    const float last = float( _columns - 1 );
+    return static_cast< int32_t >( std::clamp( std::floor( column ), 0.0f, last ) );
+}
+
+int32_t
+PickGrid::clampRow( float row ) const {
+    const float last = float( _rows - 1 );
+    return static_cast< int32_t >( std::clamp( std::floor( row ), 0.0f, last ) );
+}
+
+void
+PickGrid::link( FlightSlot slot, uint32_t cell ) {
+    const FlightSlot head = _head[ cell ];
+    _cell[ slot ] = cell;
+    _previous[ slot ] = FlightStore::invalidSlot;
+    _next[ slot ] = head;
+    if( head != FlightStore::invalidSlot ) {
+        _previous[ head ] = slot;
+    }
+    _head[ cell ] = slot;
+    ++_size;
+}
+
+void
+PickGrid::unlink( FlightSlot slot ) {
+    const FlightSlot previous = _previous[ slot ];
+    const FlightSlot next = _next[ slot ];
+    if( previous != FlightStore::invalidSlot ) {
+        _next[ previous ] = next;
+    } else {
+        _head[ _cell[ slot ] ] = next;
+    }
+    if( next != FlightStore::invalidSlot ) {
+        _previous[ next ] = previous;
+    }
+    _cell[ slot ] = noCell;
+    --_size;
+}
+
+void
+PickGrid::move( FlightSlot slot, uint32_t cell ) {
+    if( _cell[ slot ] != noCell ) {
+        unlink( slot );
+    }
+    if( cell != noCell ) {
+        link( slot, cell );
+    }
+}
+
+void
+PickGrid::update( const float * xs, const float * ys, const uint8_t * drawn,
+                  size_t slotCount ) {
+    // Slots past the end are gone.
+    for( FlightSlot slot = FlightSlot( slotCount ); slot < _cell.size(); ++slot ) {
+        if( _cell[ slot ] != noCell ) {
+            unlink( slot );
+        }
+    }
+    _cell.resize( slotCount, noCell );
+    _next.resize( slotCount );
+    _previous.resize( slotCount );
+    _xs = xs;
+    _ys = ys;
+
+    // Every slot's cell in one vectorized pass, relinking the few that moved.
+    using namespace Simd;
+    const Float4 left = splat( static_cast< float >( _origin.x() ) );
+    const Float4 top = splat( static_cast< float >( _origin.y() ) );
+    const Float4 zero = splat( 0.0f );
+    const Float4 width = splat( static_cast< float >( _extent.width() ) );
+    const Float4 height = splat( static_cast< float >( _extent.height() ) );
+    const Float4 perCell = splat( 1 / cellSize );
+    const Int4 columns = splat( _columns );
+    const Int4 outside = splat( int32_t( noCell ) );
+    size_t slot = 0;
+    for( ; slot + lanes <= slotCount; slot += lanes ) {
+        const Float4 x = load( xs + slot ) - left;
+        const Float4 y = load( ys + slot ) - top;
+        const Int4 shown = Int4{ drawn[ slot ], drawn[ slot + 1 ], drawn[ slot + 2 ],
+                                 drawn[ slot + 3 ] } != 0;
+        // Also false for NaN.
+        const Int4 inside = shown & ( x >= zero ) & ( y >= zero ) & ( x < width ) &
+                            ( y < height );
+        const Int4 column = toInt( select( inside, x, zero ) * perCell );
+        const Int4 row = toInt( select( inside, y, zero ) * perCell );
+        const Int4 cell = ( inside & ( row * columns + column ) ) | ( ~inside & outside );
+        const Int4 moved = cell != load( reinterpret_cast< const int32_t * >( &_cell[ slot ] ) );
+        if( moved[ 0 ] | moved[ 1 ] | moved[ 2 ] | moved[ 3 ] ) {
+            for( size_t lane = 0; lane < lanes; ++lane ) {
+                if( moved[ lane ] ) {
+                    move( FlightSlot( slot + lane ), uint32_t( cell[ lane ] ) );
+                }
+            }
+        }
+    }
+    for( ; slot < slotCount; ++slot ) {
+        const float x = xs[ slot ] - static_cast< float >( _origin.x() );
+        const float y = ys[ slot ] - static_cast< float >( _origin.y() );
+        const uint32_t cell = drawn[ slot ] ? cellAt( x, y ) : noCell;
+        if( cell != _cell[ slot ] ) {
+            move( slot, cell );
+        }
+    }
+}
+
+FlightSlot
+PickGrid::nearest( Vector2 at, float radius ) const {
+    FlightSlot best = FlightStore::invalidSlot;
+    float bestDistanceSquared = radius * radius;
+    forEachCandidate( at, radius, [ & ]( FlightSlot slot, float distanceSquared ) {
+        // Ties go to the lower slot, so the pick doesn't flicker between
+        // aircraft drawn on top of each other.
+        if( distanceSquared < bestDistanceSquared ||
+            ( distanceSquared == bestDistanceSquared && slot < best ) ) {
+            best = slot;
+            bestDistanceSquared = distanceSquared;
+        }
+    } );
+    return best;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "FlightStore.hpp"
+#include "SizeTypes.hpp"
+
+// Which aircraft are near a point on the radar, for hover and clicks. Slots are
+// bucketed by the screen cell they are drawn in, with a doubly linked list per
+// cell threaded through per-slot columns. Updating from a frame's projected
+// positions only relinks the slots that crossed into another cell, which at
+// radar speeds is a handful per frame, and a query only visits the cells
+// within its radius, comparing squared distances.
+class PickGrid {
+public:
+    static constexpr float cellSize = 16;
+
+    // Covers the `size` pixels whose top left is at `origin`. A new view empties
+    // the grid; the next `update` fills it again.
+    void viewIs( Vector2 origin, Vector2 size );
+    // Moves every slot below `slotCount` to the cell of ( xs[ slot ], ys[ slot ] ),
+    // or out of the grid if `drawn[ slot ]` is false or it is off screen.
+    // Queries read the positions from `xs` and `ys`, which must outlive them.
+    void update( const float * xs, const float * ys, const uint8_t * drawn,
+                 size_t slotCount );
+    void clear();
+
+    // The slot drawn closest to `at` and at most `radius` pixels from it, or
+    // `FlightStore::invalidSlot`.
+    FlightSlot nearest( Vector2 at, float radius ) const;
+    // Calls `fn( FlightSlot )` for every slot drawn at most `radius` pixels from
+    // `at`, in no particular order.
+    template< typename Fn >
+    void forEachWithin( Vector2 at, float radius, Fn && fn ) const {
+        forEachCandidate( at, radius, [ & ]( FlightSlot slot, float distanceSquared ) {
+            if( distanceSquared <= radius * radius ) {
+                fn( slot );
+            }
+        } );
+    }
+
+    size_t size() const { return _size; }
+
+private:
+    static constexpr uint32_t noCell = UINT32_MAX;
+
+    uint32_t cellAt( float x, float y ) const;
+    void link( FlightSlot slot, uint32_t cell );
+    void unlink( FlightSlot slot );
+    void move( FlightSlot slot, uint32_t cell );
+
+    // Calls `fn( slot, distanceSquared )` for every slot in the cells that the
+    // circle overlaps.
+    template< typename Fn >
+    void forEachCandidate( Vector2 at, float radius, Fn && fn ) const {
+        if( _columns == 0 || _rows == 0 ) {
+            return;
+        }
+        const float x = static_cast< float >( at.x() );
+        const float y = static_cast< float >( at.y() );
+        const float left = static_cast< float >( _origin.x() );
+        const float top = static_cast< float >( _origin.y() );
+        const int32_t firstColumn = clampColumn( ( x - left - radius ) / cellSize );
+        const int32_t lastColumn = clampColumn( ( x - left + radius ) / cellSize );
+        const int32_t firstRow = clampRow( ( y - top - radius ) / cellSize );
+        const int32_t lastRow = clampRow( ( y - top + radius ) / cellSize );
+        for( int32_t row = firstRow; row <= lastRow; ++row ) {
+            for( int32_t column = firstColumn; column <= lastColumn; ++column ) {
+                for( FlightSlot slot = _head[ row * _columns + column ];
+                     slot != FlightStore::invalidSlot; slot = _next[ slot ] ) {
+                    const float dx = _xs[ slot ] - x;
+                    const float dy = _ys[ slot ] - y;
+                    fn( slot, dx * dx + dy * dy );
+                }
+            }
+        }
+    }
+    int32_t clampColumn( float column ) const;
+    int32_t clampRow( float row ) const;
+
+    Vector2 _origin;
+    Vector2 _extent;
+    int32_t _columns = 0;
+    int32_t _rows = 0;
+    size_t _size = 0;
+    // First slot of each cell's list.
+    std::vector< FlightSlot > _head;
+
+    // Per slot: its cell and its neighbours in the cell's list.
+    std::vector< uint32_t > _cell;
+    std::vector< FlightSlot > _next;
+    std::vector< FlightSlot > _previous;
+    // The positions of the last `update`.
+    const float * _xs = nullptr;
+    const float * _ys = nullptr;
+};
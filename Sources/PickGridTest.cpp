@@ -0,0 +1,109 @@
+#include <algorithm>
+#include <vector>
+
+#include <doctest/doctest.h>
+
+#include "PickGrid.hpp"
+#include "Synthetic.hpp"
+
+namespace {
+
+struct Frame {
+    std::vector< float > xs;
+    std::vector< float > ys;
+    std::vector< uint8_t > drawn;
+
+    void update( PickGrid & grid ) const {
+        grid.update( xs.data(), ys.data(), drawn.data(), xs.size() );
+    }
+};
+
+} // namespace
+
+TEST_CASE( "pick grid finds the aircraft under the cursor" ) {
+    PickGrid grid;
+    grid.viewIs( Vector2( 100, 50 ), Vector2( 400, 300 ) );
+    Frame frame{ { 110, 200, 203, 480, 700 }, { 60, 200, 200, 348, 100 }, { 1, 1, 1, 1, 1 } };
+    frame.update( grid );
+    // The last one is off screen.
+    CHECK( grid.size() == 4 );
+
+    CHECK( grid.nearest( Vector2( 111, 61 ), 5 ) == 0 );
+    CHECK( grid.nearest( Vector2( 202, 200 ), 5 ) == 2 );
+    CHECK( grid.nearest( Vector2( 201.5, 200 ), 5 ) == 1 );
+    CHECK( grid.nearest( Vector2( 150, 150 ), 5 ) == FlightStore::invalidSlot );
+    CHECK( grid.nearest( Vector2( 700, 100 ), 5 ) == FlightStore::invalidSlot );
+    // Past the edge of the radar, aircraft near the edge are still found.
+    CHECK( grid.nearest( Vector2( 481, 352 ), 5 ) == 3 );
+
+    std::vector< FlightSlot > near;
+    grid.forEachWithin( Vector2( 200, 200 ), 3, [ & ]( FlightSlot slot ) {
+        near.push_back( slot );
+    } );
+    std::sort( near.begin(), near.end() );
+    CHECK( near == std::vector< FlightSlot >{ 1, 2 } );
+
+
+    // Moving relinks across cells.
+    frame.xs[ 1 ] = 400;
+    frame.ys[ 1 ] = 300;
+    frame.drawn[ 0 ] = 0;
+    frame.update( grid );
+    CHECK( grid.size() == 3 );
+    CHECK( grid.nearest( Vector2( 111, 61 ), 5 ) == FlightStore::invalidSlot );
+    CHECK( grid.nearest( Vector2( 200, 200 ), 5 ) == 2 );
+    CHECK( grid.nearest( Vector2( 399, 301 ), 5 ) == 1 );
+
+    // Slots past the end leave.
+    frame.xs.resize( 2 );
+    frame.ys.resize( 2 );
+    frame.drawn.resize( 2 );
+    frame.update( grid );
+    CHECK( grid.size() == 1 );
+    CHECK( grid.nearest( Vector2( 200, 200 ), 5 ) == FlightStore::invalidSlot );
+
+    // A new view starts over.
+    grid.viewIs( Vector2( 0, 0 ), Vector2( 800, 600 ) );
+    CHECK( grid.size() == 0 );
+    frame = { { 110, 200, 203, 480, 700 }, { 60, 200, 200, 348, 100 }, { 1, 1, 1, 1, 1 } };
+    frame.update( grid );
+    CHECK( grid.size() == 5 );
+    CHECK( grid.nearest( Vector2( 700, 100 ), 5 ) == 4 );
+}
+
+TEST_CASE( "pick grid agrees with a brute force search" ) {
+    const size_t count = 5000;
+    Synthetic::XorShift rng( 8 );
+    Frame frame;
+    for( size_t i = 0; i < count; ++i ) {
+        frame.xs.push_back( static_cast< float >( rng.uniform( -50, 850 ) ) );
+        frame.ys.push_back( static_cast< float >( rng.uniform( -50, 650 ) ) );
+        frame.drawn.push_back( rng.chance( 0.9 ) );
+    }
+    PickGrid grid;
+    grid.viewIs( Vector2( 0, 0 ), Vector2( 800, 600 ) );
+    for( int step = 0; step < 3; ++step ) {
+        frame.update( grid );
+        for( int query = 0; query < 200; ++query ) {
+            const Vector2 at( rng.uniform( 0, 800 ), rng.uniform( 0, 600 ) );
+            FlightSlot expected = FlightStore::invalidSlot;
+            float best = 20 * 20;
+            for( FlightSlot slot = 0; slot < count; ++slot ) {
+                const float dx = frame.xs[ slot ] - float( at.x() );
+                const float dy = frame.ys[ slot ] - float( at.y() );
+                const bool onScreen = frame.xs[ slot ] >= 0 && frame.xs[ slot ] < 800 &&
+                                      frame.ys[ slot ] >= 0 && frame.ys[ slot ] < 600;
+                if( frame.drawn[ slot ] && onScreen && dx * dx + dy * dy < best ) {
+                    best = dx * dx + dy * dy;
+                    expected = slot;
+                }
+            }
+            REQUIRE( grid.nearest( at, 20 ) == expected );
+        }
+        // Everything drifts a few pixels, as between frames.
+        for( size_t i = 0; i < count; ++i ) {
+            frame.xs[ i ] += static_cast< float >( rng.uniform( -3, 3 ) );
+            frame.ys[ i ] += static_cast< float >( rng.uniform( -3, 3 ) );
+        }
+    }
+}
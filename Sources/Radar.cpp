@@ -0,0 +1,600 @@
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#include <fmt/base.h>
+#include <fmt/format.h>
+
+#include "FrameScheduler.hpp"
+#include "IngestWorker.hpp"
+#include "Radar.hpp"
+
+const FlightStore::SnapshotChanges &
+Radar::snapshotIs( const Snapshot & snapshot ) {
+    _time = snapshot.time;
+    _flights.beginSnapshot();
+    for( const StateVector & stateVector : snapshot.states ) {
+        const FlightSlot slot = _flights.upsert( stateVector );
+        if( slot != FlightStore::invalidSlot ) {
+            _history.append( slot, stateVector );
+        }
+    }
+    const FlightStore::SnapshotChanges & changes = _flights.endSnapshot();
+    for( const FlightSlot slot : changes.removed ) {
+        _history.erase( slot );
+    }
+    _clock = std::max( _clock, double( snapshot.time ) );
+    _reckoning.snapshotIs( _flights, _clock );
+    _geoIndex.update( _flights.longitudesE6().data(), _flights.latitudesE6().data(),
+                      _flights.liveMask().data(), _flights.slotCount() );
+    _clusterIndex.update( _flights.longitudesE6().data(), _flights.latitudesE6().data(),
+                          _flights.liveMask().data(), _flights.slotCount() );
+    return changes;
+}
+
+void
+Radar::geoBbIs( const GeoBb & val ) {
+    _geoBb = val;
+    viewReset();
+}
+
+void
+Radar::viewReset() {
+    _center = { ( _geoBb.min.longitude + _geoBb.max.longitude ) / 2,
+                ( _geoBb.min.latitude + _geoBb.max.latitude ) / 2 };
+    _zoom = 1;
+}
+
+GeoBb
+Radar::view() const {
+    // Never wider than the world, and kept on it.
+    const double halfWidth =
+        std::min( ( _geoBb.max.longitude - _geoBb.min.longitude ) / 2 / _zoom, 180.0 );
+    const double halfHeight =
+        std::min( ( _geoBb.max.latitude - _geoBb.min.latitude ) / 2 / _zoom, 90.0 );
+    const double longitude = std::clamp( _center.longitude, halfWidth - 180, 180 - halfWidth );
+    const double latitude = std::clamp( _center.latitude, halfHeight - 90, 90 - halfHeight );
+    return { { longitude - halfWidth, latitude - halfHeight },
+             { longitude + halfWidth, latitude + halfHeight } };
+}
+
+void
+Radar::keepAt( GeoCoord target, Vector2 anchor ) {
+    refreshTransform( _at );
+    const GeoCoord now = _transform.unproject( anchor );
+    _center.longitude += target.longitude - now.longitude;
+    _center.latitude += target.latitude - now.latitude;
+    // Off the edge of the world the view stops, and so does the center.
+    const GeoBb shown = view();
+    _center = { ( shown.min.longitude + shown.max.longitude ) / 2,
+                ( shown.min.latitude + shown.max.latitude ) / 2 };
+}
+
+void
+Radar::zoomBy( double factor, Vector2 anchor ) {
+    // Nothing to anchor to before the first frame.
+    if( _transform.metersPerPixel() == 0 ) {
+        _zoom = std::clamp( _zoom * factor, minZoom, maxZoom );
+        return;
+    }
+    refreshTransform( _at );
+    const GeoCoord target = _transform.unproject( anchor );
+    _zoom = std::clamp( _zoom * factor, minZoom, maxZoom );
+    keepAt( target, anchor );
+}
+
+void
+Radar::panBy( Vector2 pixels ) {
+    if( _transform.metersPerPixel() == 0 ) {
+        return;
+    }
+    refreshTransform( _at );
+    const Vector2 middle( _at.x() + size().width() / 2, _at.y() + size().height() / 2 );
+    keepAt( _transform.unproject( Vector2( middle.x() - pixels.x(), middle.y() - pixels.y() ) ),
+            middle );
+}
+
+void
+Radar::refreshTransform( Vector2 radarAt ) {
+    const GeoBb shown = view();
+    if( !_transform.matches( shown, radarAt, size(), _projection ) ) {
+        _transform = ScreenTransform( shown, radarAt, size(), _projection );
+        ++_transformVersion;
+    }
+}
+
+Vector2
+Radar::screenPosition( GeoCoord position ) const {
+    return _transform.project( position );
+}
+
+void
+Radar::drawTrail( Vector2 radarAt, FlightSlot slot, double metersPerPixel ) {
+    refreshTransform( radarAt );
+    _trailPoints.clear();
+    const int64_t since = std::max< int64_t >( _time - _trailSeconds, 0 );
+    _history.forEachSince( slot, static_cast< uint32_t >( since ), metersPerPixel,
+                           [ & ]( const TrackSample & sample ) {
+        const GeoCoord position{ fromMicroDegrees( sample.longitudeE6 ),
+                                 fromMicroDegrees( sample.latitudeE6 ) };
+        _trailPoints.push_back( screenPosition( position ).toRlVector2() );
+    } );
+    if( _trailPoints.size() >= 2 ) {
+        rl::DrawLineStrip( _trailPoints.data(), static_cast< int >( _trailPoints.size() ),
+                           rl::Fade( rl::RED, 0.4f ) );
+    }
+}
+
+void
+Radar::drawStaticLayers( Vector2 radarAt ) {
+    const GeoBb shown = view();
+    if( !_layerTransform.matches( shown, Vector2(), size(), _projection ) ) {
+        _layerTransform = ScreenTransform( shown, Vector2(), size(), _projection );
+        ++_layerVersion;
+    }
+    _graticule.draw( radarAt, size(), _layerVersion, [ this ] { paintGraticule(); } );
+    _rangeRings.draw( radarAt, size(), _layerVersion, [ this ] { paintRangeRings(); } );
+    _border.draw( radarAt, size(), _layerVersion, [ this ] { paintBorder(); } );
+}
+
+namespace {
+
+// The first of 1, 2 and 5 times a power of ten that is at least `least`.
+double
+roundStep( double least ) {
+    const double power = std::pow( 10, std::floor( std::log10( least ) ) );
+    for( const double step : { 1.0, 2.0, 5.0, 10.0 } ) {
+        if( step * power >= least ) {
+            return step * power;
+        }
+    }
+    return 10 * power;
+}
+
+} // namespace
+
+void
+Radar::paintGraticule() const {
+    // Meridians and parallels are straight under both projections. About six of
+    // each across the view.
+    const GeoCoord northWest = _layerTransform.unproject( Vector2( 0, 0 ) );
+    const GeoCoord southEast = _layerTransform.unproject( size() );
+    const double west = std::max( northWest.longitude, -180.0 );
+    const double east = std::min( southEast.longitude, 180.0 );
+    const double north = std::min( northWest.latitude, 90.0 );
+    const double south = std::max( southEast.latitude, -90.0 );
+    const double step = roundStep( std::max( east - west, north - south ) / 6 );
+    const rl::Color color = { 225, 225, 225, 255 };
+    for( double longitude = std::ceil( west / step ) * step; longitude <= east;
+         longitude += step ) {
+        rl::DrawLineV( _layerTransform.project( { longitude, north } ).toRlVector2(),
+                       _layerTransform.project( { longitude, south } ).toRlVector2(), color );
+    }
+    for( double latitude = std::ceil( south / step ) * step; latitude <= north;
+         latitude += step ) {
+        rl::DrawLineV( _layerTransform.project( { west, latitude } ).toRlVector2(),
+                       _layerTransform.project( { east, latitude } ).toRlVector2(), color );
+    }
+}
+
+void
+Radar::paintRangeRings() const {
+    // Around the middle of the box the radar was set up with, at about an eighth
+    // of the radar apart, measured at the middle.
+    const GeoCoord middle = { ( _geoBb.min.longitude + _geoBb.max.longitude ) / 2,
+                              ( _geoBb.min.latitude + _geoBb.max.latitude ) / 2 };
+    const Vector2 at = _layerTransform.project( middle );
+    const Vector2 kmNorth =
+        _layerTransform.project( { middle.longitude, middle.latitude + 1000 / metersPerDegree } );
+    const double pixelsPerKm = at.y() - kmNorth.y();
+    if( !( pixelsPerKm > 0 ) ) {
+        return;
+    }
+    const double stepKm =
+        roundStep( std::min( size().width(), size().height() ) / 8 / pixelsPerKm );
+    const double reach = std::hypot( size().width(), size().height() ) +
+                         std::hypot( at.x() - size().width() / 2, at.y() - size().height() / 2 );
+    const rl::Color color = { 190, 210, 190, 255 };
+    for( int ring = 1; ring * stepKm * pixelsPerKm < reach && ring <= 100; ++ring ) {
+        const float radius = static_cast< float >( ring * stepKm * pixelsPerKm );
+        rl::DrawCircleLinesV( at.toRlVector2(), radius, color );
+        const std::string label = fmt::format( "{:g} km", ring * stepKm );
+        rl::DrawText( label.c_str(), static_cast< int >( at.x() + radius ) + 2,
+                      static_cast< int >( at.y() ) + 2, 10, color );
+    }
+}
+
+void
+Radar::paintBorder() const {
+    rl::DrawRectangleLinesEx( Vector2().toRlRectangle( size() ), 2, rl::RED );
+}
+
+void
+Radar::drawLabels( Vector2 radarAt ) {
+    const std::vector< CallSign > & callSigns = _flights.callSigns();
+    if( _labelWidth.size() < callSigns.size() ) {
+        _labelWidth.resize( callSigns.size(), -1 );
+        _measuredCallSign.resize( callSigns.size() );
+    }
+    _labelPlacer.viewIs( radarAt, size() );
+    _labelQueue.clear();
+    const auto queue = [ & ]( FlightSlot slot ) {
+        const CallSign callSign =
+            callSigns[ slot ].empty() ? CallSign::unknown() : callSigns[ slot ];
+        // Measured again only when the callsign changes.
+        if( _labelWidth[ slot ] < 0 || _measuredCallSign[ slot ] != callSign ) {
+            const std::string text( callSign.view() );
+            _labelWidth[ slot ] = float( rl::MeasureText( text.c_str(), labelFontSize ) );
+            _measuredCallSign[ slot ] = callSign;
+        }
+        _labelQueue.push_back( { slot, _screenX[ slot ], _screenY[ slot ], _labelWidth[ slot ],
+                                 float( labelFontSize ) } );
+    };
+    // Queued first, so that the hovered aircraft's label wins over newcomers.
+    if( _hovered != FlightStore::invalidSlot ) {
+        queue( _hovered );
+    }
+    for( const FlightSlot slot : _visible ) {
+        _labelPlacer.occupy( _screenX[ slot ], _screenY[ slot ], slot == _hovered ? 6 : 3 );
+        if( slot != _hovered ) {
+            queue( slot );
+        }
+    }
+    char text[ CallSign::capacity + 1 ] = {};
+    for( const LabelPlacer::Placement & placement :
+         _labelPlacer.place( _labelQueue.data(), _labelQueue.size(), 4 ) ) {
+        const std::string_view callSign = _measuredCallSign[ placement.slot ].view();
+        std::copy( callSign.begin(), callSign.end(), text );
+        text[ callSign.size() ] = 0;
+        rl::DrawText( text, static_cast< int >( placement.left ),
+                      static_cast< int >( placement.top ), labelFontSize, rl::DARKGRAY );
+    }
+}
+
+void
+Radar::drawFlight( Vector2 at, bool hovered ) {
+    _markers.add( at, hovered ? 6 : 3, rl::RED );
+}
+
+bool
+Radar::animating() const {
+    // Clusters stay where their aircraft last reported.
+    return _clusterLevel < 0 && !_visible.empty() && _clock < _reckoning.settlesAt();
+}
+
+int32_t
+Radar::clusterLevelFor() const {
+    if( !_clusters || !( _transform.metersPerPixel() > 0 ) ) {
+        return -1;
+    }
+    // Measured north to south at the middle of the view.
+    const double pixelsPerDegree = metersPerDegree / _transform.metersPerPixel();
+    double cellPixels = fromMicroDegrees( ClusterGrid::cellE6 ) * pixelsPerDegree;
+    if( cellPixels >= clusterPixels ) {
+        return -1;
+    }
+    int32_t level = 0;
+    while( cellPixels < clusterPixels && level + 1 < ClusterGrid::levelCount ) {
+        cellPixels *= 2;
+        ++level;
+    }
+    return level;
+}
+
+void
+Radar::drawClusters( const DrawContext & ctx, int32_t level ) {
+    forgetProjected();
+    _hovered = FlightStore::invalidSlot;
+    const GeoCoord northWest = _transform.unproject( ctx.at );
+    const GeoCoord southEast = _transform.unproject(
+        Vector2( ctx.at.x() + size().width(), ctx.at.y() + size().height() ) );
+    _shownClusters.clear();
+    _clusterIndex.forEachWithin(
+        level, { { northWest.longitude, southEast.latitude },
+                 { southEast.longitude, northWest.latitude } },
+        [ & ]( const ClusterGrid::Cluster & cluster ) { _shownClusters.push_back( cluster ); } );
+
+    // Lone aircraft look like themselves; bigger clusters grow with the log of
+    // their count, up to half a cell, and carry it as a badge.
+    _markers.clear();
+    for( const ClusterGrid::Cluster & cluster : _shownClusters ) {
+        const Vector2 at = screenPosition(
+            { fromMicroDegrees( cluster.longitudeE6 ), fromMicroDegrees( cluster.latitudeE6 ) } );
+        if( cluster.count == 1 ) {
+            drawFlight( at, false );
+        } else {
+            const float radius = static_cast< float >(
+                std::min( clusterPixels / 2, 4 + 3 * std::log2( double( cluster.count ) ) ) );
+            _markers.add( at, radius, rl::Fade( rl::RED, 0.6f ) );
+        }
+    }
+    _markers.draw();
+    // One marker per cluster, in order.
+    char text[ 16 ];
+    for( size_t i = 0; i < _shownClusters.size(); ++i ) {
+        if( _shownClusters[ i ].count == 1 ) {
+            continue;
+        }
+        const MarkerBatch::Marker & marker = _markers.markers()[ i ];
+        *fmt::format_to_n( text, sizeof( text ) - 1, "{}", _shownClusters[ i ].count ).out = 0;
+        const int width = rl::MeasureText( text, labelFontSize );
+        rl::DrawText( text, static_cast< int >( marker.x ) - width / 2,
+                      static_cast< int >( marker.y ) - labelFontSize / 2, labelFontSize,
+                      rl::WHITE );
+    }
+}
+
+void
+Radar::draw( const DrawContext & ctx ) {
+    drawStaticLayers( ctx.at );
+    _clock += ctx.deltaTime;
+    _reckoning.advance( _clock );
+
+    _at = ctx.at;
+    refreshTransform( ctx.at );
+    // Zoomed out, what is drawn depends on how many cells fit on screen rather
+    // than on how many aircraft there are.
+    _clusterLevel = clusterLevelFor();
+    if( _clusterLevel >= 0 ) {
+        drawClusters( ctx, _clusterLevel );
+    } else {
+        drawAircraft( ctx );
+    }
+}
+
+void
+Radar::forgetProjected() {
+    for( const FlightSlot slot : _visible ) {
+        if( slot < _drawn.size() ) {
+            _drawn[ slot ] = 0;
+        }
+    }
+    _visible.clear();
+    _projectedTransform = 0;
+    _projectedReckoning = 0;
+}
+
+void
+Radar::projectAircraft( Vector2 radarAt ) {
+    forgetProjected();
+    // Aircraft stored since the last snapshot aren't reckoned yet.
+    const size_t slotCount = _reckoning.slotCount();
+    const std::vector< int32_t > & longitudes = _reckoning.longitudesE6();
+    const std::vector< int32_t > & latitudes = _reckoning.latitudesE6();
+
+    // Only the aircraft in view, or close enough that their marker shows, are
+    // projected and drawn. The index has them where they last reported, so it is
+    // asked for everything that could have been reckoned into view since.
+    _drawn.resize( slotCount, 0 );
+    _screenX.resize( slotCount );
+    _screenY.resize( slotCount );
+    const float margin = 2 * hoverRadius;
+    const GeoCoord northWest = _transform.unproject( Vector2( radarAt.x() - margin,
+                                                              radarAt.y() - margin ) );
+    const GeoCoord southEast = _transform.unproject(
+        Vector2( radarAt.x() + size().width() + margin, radarAt.y() + size().height() + margin ) );
+    const int32_t west = toMicroDegrees( northWest.longitude );
+    const int32_t east = toMicroDegrees( southEast.longitude );
+    const int32_t south = toMicroDegrees( southEast.latitude );
+    const int32_t north = toMicroDegrees( northWest.latitude );
+    const double longitudeReach = fromMicroDegrees( _reckoning.longitudeReachE6() );
+    const double latitudeReach = fromMicroDegrees( _reckoning.latitudeReachE6() );
+    const GeoBb reachable = { { northWest.longitude - longitudeReach,
+                                southEast.latitude - latitudeReach },
+                              { southEast.longitude + longitudeReach,
+                                northWest.latitude + latitudeReach } };
+    _geoIndex.forEachWithin( reachable, [ & ]( FlightSlot slot ) {
+        if( slot < slotCount && longitudes[ slot ] >= west && longitudes[ slot ] <= east &&
+            latitudes[ slot ] >= south && latitudes[ slot ] <= north ) {
+            _visible.push_back( slot );
+        }
+    } );
+    const size_t visibleCount = _visible.size();
+    _visibleLongitudeE6.resize( visibleCount );
+    _visibleLatitudeE6.resize( visibleCount );
+    _visibleX.resize( visibleCount );
+    _visibleY.resize( visibleCount );
+    for( size_t i = 0; i < visibleCount; ++i ) {
+        _visibleLongitudeE6[ i ] = longitudes[ _visible[ i ] ];
+        _visibleLatitudeE6[ i ] = latitudes[ _visible[ i ] ];
+    }
+    _transform.project( _visibleLongitudeE6.data(), _visibleLatitudeE6.data(), visibleCount,
+                        _visibleX.data(), _visibleY.data() );
+    for( size_t i = 0; i < visibleCount; ++i ) {
+        const FlightSlot slot = _visible[ i ];
+        _screenX[ slot ] = _visibleX[ i ];
+        _screenY[ slot ] = _visibleY[ i ];
+        _drawn[ slot ] = 1;
+    }
+    _picks.viewIs( radarAt, size() );
+    _picks.update( _screenX.data(), _screenY.data(), _drawn.data(), slotCount );
+    _projectedTransform = _transformVersion;
+    _projectedReckoning = _reckoning.version();
+}
+
+void
+Radar::drawAircraft( const DrawContext & ctx ) {
+    // Projected again only when the view changed or aircraft moved; frames drawn
+    // for anything else, such as the cursor moving, reuse the last positions.
+    if( _projectedTransform != _transformVersion ||
+        _projectedReckoning != _reckoning.version() ) {
+        projectAircraft( ctx.at );
+    }
+    _hovered = _picks.nearest( ctx.mousePos, hoverRadius );
+
+    const double scale = _transform.metersPerPixel();
+    _markers.clear();
+    for( const FlightSlot slot : _visible ) {
+        if( _trailSeconds > 0 ) {
+            drawTrail( ctx.at, slot, scale );
+        }
+        drawFlight( Vector2( _screenX[ slot ], _screenY[ slot ] ), slot == _hovered );
+    }
+    _markers.draw();
+    if( _labels ) {
+        drawLabels( ctx.at );
+    }
+}
+
+namespace {
+
+// Shows a radar fed by `source` in the open window until it is closed. The
+// radar holds GPU buffers, shaders and render textures, so it lives in here and
+// is gone before the window and its GL context are.
+void
+showRadar( IngestWorker::Source source, double maxFps ) {
+    int windowWidth = rl::GetScreenWidth();
+    int windowHeight = rl::GetScreenHeight();
+
+    Dile::LayoutManager layoutManager;
+
+    RectangleV2 root{ layoutManager, rl::BLANK };
+    root.xLayoutMut()->paddingIs( 20 );
+    root.yLayoutMut()->paddingIs( 20 );
+
+    VStackV2 vstack{ layoutManager };
+    vstack.xLayoutMut()->sizeSpecIs( Dile::SizeSpec::grow() );
+    vstack.yLayoutMut()->sizeSpecIs( Dile::SizeSpec::grow() );
+    vstack.yLayoutMut()->childGapIs( 5 );
+    root.addChild( &vstack );
+
+    RectangleV2 modeLine{ layoutManager, rl::BLUE };
+    modeLine.xLayoutMut()->sizeSpecIs( Dile::SizeSpec::growAcrossAxis() );
+    modeLine.xLayoutMut()->paddingIs( 5 );
+    modeLine.yLayoutMut()->sizeSpecIs( Dile::SizeSpec::absolute( 20 ) );
+    modeLine.yLayoutMut()->paddingIs( 5 );
+    vstack.addChild( &modeLine );
+
+    ScrollingText modeLineText{
+        layoutManager,
+        "In all cases the compiler may initialise all these variables at compile time, but when marked constexpr or constinit you tell the compiler...",
+        rl::GetFontDefault(),
+        12,
+        1,
+        rl::BLACK,
+        30 };
+    modeLineText.xLayoutMut()->sizeSpecIs( Dile::SizeSpec::grow() );
+    modeLineText.xLayoutMut()->sizeSpecIs( Dile::SizeSpec::grow() );
+    modeLine.addChild( &modeLineText );
+
+    Radar radar{ layoutManager };
+    radar.xLayoutMut()->sizeSpecIs( Dile::SizeSpec::growAcrossAxis() );
+    radar.yLayoutMut()->sizeSpecIs( Dile::SizeSpec::grow() );
+    radar.geoBbIs( { { -71.245840, 42.183094 },
+                     { -70.777170, 42.529427 } } );
+    vstack.addChild( &radar );
+
+    IngestWorker ingest( std::move( source ) );
+    FrameScheduler frames;
+    frames.maxFpsIs( maxFps );
+
+    while( !rl::WindowShouldClose() ) {
+        // Anything the user does shows in the next frame.
+        if( rl::GetKeyPressed() != 0 || rl::GetMouseWheelMove() != 0 ||
+            rl::GetMouseDelta().x != 0 || rl::GetMouseDelta().y != 0 ||
+            rl::IsMouseButtonPressed( rl::MOUSE_BUTTON_LEFT ) ||
+            rl::IsMouseButtonReleased( rl::MOUSE_BUTTON_LEFT ) || rl::IsWindowResized() ) {
+            frames.invalidate();
+        }
+        if( rl::IsKeyPressed( rl::KEY_M ) ) {
+            radar.projectionIs( radar.projection() == ScreenTransform::Projection::webMercator ?
+                                    ScreenTransform::Projection::equirectangular :
+                                    ScreenTransform::Projection::webMercator );
+            fmt::print( "Projection: {}\n", radar.projection() );
+        }
+        // Drag to pan, scroll or +/- to zoom around the cursor, R to go back.
+        const Vector2 cursor = Vector2::fromRlVector2( rl::GetMousePosition() );
+        if( rl::IsMouseButtonDown( rl::MOUSE_BUTTON_LEFT ) ) {
+            radar.panBy( Vector2::fromRlVector2( rl::GetMouseDelta() ) );
+        }
+        const float wheel = rl::GetMouseWheelMove();
+        if( wheel != 0 ) {
+            radar.zoomBy( std::pow( 1.25, wheel ), cursor );
+        }
+        if( rl::IsKeyPressed( rl::KEY_EQUAL ) ) {
+            radar.zoomBy( 2, cursor );
+        }
+        if( rl::IsKeyPressed( rl::KEY_MINUS ) ) {
+            radar.zoomBy( 0.5, cursor );
+        }
+        if( rl::IsKeyPressed( rl::KEY_R ) ) {
+            radar.viewReset();
+        }
+        if( rl::IsKeyPressed( rl::KEY_L ) ) {
+            radar.labelsIs( !radar.labels() );
+        }
+        if( rl::IsKeyPressed( rl::KEY_C ) ) {
+            radar.clustersIs( !radar.clusters() );
+        }
+        // Once the source has run dry and its snapshots are drawn, only the user
+        // can change what is shown.
+        const bool dry = ingest.finished();
+        while( auto snapshot = ingest.poll() ) {
+            frames.invalidate();
+            const auto & changes = radar.snapshotIs( *snapshot );
+            fmt::print( "Snapshot {}: {} aircraft, {} new, {} gone, {} quarantined, "
+                        "tracks {:.1f}x simplified\n",
+                        snapshot->time, radar.flightsConst().size(),
+                        changes.inserted.size(), changes.removed.size(),
+                        snapshot->stats.quarantined(),
+                        radar.historyConst().tier( 0 ).compression().ratio() );
+            ingest.recycle( std::move( snapshot ) );
+        }
+
+        const double now = rl::GetTime();
+        if( !frames.due( now ) ) {
+            if( dry && !frames.animating() ) {
+                rl::EnableEventWaiting();
+                rl::PollInputEvents();
+                rl::DisableEventWaiting();
+            } else {
+                rl::WaitTime( frames.wait( now ) );
+                rl::PollInputEvents();
+            }
+            continue;
+        }
+
+        windowWidth = rl::GetScreenWidth();
+        windowHeight = rl::GetScreenHeight();
+        // The time since the last frame drawn, however long ago that was.
+        const float deltaTime = static_cast< float >( frames.drawn( now ) );
+        const Vector2 mousePos = Vector2::fromRlVector2( rl::GetMousePosition() );
+
+        root.xLayoutMut()->sizeSpecIs( Dile::SizeSpec::absolute( windowWidth ) );
+        root.yLayoutMut()->sizeSpecIs( Dile::SizeSpec::absolute( windowHeight ) );
+        root.computeLayout();
+
+        rl::BeginDrawing();
+        rl::ClearBackground( rl::RAYWHITE );
+
+        DrawContext drawCtx;
+        drawCtx.at = { 0, 0 };
+        drawCtx.deltaTime = deltaTime;
+        drawCtx.mousePos = mousePos;
+        root.draw( drawCtx );
+
+        rl::EndDrawing();
+        // The mode line scrolls on whatever frames are drawn, but doesn't keep an
+        // otherwise idle window drawing.
+        frames.animatingIs( radar.animating() );
+    }
+}
+
+} // namespace
+
+// Opens a window with a radar fed by `source` until the window is closed. Frames
+// are only drawn when something changed or moves, at most `maxFps` a second
+// unless that is 0.
+int
+runRadar( IngestWorker::Source source, double maxFps ) {
+    rl::SetConfigFlags( rl::FLAG_WINDOW_RESIZABLE );
+    rl::InitWindow( 800, 600, "Radar Demo" );
+    showRadar( std::move( source ), maxFps );
+    rl::CloseWindow();
+    return 0;
+}
+
+int
+testRadar( double maxFps ) {
+    return runRadar( IngestWorker::fileSource( "../sample_data.json" ), maxFps );
+}
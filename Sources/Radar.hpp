@@ -0,0 +1,162 @@
+#pragma once
+
+#include "Dile/Dile.hpp"
+
+#include "CachedLayer.hpp"
+#include "ClusterGrid.hpp"
+#include "DeadReckoning.hpp"
+#include "FlightData.hpp"
+#include "FlightStore.hpp"
+#include "GeoGrid.hpp"
+#include "LabelPlacer.hpp"
+#include "Layout.hpp"
+#include "MarkerBatch.hpp"
+#include "PickGrid.hpp"
+#include "ScreenTransform.hpp"
+#include "Snapshot.hpp"
+#include "SizeTypes.hpp"
+#include "TieredHistory.hpp"
+
+class Radar: public ComponentV2 {
+public:
+    // How close the cursor has to be to an aircraft to pick it, in pixels.
+    static constexpr float hoverRadius = 5;
+    // How far `zoomBy` goes from the `geoBb` view each way.
+    static constexpr double minZoom = 1.0 / 1024;
+    static constexpr double maxZoom = 256;
+    static constexpr int labelFontSize = 10;
+    // Zoomed out until the finest cluster cells are smaller than this, aircraft
+    // are drawn as clusters in cells at least this many pixels tall.
+    static constexpr double clusterPixels = 40;
+
+    Radar( Dile::LayoutManager & layoutManager ): ComponentV2( layoutManager ) {};
+
+    FlightStore & flightsMut() { return _flights; }
+    const FlightStore & flightsConst() const { return _flights; }
+    TieredHistory & historyMut() { return _history; }
+    const TieredHistory & historyConst() const { return _history; }
+    // Replaces the tracked aircraft with those in `snapshot`, updating the ones
+    // that were already tracked in place and extending their tracks.
+    const FlightStore::SnapshotChanges & snapshotIs( const Snapshot & snapshot );
+    // Shows `val`, fitted into the radar, and makes it the view `viewReset`
+    // returns to.
+    void geoBbIs( const GeoBb & val );
+    // The box shown: `geoBb` zoomed in `zoom` times around `center`.
+    GeoBb view() const;
+    GeoCoord center() const { return _center; }
+    double zoom() const { return _zoom; }
+    // Zooms in `factor` times, keeping the point under `anchor` where it is.
+    void zoomBy( double factor, Vector2 anchor );
+    // Drags the map `pixels` across the radar.
+    void panBy( Vector2 pixels );
+    void viewReset();
+    ScreenTransform::Projection projection() const { return _projection; }
+    void projectionIs( ScreenTransform::Projection val ) { _projection = val; }
+    // How far back trails reach from the latest snapshot; 0 hides them.
+    void trailSecondsIs( uint32_t val ) { _trailSeconds = val; }
+    // Whether aircraft in view are labelled with their callsign where there's
+    // room.
+    bool labels() const { return _labels; }
+    void labelsIs( bool val ) { _labels = val; }
+    // Whether aircraft are drawn as clusters when zoomed out.
+    bool clusters() const { return _clusters; }
+    void clustersIs( bool val ) { _clusters = val; }
+    // The `ClusterGrid` level drawn as of the last frame, or -1 if aircraft were
+    // drawn one by one.
+    int32_t clusterLevel() const { return _clusterLevel; }
+
+    // Whether aircraft drawn in the last frame are still moving, and need more
+    // frames.
+    bool animating() const;
+    // The aircraft under the cursor as of the last frame, or
+    // `FlightStore::invalidSlot`.
+    FlightSlot hovered() const { return _hovered; }
+    const MarkerBatch & markersConst() const { return _markers; }
+
+    // Queues the marker of an aircraft, to be drawn with all the others.
+    void drawFlight( Vector2 at, bool hovered );
+    void drawTrail( Vector2 radarAt, FlightSlot slot, double metersPerPixel );
+    void draw( const DrawContext & ctx ) override;
+
+private:
+    // Rebuilds `_transform` if the view moved since the last frame.
+    void refreshTransform( Vector2 radarAt );
+    // Finds the aircraft in view and projects them into `_screenX`/`_screenY`.
+    void projectAircraft( Vector2 radarAt );
+    // Marks the aircraft drawn last as not drawn.
+    void forgetProjected();
+    // Moves the center so that `target` is drawn at `anchor`.
+    void keepAt( GeoCoord target, Vector2 anchor );
+    // Static layers, painted through `_layerTransform` into their textures.
+    void drawStaticLayers( Vector2 radarAt );
+    void paintGraticule() const;
+    void paintRangeRings() const;
+    void paintBorder() const;
+    // Places and draws the callsigns of the aircraft drawn this frame.
+    void drawLabels( Vector2 radarAt );
+    // The cluster level the view should be drawn with, or -1.
+    int32_t clusterLevelFor() const;
+    // Draws the aircraft in view one by one, or as clusters at `level`.
+    void drawAircraft( const DrawContext & ctx );
+    void drawClusters( const DrawContext & ctx, int32_t level );
+    Vector2 screenPosition( GeoCoord position ) const;
+
+    FlightStore _flights;
+    TieredHistory _history;
+    DeadReckoning _reckoning;
+    // Unix time of the frame being drawn: the latest snapshot's time, advanced by
+    // the frame times since.
+    double _clock = 0;
+    GeoBb _geoBb;
+    GeoCoord _center = {};
+    double _zoom = 1;
+    // Where the radar was drawn last.
+    Vector2 _at;
+    ScreenTransform::Projection _projection = ScreenTransform::Projection::equirectangular;
+    ScreenTransform _transform;
+    // Changes with `_transform`.
+    uint64_t _transformVersion = 0;
+    // The same view with the radar's top left at 0/0, for painting static layers,
+    // and a version that changes with it.
+    ScreenTransform _layerTransform;
+    uint64_t _layerVersion = 0;
+    CachedLayer _graticule;
+    CachedLayer _rangeRings;
+    CachedLayer _border;
+    // Where aircraft last reported, updated with every snapshot.
+    GeoGrid _geoIndex;
+    // Where aircraft last reported, counted per cell for drawing clusters.
+    ClusterGrid _clusterIndex;
+    bool _clusters = true;
+    int32_t _clusterLevel = -1;
+    // The clusters drawn this frame.
+    std::vector< ClusterGrid::Cluster > _shownClusters;
+    // The slots in view this frame, and their positions gathered into columns to
+    // be projected in one pass.
+    std::vector< FlightSlot > _visible;
+    std::vector< int32_t > _visibleLongitudeE6;
+    std::vector< int32_t > _visibleLatitudeE6;
+    std::vector< float > _visibleX;
+    std::vector< float > _visibleY;
+    // Where each slot in view is drawn this frame, and which are.
+    std::vector< float > _screenX;
+    std::vector< float > _screenY;
+    std::vector< uint8_t > _drawn;
+    // The `_transformVersion` and reckoning version those were projected for,
+    // 0 if they weren't; frames that change neither reuse them.
+    uint64_t _projectedTransform = 0;
+    uint64_t _projectedReckoning = 0;
+    PickGrid _picks;
+    MarkerBatch _markers;
+    FlightSlot _hovered = FlightStore::invalidSlot;
+    int64_t _time = 0;
+    uint32_t _trailSeconds = 5 * 60;
+    // Reused between trails.
+    std::vector< rl::Vector2 > _trailPoints;
+    bool _labels = true;
+    LabelPlacer _labelPlacer;
+    std::vector< LabelPlacer::Label > _labelQueue;
+    // Per slot: the callsign last measured and its width in pixels.
+    std::vector< CallSign > _measuredCallSign;
+    std::vector< float > _labelWidth;
+};
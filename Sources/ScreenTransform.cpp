@@ -0,0 +1,333 @@
+#include <algorithm>
+#include <cmath>
+
+#include "ScreenTransform.hpp"
+#include "Simd.hpp"
+
+#if ( defined( __x86_64__ ) || defined( __i386__ ) ) && \
+    ( defined( __GNUC__ ) || defined( __clang__ ) )
+#define FTL_TRANSFORM_X86 1
+#endif
+
+namespace {
+
+// Web Mercator stops here, which makes the world square.
+constexpr double maxMercatorLatitude = 85.05112878;
+constexpr double earthRadius = metersPerDegree * 180 / pi;
+
+struct Affine {
+    int32_t longitudeOriginE6;
+    int32_t latitudeOriginE6;
+    float xScale;
+    float yScale;
+    float xOffset;
+    float yOffset;
+    // Web Mercator rows, or null for linear latitudes.
+    const float * rows;
+    int32_t rowCount;
+    int32_t rowStartE6;
+    float rowsPerMicroDegree;
+};
+
+template< size_t width >
+struct Lanes;
+template<>
+struct Lanes< 4 > {
+    using Float = Simd::Float4;
+    using Int = Simd::Int4;
+    using Uint = Simd::Uint4;
+};
+template<>
+struct Lanes< 8 > {
+    using Float = Simd::Float8;
+    using Int = Simd::Int8;
+    using Uint = Simd::Uint8;
+};
+
+// `width` points per step, then one at a time for the tail. Always inlined, so
+// that the vectors get the instruction set of whichever kernel calls it.
+template< size_t width, bool mercator >
+__attribute__(( always_inline )) inline void
+projectWith( const Affine & affine, const int32_t * longitudesE6,
+             const int32_t * latitudesE6, size_t count, float * xs, float * ys ) {
+    using Float = typename Lanes< width >::Float;
+    using Int = typename Lanes< width >::Int;
+    using Uint = typename Lanes< width >::Uint;
+    const int32_t latitudeOriginE6 =
+        mercator ? affine.rowStartE6 : affine.latitudeOriginE6;
+    // Scalars broadcast to every lane.
+    const Uint longitudeOrigin = Uint{} + uint32_t( affine.longitudeOriginE6 );
+    const Uint latitudeOrigin = Uint{} + uint32_t( latitudeOriginE6 );
+    const Float xScale = Float{} + affine.xScale;
+    const Float yScale = Float{} + affine.yScale;
+    const Float xOffset = Float{} + affine.xOffset;
+    const Float yOffset = Float{} + affine.yOffset;
+    const Float rowsPerMicroDegree = Float{} + affine.rowsPerMicroDegree;
+    const Float firstRow = Float{};
+    const Float lastRow = Float{} + float( affine.rowCount - 1 );
+    const Int lastSegment = Int{} + ( affine.rowCount - 2 );
+
+    size_t i = 0;
+    for( ; i + width <= count; i += width ) {
+        Uint longitude;
+        Uint latitude;
+        __builtin_memcpy( &longitude, longitudesE6 + i, sizeof( longitude ) );
+        __builtin_memcpy( &latitude, latitudesE6 + i, sizeof( latitude ) );
+        // Unsigned, so that missing positions wrap rather than overflow.
+        const Int x = ( Int )( longitude - longitudeOrigin );
+        const Int y = ( Int )( latitude - latitudeOrigin );
+        const Float screenX = xOffset + xScale * __builtin_convertvector( x, Float );
+        Float screenY;
+        if constexpr( mercator ) {
+            // Clamped to the table with comparison masks, which are all ones
+            // where they hold.
+            Float row = __builtin_convertvector( y, Float ) * rowsPerMicroDegree;
+            const Int beforeStart = row < firstRow;
+            row = ( Float )( ( beforeStart & ( Int )firstRow ) | ( ~beforeStart & ( Int )row ) );
+            const Int pastEnd = row > lastRow;
+            row = ( Float )( ( pastEnd & ( Int )lastRow ) | ( ~pastEnd & ( Int )row ) );
+            Int segment = __builtin_convertvector( row, Int );
+            const Int pastLast = segment > lastSegment;
+            segment = ( pastLast & lastSegment ) | ( ~pastLast & segment );
+            const Float fraction = row - __builtin_convertvector( segment, Float );
+            Float below;
+            Float above;
+            for( size_t lane = 0; lane < width; ++lane ) {
+                below[ lane ] = affine.rows[ segment[ lane ] ];
+                above[ lane ] = affine.rows[ segment[ lane ] + 1 ];
+            }
+            screenY = below + fraction * ( above - below );
+        } else {
+            screenY = yOffset + yScale * __builtin_convertvector( y, Float );
+        }
+        __builtin_memcpy( xs + i, &screenX, sizeof( screenX ) );
+        __builtin_memcpy( ys + i, &screenY, sizeof( screenY ) );
+    }
+    for( ; i < count; ++i ) {
+        const int32_t x = int32_t( uint32_t( longitudesE6[ i ] ) -
+                                   uint32_t( affine.longitudeOriginE6 ) );
+        const int32_t y =
+            int32_t( uint32_t( latitudesE6[ i ] ) - uint32_t( latitudeOriginE6 ) );
+        xs[ i ] = affine.xOffset + affine.xScale * float( x );
+        if constexpr( mercator ) {
+            const float row = std::clamp( float( y ) * affine.rowsPerMicroDegree, 0.0f,
+                                          float( affine.rowCount - 1 ) );
+            const int32_t segment = std::min( int32_t( row ), affine.rowCount - 2 );
+            const float fraction = row - float( segment );
+            const float below = affine.rows[ segment ];
+            ys[ i ] = below + fraction * ( affine.rows[ segment + 1 ] - below );
+        } else {
+            ys[ i ] = affine.yOffset + affine.yScale * float( y );
+        }
+    }
+}
+
+void
+projectGeneric( const Affine & affine, const int32_t * longitudesE6,
+                const int32_t * latitudesE6, size_t count, float * xs, float * ys ) {
+    if( affine.rows ) {
+        projectWith< 4, true >( affine, longitudesE6, latitudesE6, count, xs, ys );
+    } else {
+        projectWith< 4, false >( affine, longitudesE6, latitudesE6, count, xs, ys );
+    }
+}
+
+#ifdef FTL_TRANSFORM_X86
+__attribute__(( target( "avx2" ) )) void
+projectAvx2( const Affine & affine, const int32_t * longitudesE6,
+             const int32_t * latitudesE6, size_t count, float * xs, float * ys ) {
+    if( affine.rows ) {
+        projectWith< 8, true >( affine, longitudesE6, latitudesE6, count, xs, ys );
+    } else {
+        projectWith< 8, false >( affine, longitudesE6, latitudesE6, count, xs, ys );
+    }
+}
+#endif
+
+double
+mercatorY( double latitude ) {
+    const double clamped = std::clamp( latitude, -maxMercatorLatitude, maxMercatorLatitude );
+    return std::log( std::tan( pi / 4 + toRadians( clamped ) / 2 ) );
+}
+
+double
+mercatorLatitude( double y ) {
+    return std::atan( std::sinh( y ) ) * ( 180 / pi );
+}
+
+} // namespace
+
+std::string_view
+format_as( ScreenTransform::Isa isa ) {
+    switch( isa ) {
+    case ScreenTransform::Isa::generic: return "generic";
+    case ScreenTransform::Isa::avx2: return "avx2";
+    }
+    return "?";
+}
+
+std::string_view
+format_as( ScreenTransform::Projection projection ) {
+    switch( projection ) {
+    case ScreenTransform::Projection::equirectangular: return "equirectangular";
+    case ScreenTransform::Projection::webMercator: return "web mercator";
+    }
+    return "?";
+}
+
+bool
+ScreenTransform::supported( Isa isa ) {
+#ifdef FTL_TRANSFORM_X86
+    __builtin_cpu_init();
+    switch( isa ) {
+    case Isa::generic: return true;
+    case Isa::avx2: return __builtin_cpu_supports( "avx2" );
+    }
+    return false;
+#else
+    return isa == Isa::generic;
+#endif
+}
+
+ScreenTransform::Isa
+ScreenTransform::bestIsa() {
+    // `ftl_bench project`: AVX2 takes 0.0002 ms for 1000 points to generic's
+    // 0.0005, and 0.0045 ms for 10000 to 0.0052, but 0.080 ms for 100000 to 0.064
+    // once the columns spill out of cache. The whole world is about 10000
+    // aircraft, so AVX2 wins at every size the radar sees.
+    static const Isa best = supported( Isa::avx2 ) ? Isa::avx2 : Isa::generic;
+    return best;
+}
+
+ScreenTransform::ScreenTransform( const GeoBb & geoBb, Vector2 origin, Vector2 size,
+                                  Projection projection ):
+        _geoBb( geoBb ), _origin( origin ), _size( size ), _projection( projection ) {
+    const bool mercator = projection == Projection::webMercator;
+    const double middleLongitude = ( geoBb.min.longitude + geoBb.max.longitude ) / 2;
+    const double middleLatitude = ( geoBb.min.latitude + geoBb.max.latitude ) / 2;
+    // Projected x per degree of longitude, and the projected latitude bounds.
+    const double xPerDegree = mercator ? pi / 180 : std::cos( toRadians( middleLatitude ) );
+    const double bottom = mercator ? mercatorY( geoBb.min.latitude ) : geoBb.min.latitude;
+    const double top = mercator ? mercatorY( geoBb.max.latitude ) : geoBb.max.latitude;
+    const double width = ( geoBb.max.longitude - geoBb.min.longitude ) * xPerDegree;
+    const double height = top - bottom;
+    // The tighter axis fits; an empty box puts everything on its one point.
+    _scale = std::min( width > 0 ? size.width() / width : HUGE_VAL,
+                       height > 0 ? size.height() / height : HUGE_VAL );
+    if( !std::isfinite( _scale ) ) {
+        _scale = 0;
+    }
+    _middleY = ( bottom + top ) / 2;
+    _centerY = origin.y() + size.height() / 2;
+    const double centerX = origin.x() + size.width() / 2;
+    if( _scale > 0 ) {
+        _metersPerPixel =
+            mercator ? earthRadius * std::cos( toRadians( mercatorLatitude( _middleY ) ) ) :
+                       metersPerDegree;
+        _metersPerPixel /= _scale;
+    }
+
+    _longitudeOriginE6 = toMicroDegrees( middleLongitude );
+    _latitudeOriginE6 = toMicroDegrees( middleLatitude );
+    const double xScale = _scale * xPerDegree;
+    _xScale = static_cast< float >( xScale / microDegreesPerDegree );
+    _xOffset = static_cast< float >(
+        centerX + xScale * ( fromMicroDegrees( _longitudeOriginE6 ) - middleLongitude ) );
+    // Screen y grows downward, so north is up.
+    _yScale = static_cast< float >( -_scale / microDegreesPerDegree );
+    _yOffset = static_cast< float >(
+        _centerY - _scale * ( fromMicroDegrees( _latitudeOriginE6 ) - middleLatitude ) );
+
+    if( mercator && _scale > 0 ) {
+        // A view's height beyond either edge, so aircraft just off screen still
+        // land on the right side of it.
+        const double reach = 1.5 * size.height() / _scale;
+        const double low = mercatorLatitude( _middleY - reach );
+        const double high = mercatorLatitude( _middleY + reach );
+        const size_t rowCount =
+            std::clamp< size_t >( size_t( 3 * size.height() ) + 1, 2, 1 << 14 );
+        _rowStartE6 = toMicroDegrees( low );
+        const double spanE6 = ( high - low ) * microDegreesPerDegree;
+        _rowsPerMicroDegree = static_cast< float >( ( rowCount - 1 ) / spanE6 );
+        _rows.resize( rowCount );
+        for( size_t row = 0; row < rowCount; ++row ) {
+            const double latitudeE6 = _rowStartE6 + row / double( _rowsPerMicroDegree );
+            _rows[ row ] =
+                static_cast< float >( mercatorRow( latitudeE6 / microDegreesPerDegree ) );
+        }
+    }
+}
+
+bool
+ScreenTransform::matches( const GeoBb & geoBb, Vector2 origin, Vector2 size,
+                          Projection projection ) const {
+    return geoBb.min.longitude == _geoBb.min.longitude &&
+           geoBb.min.latitude == _geoBb.min.latitude &&
+           geoBb.max.longitude == _geoBb.max.longitude &&
+           geoBb.max.latitude == _geoBb.max.latitude && origin.x() == _origin.x() &&
+           origin.y() == _origin.y() && size.width() == _size.width() &&
+           size.height() == _size.height() && projection == _projection;
+}
+
+double
+ScreenTransform::mercatorRow( double latitude ) const {
+    return _centerY - _scale * ( mercatorY( latitude ) - _middleY );
+}
+
+double
+ScreenTransform::tableRow( double latitudeE6 ) const {
+    const double row = ( latitudeE6 - _rowStartE6 ) * double( _rowsPerMicroDegree );
+    if( !( row >= 0 && row <= double( _rows.size() - 1 ) ) ) {
+        return mercatorRow( latitudeE6 / microDegreesPerDegree );
+    }
+    const size_t segment = std::min( size_t( row ), _rows.size() - 2 );
+    const double fraction = row - double( segment );
+    return _rows[ segment ] + fraction * ( _rows[ segment + 1 ] - _rows[ segment ] );
+}
+
+Vector2
+ScreenTransform::project( GeoCoord coord ) const {
+    const double x = coord.longitude * microDegreesPerDegree - _longitudeOriginE6;
+    const double screenX = _xOffset + double( _xScale ) * x;
+    if( !_rows.empty() ) {
+        return Vector2( screenX, tableRow( coord.latitude * microDegreesPerDegree ) );
+    }
+    const double y = coord.latitude * microDegreesPerDegree - _latitudeOriginE6;
+    return Vector2( screenX, _yOffset + double( _yScale ) * y );
+}
+
+GeoCoord
+ScreenTransform::unproject( Vector2 at ) const {
+    if( _scale == 0 ) {
+        return { fromMicroDegrees( _longitudeOriginE6 ), fromMicroDegrees( _latitudeOriginE6 ) };
+    }
+    const double longitudeE6 = _longitudeOriginE6 + ( at.x() - _xOffset ) / double( _xScale );
+    if( _projection == Projection::webMercator ) {
+        return { longitudeE6 / microDegreesPerDegree,
+                 mercatorLatitude( _middleY - ( at.y() - _centerY ) / _scale ) };
+    }
+    const double latitudeE6 = _latitudeOriginE6 + ( at.y() - _yOffset ) / double( _yScale );
+    return { longitudeE6 / microDegreesPerDegree, latitudeE6 / microDegreesPerDegree };
+}
+
+void
+ScreenTransform::project( const int32_t * longitudesE6, const int32_t * latitudesE6,
+                          size_t count, float * xs, float * ys, Isa isa ) const {
+    const Affine affine = { _longitudeOriginE6,
+                            _latitudeOriginE6,
+                            _xScale,
+                            _yScale,
+                            _xOffset,
+                            _yOffset,
+                            _rows.empty() ? nullptr : _rows.data(),
+                            static_cast< int32_t >( _rows.size() ),
+                            _rowStartE6,
+                            _rowsPerMicroDegree };
+#ifdef FTL_TRANSFORM_X86
+    if( isa == Isa::avx2 ) {
+        projectAvx2( affine, longitudesE6, latitudesE6, count, xs, ys );
+        return;
+    }
+#endif
+    projectGeneric( affine, longitudesE6, latitudesE6, count, xs, ys );
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "FlightData.hpp"
+#include "SizeTypes.hpp"
+
+// Maps coordinates onto the pixels of a radar through a map projection, with
+// north up and the GeoBb fitted into the radar without stretching it. All the
+// trigonometry happens when the view changes: after that a longitude is one
+// multiply-add, and so is a latitude under the equirectangular projection,
+// while Web Mercator looks the latitude up in a table with about one entry per
+// screen row. Whole columns of micro-degrees are projected at a time, 8 lanes
+// with AVX2 where the CPU has it, else 4 with SSE2 or NEON.
+//
+// Everything that draws or hit-tests aircraft goes through the same transform,
+// so what is under the cursor is what is drawn there.
+class ScreenTransform {
+public:
+    enum class Isa { generic, avx2 };
+    enum class Projection {
+        // Plate carrée with longitudes shrunk by the cosine of the middle
+        // latitude, so distances are true near the middle of the view.
+        equirectangular,
+        // Conformal: shapes and bearings are true everywhere, and scale grows
+        // toward the poles. Latitudes are clamped to +-85.05 degrees.
+        webMercator,
+    };
+
+    // The fastest kernel this CPU supports for as many aircraft as there are.
+    static Isa bestIsa();
+    static bool supported( Isa isa );
+
+    ScreenTransform() = default;
+    // Fits `geoBb` into the `size` pixels whose top left is at `origin`,
+    // centered.
+    ScreenTransform( const GeoBb & geoBb, Vector2 origin, Vector2 size,
+                     Projection projection = Projection::equirectangular );
+
+    // Whether this was built for the same view, and needn't be rebuilt.
+    bool matches( const GeoBb & geoBb, Vector2 origin, Vector2 size,
+                  Projection projection ) const;
+    Projection projection() const { return _projection; }
+    // Ground distance across one pixel at the middle of the view.
+    double metersPerPixel() const { return _metersPerPixel; }
+
+    Vector2 project( GeoCoord coord ) const;
+    // The inverse of `project`.
+    GeoCoord unproject( Vector2 at ) const;
+    // Projects `count` points into `xs` and `ys`. Points at
+    // `StateVector::missingE6` come out somewhere unspecified, and so do
+    // Mercator latitudes more than a view's height off screen.
+    void project( const int32_t * longitudesE6, const int32_t * latitudesE6, size_t count,
+                  float * xs, float * ys, Isa isa = bestIsa() ) const;
+
+private:
+    // Web Mercator screen y, computed and looked up.
+    double mercatorRow( double latitude ) const;
+    double tableRow( double latitudeE6 ) const;
+
+    GeoBb _geoBb = {};
+    Vector2 _origin;
+    Vector2 _size;
+    Projection _projection = Projection::equirectangular;
+    double _metersPerPixel = 0;
+    // Pixels per unit of projected coordinate, the projected middle of the box
+    // and where that is drawn.
+    double _scale = 0;
+    double _middleY = 0;
+    double _centerY = 0;
+
+    // x = xOffset + xScale * ( microDegrees - originE6 ), and y likewise under
+    // the equirectangular projection. Coordinates are taken relative to the
+    // middle of the box before going to float, so that they keep their
+    // precision however far from 0/0 the view is.
+    int32_t _longitudeOriginE6 = 0;
+    int32_t _latitudeOriginE6 = 0;
+    float _xScale = 0;
+    float _yScale = 0;
+    float _xOffset = 0;
+    float _yOffset = 0;
+
+    // Web Mercator screen y at evenly spaced latitudes, from a view's height
+    // below the screen to one above it; linear in between.
+    std::vector< float > _rows;
+    int32_t _rowStartE6 = 0;
+    float _rowsPerMicroDegree = 0;
+};
+std::string_view format_as( ScreenTransform::Isa isa );
+std::string_view format_as( ScreenTransform::Projection projection );
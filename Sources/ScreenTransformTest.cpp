@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <doctest/doctest.h>
+
+#include "ScreenTransform.hpp"
+#include "Synthetic.hpp"
+
+namespace {
+
+using Projection = ScreenTransform::Projection;
+
+const GeoBb boston = { { -71.245840, 42.183094 }, { -70.777170, 42.529427 } };
+
+} // namespace
+
+TEST_CASE( "screen transform puts north up and keeps shapes" ) {
+    const Vector2 origin( 20, 45 );
+    const Vector2 size( 760, 535 );
+    for( const Projection projection :
+         { Projection::equirectangular, Projection::webMercator } ) {
+        const ScreenTransform transform( boston, origin, size, projection );
+
+        // A kilometer east and a kilometer north of Logan are as far away from
+        // it on screen.
+        const GeoCoord logan{ -71.0096, 42.3656 };
+        const double degreesPerKm = 1000 / metersPerDegree;
+        const Vector2 at = transform.project( logan );
+        const Vector2 north =
+            transform.project( { logan.longitude, logan.latitude + degreesPerKm } );
+        const Vector2 east = transform.project(
+            { logan.longitude + degreesPerKm / std::cos( toRadians( logan.latitude ) ),
+              logan.latitude } );
+        CHECK( north.y() < at.y() );
+        CHECK( std::abs( north.x() - at.x() ) < 1e-3 );
+        CHECK( east.x() > at.x() );
+        CHECK( std::abs( east.y() - at.y() ) < 1e-3 );
+        CHECK( std::abs( ( at.y() - north.y() ) / ( east.x() - at.x() ) - 1 ) < 0.002 );
+        CHECK( std::abs( transform.metersPerPixel() * ( east.x() - at.x() ) - 1000 ) < 5 );
+
+        // The box fits inside the radar, centered, touching two of its sides.
+        const Vector2 low = transform.project( boston.min );
+        const Vector2 high = transform.project( boston.max );
+        CHECK( std::abs( ( low.x() + high.x() ) / 2 - 400 ) < 0.5 );
+        CHECK( std::abs( ( low.y() + high.y() ) / 2 - 312.5 ) < 0.5 );
+        CHECK( low.x() >= origin.x() - 0.5 );
+        CHECK( high.y() >= origin.y() - 0.5 );
+        CHECK( std::min( std::abs( high.y() - origin.y() ),
+                         std::abs( low.x() - origin.x() ) ) < 0.5 );
+
+        const GeoCoord back = transform.unproject( at );
+        CHECK( std::abs( back.longitude - logan.longitude ) < 1e-6 );
+        CHECK( std::abs( back.latitude - logan.latitude ) < 1e-6 );
+    }
+
+    const ScreenTransform transform( boston, origin, size, Projection::webMercator );
+    CHECK( transform.matches( boston, origin, size, Projection::webMercator ) );
+    CHECK( !transform.matches( boston, origin, size, Projection::equirectangular ) );
+    CHECK( !transform.matches( boston, origin, Vector2( 760, 536 ), Projection::webMercator ) );
+    CHECK( !transform.matches( { { -72, 42 }, { -71, 43 } }, origin, size,
+                               Projection::webMercator ) );
+}
+
+TEST_CASE( "web mercator stretches latitudes toward the poles" ) {
+    const ScreenTransform transform( { { -180, -80 }, { 180, 80 } }, Vector2( 0, 0 ),
+                                     Vector2( 1000, 1000 ), Projection::webMercator );
+    const double equator = transform.project( { 0, 0 } ).y();
+    const double tropic = transform.project( { 0, 20 } ).y();
+    const double arctic = transform.project( { 0, 60 } ).y();
+    const double further = transform.project( { 0, 80 } ).y();
+    CHECK( equator - tropic < ( tropic - arctic ) / 2 );
+    CHECK( tropic - arctic < arctic - further );
+    CHECK( std::abs( transform.project( { 0, -60 } ).y() - ( 2 * equator - arctic ) ) < 0.01 );
+    CHECK( std::abs( transform.unproject( Vector2( 500, arctic ) ).latitude - 60 ) < 1e-4 );
+}
+
+TEST_CASE( "screen transform projects columns like single points" ) {
+    // Not a whole number of vectors, so every kernel has a tail.
+    const size_t count = 1003;
+    Synthetic::XorShift rng( 4 );
+    std::vector< int32_t > longitudes( count );
+    std::vector< int32_t > latitudes( count );
+    for( size_t i = 0; i < count; ++i ) {
+        longitudes[ i ] = toMicroDegrees( rng.uniform( -73, -69 ) );
+        latitudes[ i ] = toMicroDegrees( rng.uniform( 41, 44 ) );
+    }
+    longitudes[ 7 ] = StateVector::missingE6;
+    latitudes[ 7 ] = StateVector::missingE6;
+
+    for( const Projection projection :
+         { Projection::equirectangular, Projection::webMercator } ) {
+        const ScreenTransform transform( boston, Vector2( 0, 0 ), Vector2( 1600, 900 ),
+                                         projection );
+        for( const ScreenTransform::Isa isa :
+             { ScreenTransform::Isa::generic, ScreenTransform::Isa::avx2 } ) {
+            if( !ScreenTransform::supported( isa ) ) {
+                continue;
+            }
+            std::vector< float > xs( count );
+            std::vector< float > ys( count );
+            transform.project( longitudes.data(), latitudes.data(), count, xs.data(),
+                               ys.data(), isa );
+            for( size_t i = 0; i < count; ++i ) {
+                if( i == 7 ) {
+                    continue;
+                }
+                const GeoCoord coord{ fromMicroDegrees( longitudes[ i ] ),
+                                      fromMicroDegrees( latitudes[ i ] ) };
+                const Vector2 at = transform.project( coord );
+                // Only aircraft on or near the screen have to be exact.
+                if( std::abs( at.y() - 450 ) > 1300 ) {
+                    continue;
+                }
+                REQUIRE( std::abs( xs[ i ] - at.x() ) < 0.05 );
+                REQUIRE( std::abs( ys[ i ] - at.y() ) < 0.05 );
+            }
+        }
+    }
+}
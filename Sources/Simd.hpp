@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Four-lane vectors on the GCC/Clang vector extensions. They compile to SSE2 on
+// x86-64 and NEON on ARM without any target flags, which is all the per-frame
+// passes over FlightStore columns need. Loops step `lanes` at a time over
+// columns padded with `paddedSize`, so there is no scalar tail.
+namespace Simd {
+
+constexpr size_t lanes = 4;
+using Float4 = float __attribute__(( vector_size( 16 ) ));
+using Int4 = int32_t __attribute__(( vector_size( 16 ) ));
+// For differences that may wrap, such as from a missing position.
+using Uint4 = uint32_t __attribute__(( vector_size( 16 ) ));
+// Eight lanes, for kernels built for a target with 256-bit registers such as
+// AVX2. The helpers below are four-lane only.
+using Float8 = float __attribute__(( vector_size( 32 ) ));
+using Int8 = int32_t __attribute__(( vector_size( 32 ) ));
+using Uint8 = uint32_t __attribute__(( vector_size( 32 ) ));
+
+constexpr size_t
+paddedSize( size_t size ) {
+    return ( size + lanes - 1 ) / lanes * lanes;
+}
+
+inline Float4
+load( const float * p ) {
+    Float4 v;
+    std::memcpy( &v, p, sizeof( v ) );
+    return v;
+}
+inline Int4
+load( const int32_t * p ) {
+    Int4 v;
+    std::memcpy( &v, p, sizeof( v ) );
+    return v;
+}
+inline void
+store( float * p, Float4 v ) {
+    std::memcpy( p, &v, sizeof( v ) );
+}
+inline void
+store( int32_t * p, Int4 v ) {
+    std::memcpy( p, &v, sizeof( v ) );
+}
+
+inline Float4
+splat( float x ) {
+    return Float4{ x, x, x, x };
+}
+inline Int4
+splat( int32_t x ) {
+    return Int4{ x, x, x, x };
+}
+
+// Lanes of `a` where `mask` is set, else of `b`. Masks are what comparisons
+// return: all ones or all zeros per lane.
+inline Float4
+select( Int4 mask, Float4 a, Float4 b ) {
+    return ( Float4 )( ( mask & ( Int4 )a ) | ( ~mask & ( Int4 )b ) );
+}
+inline Float4
+min( Float4 a, Float4 b ) {
+    return select( a < b, a, b );
+}
+inline Float4
+max( Float4 a, Float4 b ) {
+    return select( a > b, a, b );
+}
+
+// Truncates toward zero.
+inline Int4
+toInt( Float4 v ) {
+    return __builtin_convertvector( v, Int4 );
+}
+inline Float4
+toFloat( Int4 v ) {
+    return __builtin_convertvector( v, Float4 );
+}
+
+} // namespace Simd
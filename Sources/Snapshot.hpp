@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "FlightData.hpp"
+#include "ParseStats.hpp"
+
+// Every state of one /states/all response.
+struct Snapshot {
+    int64_t time = 0;
+    // Only the rows that passed validation.
+    std::vector< StateVector > states;
+    ParseStats stats;
+};
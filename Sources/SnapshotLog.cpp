@@ -0,0 +1,161 @@
+#include <cstring>
+
+#include "SnapshotLog.hpp"
+
+namespace SnapshotLog {
+
+namespace {
+
+constexpr size_t headerSize = sizeof( magic ) + sizeof( version );
+// time + count
+constexpr size_t snapshotHeaderSize = sizeof( int64_t ) + sizeof( uint32_t );
+
+template< typename T >
+void
+append( std::vector< char > & buffer, const T & value ) {
+    const char * bytes = reinterpret_cast< const char * >( &value );
+    buffer.insert( buffer.end(), bytes, bytes + sizeof( value ) );
+}
+
+} // namespace
+
+std::optional< Writer >
+Writer::open( const std::string & path ) {
+    std::FILE * file = std::fopen( path.c_str(), "wb" );
+    if( !file ) {
+        return std::nullopt;
+    }
+    if( std::fwrite( magic, sizeof( magic ), 1, file ) != 1 ||
+        std::fwrite( &version, sizeof( version ), 1, file ) != 1 ) {
+        std::fclose( file );
+        return std::nullopt;
+    }
+    return Writer( file );
+}
+
+Writer::Writer( Writer && other ) noexcept:
+    _file( other._file ),
+    _buffer( std::move( other._buffer ) ),
+    _snapshotCount( other._snapshotCount ) {
+    other._file = nullptr;
+}
+
+Writer::~Writer() {
+    if( _file ) {
+        std::fclose( _file );
+    }
+}
+
+bool
+Writer::write( const Snapshot & snapshot ) {
+    const uint32_t count = static_cast< uint32_t >( snapshot.states.size() );
+    const uint32_t byteLength =
+        static_cast< uint32_t >( snapshotHeaderSize + count * sizeof( State ) );
+
+    _buffer.clear();
+    _buffer.reserve( sizeof( byteLength ) + byteLength );
+    append( _buffer, byteLength );
+    append( _buffer, snapshot.time );
+    append( _buffer, count );
+    for( const StateVector & stateVector : snapshot.states ) {
+        State state = {};
+        state.icao24 = stateVector.icao24;
+        state.lastContact = stateVector.lastContact;
+        state.longitudeE6 = stateVector.longitudeE6;
+        state.latitudeE6 = stateVector.latitudeE6;
+        state.baroAltitude = stateVector.baroAltitude;
+        state.geoAltitude = stateVector.geoAltitude;
+        state.velocity = stateVector.velocity;
+        state.trueTrack = stateVector.trueTrack;
+        state.verticalRate = stateVector.verticalRate;
+        state.callSignSize = static_cast< uint8_t >( stateVector.callSign.size() );
+        std::memcpy( state.callSign, stateVector.callSign.view().data(),
+                     stateVector.callSign.size() );
+        state.flags = stateVector.flags;
+        state.squawk = stateVector.squawk;
+        append( _buffer, state );
+    }
+
+    if( std::fwrite( _buffer.data(), _buffer.size(), 1, _file ) != 1 ) {
+        return false;
+    }
+    ++_snapshotCount;
+    return true;
+}
+
+std::optional< Reader >
+Reader::open( const std::string & path ) {
+    auto file = MappedFile::open( path );
+    if( !file ) {
+        return std::nullopt;
+    }
+    const std::string_view bytes = file->bytes();
+    uint32_t fileVersion;
+    if( bytes.size() < headerSize ||
+        std::memcmp( bytes.data(), magic, sizeof( magic ) ) != 0 ) {
+        return std::nullopt;
+    }
+    std::memcpy( &fileVersion, bytes.data() + sizeof( magic ), sizeof( fileVersion ) );
+    if( fileVersion != version ) {
+        return std::nullopt;
+    }
+    Reader reader( std::move( *file ) );
+    reader.rewind();
+    return reader;
+}
+
+void
+Reader::rewind() {
+    _offset = headerSize;
+}
+
+bool
+Reader::next( Snapshot & snapshot ) {
+    const std::string_view bytes = _file.bytes();
+    uint32_t byteLength;
+    if( bytes.size() - _offset < sizeof( byteLength ) ) {
+        return false;
+    }
+    std::memcpy( &byteLength, bytes.data() + _offset, sizeof( byteLength ) );
+    const char * at = bytes.data() + _offset + sizeof( byteLength );
+    if( bytes.size() - _offset - sizeof( byteLength ) < byteLength ||
+        byteLength < snapshotHeaderSize ) {
+        return false;
+    }
+
+    uint32_t count;
+    std::memcpy( &snapshot.time, at, sizeof( snapshot.time ) );
+    std::memcpy( &count, at + sizeof( snapshot.time ), sizeof( count ) );
+    if( snapshotHeaderSize + size_t( count ) * sizeof( State ) > byteLength ) {
+        return false;
+    }
+    at += snapshotHeaderSize;
+
+    snapshot.states.resize( count );
+    // Only accepted states were logged.
+    snapshot.stats = ParseStats{};
+    snapshot.stats.rows[ size_t( StateStatus::ok ) ] = count;
+    for( StateVector & stateVector : snapshot.states ) {
+        State state;
+        std::memcpy( &state, at, sizeof( state ) );
+        at += sizeof( state );
+        stateVector.icao24 = state.icao24;
+        stateVector.lastContact = state.lastContact;
+        stateVector.longitudeE6 = state.longitudeE6;
+        stateVector.latitudeE6 = state.latitudeE6;
+        stateVector.baroAltitude = state.baroAltitude;
+        stateVector.geoAltitude = state.geoAltitude;
+        stateVector.velocity = state.velocity;
+        stateVector.trueTrack = state.trueTrack;
+        stateVector.verticalRate = state.verticalRate;
+        stateVector.callSign = CallSign::fromTrimmed(
+            std::string_view( state.callSign,
+                              std::min< size_t >( state.callSignSize, 8 ) ) );
+        stateVector.flags = state.flags;
+        stateVector.squawk = state.squawk;
+    }
+    _offset += sizeof( byteLength ) + byteLength;
+    return true;
+}
+
+} // namespace SnapshotLog
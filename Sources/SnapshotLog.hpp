@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "MappedFile.hpp"
+#include "Snapshot.hpp"
+
+// Compact binary log of ingested snapshots, for replaying recorded traffic
+// without re-parsing JSON. All integers are little-endian (host order on every
+// platform we build for).
+//
+//   file     := header snapshot*
+//   header   := "FTLG" u32:version
+//   snapshot := u32:byteLength i64:time u32:count state[count]
+//   state    := u32:icao24 u32:lastContact i32:longitudeE6 i32:latitudeE6
+//               f32:baroAltitude f32:geoAltitude f32:velocity f32:trueTrack
+//               f32:verticalRate u8:callSignSize char[8]:callSign u8:flags
+//               u16:squawk
+//
+// `byteLength` counts the bytes after itself, so a reader can skip snapshots
+// without decoding them. Every field is stored as in `StateVector`.
+namespace SnapshotLog {
+
+constexpr char magic[ 4 ] = { 'F', 'T', 'L', 'G' };
+constexpr uint32_t version = 2;
+
+struct State {
+    uint32_t icao24;
+    uint32_t lastContact;
+    int32_t longitudeE6;
+    int32_t latitudeE6;
+    float baroAltitude;
+    float geoAltitude;
+    float velocity;
+    float trueTrack;
+    float verticalRate;
+    uint8_t callSignSize;
+    char callSign[ 8 ];
+    uint8_t flags;
+    uint16_t squawk;
+};
+static_assert( sizeof( State ) == 48 );
+
+class Writer {
+public:
+    // Creates (or truncates) `path` and writes the file header.
+    static std::optional< Writer > open( const std::string & path );
+
+    Writer( Writer && other ) noexcept;
+    Writer( const Writer & ) = delete;
+    Writer & operator=( const Writer & ) = delete;
+    ~Writer();
+
+    bool write( const Snapshot & snapshot );
+    size_t snapshotCount() const { return _snapshotCount; }
+
+private:
+    explicit Writer( std::FILE * file ): _file( file ) {}
+
+    std::FILE * _file;
+    std::vector< char > _buffer;
+    size_t _snapshotCount = 0;
+};
+
+class Reader {
+public:
+    // Maps `path` and checks its header.
+    static std::optional< Reader > open( const std::string & path );
+
+    // Decodes the next snapshot into `snapshot`, reusing its storage. Returns
+    // false at the end of the log or at a truncated snapshot.
+    bool next( Snapshot & snapshot );
+    // Back to the first snapshot.
+    void rewind();
+
+private:
+    explicit Reader( MappedFile file ): _file( std::move( file ) ) {}
+
+    MappedFile _file;
+    size_t _offset = 0;
+};
+
+} // namespace SnapshotLog
@@ -0,0 +1,54 @@
+#include <cstring>
+#include <filesystem>
+
+#include <doctest/doctest.h>
+
+#include "OpenSky.hpp"
+#include "SnapshotLog.hpp"
+#include "Synthetic.hpp"
+
+TEST_CASE( "snapshot log round trips" ) {
+    const std::string path =
+        ( std::filesystem::temp_directory_path() / "ftl_snapshot_log_test.ftlog" ).string();
+
+    std::vector< Snapshot > recorded( 3 );
+    for( size_t i = 0; i < recorded.size(); ++i ) {
+        REQUIRE( OpenSky::parseSnapshot(
+            Synthetic::statesJson( 100 * i, i + 1, 1000 + 5 * i ), recorded[ i ] ) );
+    }
+    {
+        auto writer = SnapshotLog::Writer::open( path );
+        REQUIRE( writer );
+        for( const Snapshot & snapshot : recorded ) {
+            CHECK( writer->write( snapshot ) );
+        }
+    }
+
+    auto reader = SnapshotLog::Reader::open( path );
+    REQUIRE( reader );
+    Snapshot replayed;
+    for( const Snapshot & snapshot : recorded ) {
+        REQUIRE( reader->next( replayed ) );
+        CHECK( replayed.time == snapshot.time );
+        REQUIRE( replayed.states.size() == snapshot.states.size() );
+        for( size_t i = 0; i < snapshot.states.size(); ++i ) {
+            CHECK( std::memcmp( &replayed.states[ i ], &snapshot.states[ i ],
+                                sizeof( StateVector ) ) == 0 );
+        }
+    }
+    CHECK_FALSE( reader->next( replayed ) );
+
+    reader->rewind();
+    CHECK( reader->next( replayed ) );
+    CHECK( replayed.time == recorded[ 0 ].time );
+
+    SUBCASE( "truncated logs stop at the last whole snapshot" ) {
+        std::filesystem::resize_file( path, std::filesystem::file_size( path ) - 1 );
+        auto truncated = SnapshotLog::Reader::open( path );
+        REQUIRE( truncated );
+        CHECK( truncated->next( replayed ) );
+        CHECK( truncated->next( replayed ) );
+        CHECK_FALSE( truncated->next( replayed ) );
+    }
+    std::filesystem::remove( path );
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <assert.h>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer
+// thread. Each side only writes its own index, and the acquire/release pair on
+// that index is what publishes the slot contents to the other side.
+template< typename T >
+class SpscQueue {
+public:
+    explicit SpscQueue( size_t capacity ): _slots( roundUp( capacity + 1 ) ) {
+        _mask = _slots.size() - 1;
+    }
+
+    // Producer side. Returns false, leaving `value` untouched, if the queue is full.
+    bool push( T & value ) {
+        const size_t tail = _tail.load( std::memory_order_relaxed );
+        const size_t next = ( tail + 1 ) & _mask;
+        if( next == _head.load( std::memory_order_acquire ) ) {
+            return false;
+        }
+        _slots[ tail ] = std::move( value );
+        _tail.store( next, std::memory_order_release );
+        return true;
+    }
+
+    // Consumer side.
+    std::optional< T > pop() {
+        const size_t head = _head.load( std::memory_order_relaxed );
+        if( head == _tail.load( std::memory_order_acquire ) ) {
+            return std::nullopt;
+        }
+        std::optional< T > value( std::move( _slots[ head ] ) );
+        _head.store( ( head + 1 ) & _mask, std::memory_order_release );
+        return value;
+    }
+
+    bool empty() const {
+        return _head.load( std::memory_order_acquire ) ==
+               _tail.load( std::memory_order_acquire );
+    }
+
+private:
+    static size_t roundUp( size_t n ) {
+        size_t result = 2;
+        while( result < n ) {
+            result *= 2;
+        }
+        return result;
+    }
+
+    std::vector< T > _slots;
+    size_t _mask;
+    // On separate cache lines so the two threads don't false-share.
+    alignas( 64 ) std::atomic< size_t > _head{ 0 };
+    alignas( 64 ) std::atomic< size_t > _tail{ 0 };
+};
@@ -0,0 +1,254 @@
+#pragma once
+
+#include <cfloat>
+#include <cstdint>
+#include <string_view>
+
+#include "FlightData.hpp"
+#include "ParseStats.hpp"
+
+// JSON types a state field may hold; `fieldTypes` combines them per field.
+enum FieldType : uint8_t {
+    stringField = 1 << 0,
+    numberField = 1 << 1,
+    boolField = 1 << 2,
+    arrayField = 1 << 3,
+    nullField = 1 << 4,
+};
+
+// Whether a JSON number is a Unix time in seconds that fits the fields it goes
+// into. Anything else, such as 1e300, would be undefined behaviour to convert.
+inline bool
+isUnixTime( double val ) {
+    return val >= 0 && val <= UINT32_MAX;
+}
+
+// Validates and fills a `StateVector` one field at a time, so every parser
+// backend agrees on what each field means. The first problem found decides the
+// row's status; later fields are still consumed but no longer checked.
+class StateBuilder {
+public:
+    void begin() {
+        _stateVector = StateVector{};
+        _timePosition = -1;
+        _status = StateStatus::ok;
+    }
+
+    // `text` is the number as written, if the parser has it; coordinates are
+    // read from it instead of from `val`.
+    void number( int field, double val, std::string_view text = {} ) {
+        if( !accepts( field, numberField ) ) {
+            return;
+        }
+        switch( field ) {
+        case 3:
+            if( inRange( val, 0, UINT32_MAX ) ) {
+                _timePosition = static_cast< int64_t >( val );
+            }
+            break;
+        case 4:
+            if( inRange( val, 0, UINT32_MAX ) ) {
+                _stateVector.lastContact = static_cast< uint32_t >( val );
+            }
+            break;
+        case 5:
+            if( inRange( val, -180, 180 ) ) {
+                _stateVector.longitudeE6 = microDegreesOf( val, text );
+            }
+            break;
+        case 6:
+            if( inRange( val, -90, 90 ) ) {
+                _stateVector.latitudeE6 = microDegreesOf( val, text );
+            }
+            break;
+        case 7: _stateVector.baroAltitude = floatOf( val ); break;
+        case 9: _stateVector.velocity = floatOf( val ); break;
+        case 10: _stateVector.trueTrack = floatOf( val ); break;
+        case 11: _stateVector.verticalRate = floatOf( val ); break;
+        case 13: _stateVector.geoAltitude = floatOf( val ); break;
+        case 16:
+            if( inRange( val, 0, 3 ) ) {
+                _stateVector.positionSourceIs( static_cast< uint8_t >( val ) );
+            }
+            break;
+        default: break;
+        }
+    }
+
+    void string( int field, std::string_view val ) {
+        if( !accepts( field, stringField ) ) {
+            return;
+        }
+        switch( field ) {
+        case 0:
+            _stateVector.icao24 = icao24FromHex( val );
+            if( _stateVector.icao24 == invalidIcao24 ) {
+                reject( StateStatus::badIcao24 );
+            }
+            break;
+        case 1: _stateVector.callSign = CallSign::fromTrimmed( val ); break;
+        case 14: _stateVector.squawk = squawkFromOctal( val ); break;
+        default: break;
+        }
+    }
+
+    void boolean( int field, bool val ) {
+        if( !accepts( field, boolField ) ) {
+            return;
+        }
+        if( field == 8 ) {
+            _stateVector.onGroundIs( val );
+        } else if( field == 15 ) {
+            _stateVector.spiIs( val );
+        }
+    }
+
+    void null( int field ) { accepts( field, nullField ); }
+
+    // A nested array or object; only the sensor ids are one.
+    void container( int field, bool isArray ) {
+        accepts( field, isArray ? arrayField : 0 );
+    }
+
+    StateStatus finish( int fieldCount, StateVector & stateVector ) {
+        if( fieldCount < requiredFieldCount ) {
+            reject( StateStatus::tooFewFields );
+        }
+        if( ( _stateVector.longitudeE6 == StateVector::missingE6 ) !=
+            ( _stateVector.latitudeE6 == StateVector::missingE6 ) ) {
+            reject( StateStatus::outOfRange );
+        }
+        if( _status != StateStatus::ok ) {
+            return _status;
+        }
+        if( _stateVector.callSign.empty() ) {
+            _stateVector.callSign = CallSign::unknown();
+        }
+        if( _timePosition >= 0 && _stateVector.lastContact ) {
+            _stateVector.positionAgeIs( _stateVector.lastContact - _timePosition );
+        }
+        stateVector = _stateVector;
+        return StateStatus::ok;
+    }
+
+private:
+    // Every state has the first 17 fields; the 18th, the aircraft category, is only
+    // sent on request. Fields past those are ignored.
+    static constexpr int requiredFieldCount = 17;
+    static constexpr uint8_t fieldTypes[] = {
+        stringField,                // icao24
+        stringField | nullField,    // callsign
+        stringField | nullField,    // origin_country
+        numberField | nullField,    // time_position
+        numberField,                // last_contact
+        numberField | nullField,    // longitude
+        numberField | nullField,    // latitude
+        numberField | nullField,    // baro_altitude
+        boolField,                  // on_ground
+        numberField | nullField,    // velocity
+        numberField | nullField,    // true_track
+        numberField | nullField,    // vertical_rate
+        arrayField | nullField,     // sensors
+        numberField | nullField,    // geo_altitude
+        stringField | nullField,    // squawk
+        boolField,                  // spi
+        numberField,                // position_source
+        numberField | nullField,    // category
+    };
+    static constexpr int knownFieldCount = sizeof( fieldTypes );
+
+    static uint16_t squawkFromOctal( std::string_view digits ) {
+        if( digits.size() != 4 ) {
+            return StateVector::noSquawk;
+        }
+        uint16_t squawk = 0;
+        for( const char c : digits ) {
+            if( c < '0' || c > '7' ) {
+                return StateVector::noSquawk;
+            }
+            squawk = static_cast< uint16_t >( ( squawk << 3 ) | ( c - '0' ) );
+        }
+        return squawk;
+    }
+
+    // Rounds a JSON number to micro-degrees straight from its text, so no binary
+    // floating-point step rounds it first. Returns false for exponents and huge
+    // integer parts, which the caller converts from the parsed double instead.
+    static bool microDegreesFromText( std::string_view text, int32_t & microDegrees ) {
+        size_t i = 0;
+        const bool negative = !text.empty() && text[ 0 ] == '-';
+        i += negative;
+        int64_t value = 0;
+        for( ; i < text.size() && text[ i ] >= '0' && text[ i ] <= '9'; ++i ) {
+            value = value * 10 + ( text[ i ] - '0' );
+            if( value > 1000 ) {
+                return false;
+            }
+        }
+        if( i < text.size() && text[ i ] == '.' ) {
+            ++i;
+        }
+        // Six fraction digits, then the seventh rounds half away from zero.
+        for( int digit = 0; digit < 7; ++digit ) {
+            const bool isDigit = i < text.size() && text[ i ] >= '0' && text[ i ] <= '9';
+            const int d = isDigit ? text[ i ] - '0' : 0;
+            i += isDigit;
+            if( digit < 6 ) {
+                value = value * 10 + d;
+            } else {
+                value += d >= 5;
+            }
+        }
+        while( i < text.size() && text[ i ] >= '0' && text[ i ] <= '9' ) {
+            ++i;
+        }
+        if( i != text.size() ) {
+            return false;
+        }
+        microDegrees = static_cast< int32_t >( negative ? -value : value );
+        return true;
+    }
+
+    static int32_t microDegreesOf( double val, std::string_view text ) {
+        int32_t microDegrees;
+        if( text.empty() || !microDegreesFromText( text, microDegrees ) ) {
+            microDegrees = toMicroDegrees( val );
+        }
+        return microDegrees;
+    }
+
+    void reject( StateStatus status ) {
+        if( _status == StateStatus::ok ) {
+            _status = status;
+        }
+    }
+
+    bool accepts( int field, uint8_t type ) {
+        if( _status != StateStatus::ok ) {
+            return false;
+        }
+        if( field >= knownFieldCount || ( fieldTypes[ field ] & type ) ) {
+            return true;
+        }
+        reject( field == 0 ? StateStatus::badIcao24 : StateStatus::wrongType );
+        return false;
+    }
+
+    bool inRange( double val, double lo, double hi ) {
+        if( val >= lo && val <= hi ) {
+            return true;
+        }
+        reject( StateStatus::outOfRange );
+        return false;
+    }
+
+    // `val` as a float field; one it doesn't fit quarantines the row.
+    float floatOf( double val ) {
+        return inRange( val, -FLT_MAX, FLT_MAX ) ? static_cast< float >( val )
+                                                 : StateVector::missing;
+    }
+
+    StateVector _stateVector;
+    int64_t _timePosition = -1;
+    StateStatus _status = StateStatus::ok;
+};
@@ -0,0 +1,225 @@
+#include <cstring>
+
+#include "StructuralIndex.hpp"
+
+#if ( defined( __x86_64__ ) || defined( __i386__ ) ) && \
+    ( defined( __GNUC__ ) || defined( __clang__ ) )
+#define FTL_STRUCTURAL_X86 1
+#include <immintrin.h>
+#endif
+
+namespace StructuralIndex {
+
+namespace {
+
+constexpr size_t blockSize = 64;
+
+// One bit per byte of a 64-byte block.
+struct BlockMasks {
+    uint64_t quote;
+    uint64_t backslash;
+    // { } [ ] : ,
+    uint64_t op;
+    // The four bytes JSON allows between tokens: space, tab, newline and return.
+    uint64_t space;
+};
+
+BlockMasks
+classifyScalar( const char * block ) {
+    BlockMasks masks = {};
+    for( size_t i = 0; i < blockSize; ++i ) {
+        const uint64_t bit = uint64_t( 1 ) << i;
+        switch( block[ i ] ) {
+        case '"': masks.quote |= bit; break;
+        case '\\': masks.backslash |= bit; break;
+        case '{':
+        case '}':
+        case '[':
+        case ']':
+        case ':':
+        case ',': masks.op |= bit; break;
+        case ' ':
+        case '\t':
+        case '\n':
+        case '\r': masks.space |= bit; break;
+        default: break;
+        }
+    }
+    return masks;
+}
+
+#ifdef FTL_STRUCTURAL_X86
+
+// SSE4.2's string compare matches each byte against a whole set at once.
+__attribute__(( target( "sse4.2" ) )) BlockMasks
+classifySse42( const char * block ) {
+    constexpr int setMatch = _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_BIT_MASK;
+    const __m128i ops = _mm_setr_epi8( '{', '}', '[', ']', ':', ',', 0, 0, 0, 0, 0, 0,
+                                       0, 0, 0, 0 );
+    const __m128i spaces = _mm_setr_epi8( ' ', '\t', '\n', '\r', 0, 0, 0, 0, 0, 0, 0,
+                                          0, 0, 0, 0, 0 );
+    const __m128i quote = _mm_set1_epi8( '"' );
+    const __m128i backslash = _mm_set1_epi8( '\\' );
+
+    BlockMasks masks = {};
+    for( int i = 0; i < 4; ++i ) {
+        const __m128i chunk =
+            _mm_loadu_si128( reinterpret_cast< const __m128i * >( block + 16 * i ) );
+        const auto bits = []( int mask ) { return uint64_t( uint16_t( mask ) ); };
+        const int shift = 16 * i;
+        masks.op |= bits( _mm_cvtsi128_si32( _mm_cmpestrm( ops, 6, chunk, 16, setMatch ) ) )
+                    << shift;
+        masks.space |=
+            bits( _mm_cvtsi128_si32( _mm_cmpestrm( spaces, 4, chunk, 16, setMatch ) ) )
+            << shift;
+        masks.quote |= bits( _mm_movemask_epi8( _mm_cmpeq_epi8( chunk, quote ) ) ) << shift;
+        masks.backslash |= bits( _mm_movemask_epi8( _mm_cmpeq_epi8( chunk, backslash ) ) )
+                           << shift;
+    }
+    return masks;
+}
+
+__attribute__(( target( "avx2" ) )) inline uint64_t
+matchAvx2( __m256i chunk, char c ) {
+    return uint32_t(
+        _mm256_movemask_epi8( _mm256_cmpeq_epi8( chunk, _mm256_set1_epi8( c ) ) ) );
+}
+
+__attribute__(( target( "avx2" ) )) BlockMasks
+classifyAvx2( const char * block ) {
+    BlockMasks masks = {};
+    for( int i = 0; i < 2; ++i ) {
+        const __m256i chunk =
+            _mm256_loadu_si256( reinterpret_cast< const __m256i * >( block + 32 * i ) );
+        const int shift = 32 * i;
+        masks.quote |= matchAvx2( chunk, '"' ) << shift;
+        masks.backslash |= matchAvx2( chunk, '\\' ) << shift;
+        masks.op |= ( matchAvx2( chunk, '{' ) | matchAvx2( chunk, '}' ) |
+                      matchAvx2( chunk, '[' ) | matchAvx2( chunk, ']' ) |
+                      matchAvx2( chunk, ':' ) | matchAvx2( chunk, ',' ) )
+                    << shift;
+        masks.space |= ( matchAvx2( chunk, ' ' ) | matchAvx2( chunk, '\t' ) |
+                         matchAvx2( chunk, '\n' ) | matchAvx2( chunk, '\r' ) )
+                       << shift;
+    }
+    return masks;
+}
+
+#endif
+
+// Bit i of the result is the XOR of bits 0..i of `bits`: set from each opening
+// quote up to, but not including, the closing one.
+uint64_t
+prefixXor( uint64_t bits ) {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+template< BlockMasks ( *classify )( const char * ) >
+bool
+buildWith( std::string_view json, std::vector< uint32_t > & positions ) {
+    positions.clear();
+    positions.reserve( json.size() / 2 + 1 );
+
+    // State carried from one block into the next.
+    uint64_t escapedCarry = 0;
+    uint64_t inStringCarry = 0;
+    uint64_t scalarCarry = 0;
+
+    char padded[ blockSize ];
+    for( size_t base = 0; base < json.size(); base += blockSize ) {
+        const char * block = json.data() + base;
+        if( json.size() - base < blockSize ) {
+            std::memset( padded, ' ', blockSize );
+            std::memcpy( padded, block, json.size() - base );
+            block = padded;
+        }
+        const BlockMasks masks = classify( block );
+
+        // Bytes escaped by a backslash. Escapes are rare, so walking them one at
+        // a time is cheaper than doing it branch-free.
+        uint64_t escaped = escapedCarry;
+        escapedCarry = 0;
+        for( uint64_t backslash = masks.backslash; backslash;
+             backslash &= backslash - 1 ) {
+            const int i = __builtin_ctzll( backslash );
+            if( escaped >> i & 1 ) {
+                continue;
+            }
+            if( i == 63 ) {
+                escapedCarry = 1;
+            } else {
+                escaped |= uint64_t( 1 ) << ( i + 1 );
+            }
+        }
+
+        const uint64_t quotes = masks.quote & ~escaped;
+        const uint64_t inString = prefixXor( quotes ) ^ inStringCarry;
+        inStringCarry = uint64_t( int64_t( inString ) >> 63 );
+
+        const uint64_t scalar = ~( masks.op | masks.space | quotes | inString );
+        const uint64_t scalarStart = scalar & ~( ( scalar << 1 ) | scalarCarry );
+        scalarCarry = scalar >> 63;
+
+        for( uint64_t structural =
+                 ( masks.op & ~inString ) | ( quotes & inString ) | scalarStart;
+             structural; structural &= structural - 1 ) {
+            positions.push_back( uint32_t( base + __builtin_ctzll( structural ) ) );
+        }
+    }
+    positions.push_back( uint32_t( json.size() ) );
+    return !inStringCarry;
+}
+
+} // namespace
+
+std::string_view
+format_as( Isa isa ) {
+    switch( isa ) {
+    case Isa::scalar: return "scalar";
+    case Isa::sse42: return "sse4.2";
+    case Isa::avx2: return "avx2";
+    }
+    return "?";
+}
+
+bool
+supported( Isa isa ) {
+#ifdef FTL_STRUCTURAL_X86
+    __builtin_cpu_init();
+    switch( isa ) {
+    case Isa::scalar: return true;
+    case Isa::sse42: return __builtin_cpu_supports( "sse4.2" );
+    case Isa::avx2: return __builtin_cpu_supports( "avx2" );
+    }
+    return false;
+#else
+    return isa == Isa::scalar;
+#endif
+}
+
+Isa
+bestIsa() {
+    static const Isa best = supported( Isa::avx2 )  ? Isa::avx2 :
+                            supported( Isa::sse42 ) ? Isa::sse42 :
+                                                      Isa::scalar;
+    return best;
+}
+
+bool
+build( std::string_view json, std::vector< uint32_t > & positions, Isa isa ) {
+    switch( isa ) {
+#ifdef FTL_STRUCTURAL_X86
+    case Isa::avx2: return buildWith< classifyAvx2 >( json, positions );
+    case Isa::sse42: return buildWith< classifySse42 >( json, positions );
+#endif
+    default: return buildWith< classifyScalar >( json, positions );
+    }
+}
+
+} // namespace StructuralIndex
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// First pass of the structural parser (see StructuralParser.hpp): finds where
+// every token of a JSON text starts without looking at what the tokens hold. It
+// classifies 64 bytes at a time into bit masks, using the widest vector unit
+// the CPU has, and tracks which bytes are inside strings with plain 64-bit
+// arithmetic, so the only branches are per block rather than per byte.
+//
+// The index holds the offsets of `{ } [ ] : ,`, of opening quotes and of the
+// first byte of every other run of non-space bytes (numbers and literals), all
+// outside strings.
+namespace StructuralIndex {
+
+enum class Isa { scalar, sse42, avx2 };
+std::string_view format_as( Isa isa );
+
+// The fastest instruction set this CPU supports.
+Isa bestIsa();
+// Whether `isa` can run on this CPU.
+bool supported( Isa isa );
+
+// Fills `positions` with the index of `json`, followed by `json.size()` as a
+// sentinel. Returns false if the text ends inside a string. Texts must be
+// shorter than 4 GiB.
+bool build( std::string_view json, std::vector< uint32_t > & positions,
+            Isa isa = bestIsa() );
+
+} // namespace StructuralIndex
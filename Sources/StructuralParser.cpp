@@ -0,0 +1,602 @@
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "StateBuilder.hpp"
+#include "StructuralParser.hpp"
+
+namespace StructuralParser {
+
+namespace {
+
+bool
+isDigit( char c ) {
+    return c >= '0' && c <= '9';
+}
+
+// Whether a scalar token may end right before `c`.
+bool
+isDelimiter( char c ) {
+    switch( c ) {
+    case ' ':
+    case '\t':
+    case '\n':
+    case '\r':
+    case '{':
+    case '}':
+    case '[':
+    case ']':
+    case ':':
+    case ',':
+    case '"': return true;
+    default: return false;
+    }
+}
+
+// Checks `bytes` against the same UTF-8 ranges as nlohmann's lexer.
+bool
+validUtf8( std::string_view bytes ) {
+    const auto at = [ & ]( size_t i ) { return static_cast< unsigned char >( bytes[ i ] ); };
+    const auto inRange = [ & ]( size_t i, unsigned lo, unsigned hi ) {
+        return i < bytes.size() && at( i ) >= lo && at( i ) <= hi;
+    };
+    for( size_t i = 0; i < bytes.size(); ) {
+        const unsigned c = at( i );
+        if( c < 0x80 ) {
+            i += 1;
+        } else if( c >= 0xc2 && c <= 0xdf && inRange( i + 1, 0x80, 0xbf ) ) {
+            i += 2;
+        } else if( c >= 0xe0 && c <= 0xef ) {
+            const unsigned lo = c == 0xe0 ? 0xa0 : 0x80;
+            const unsigned hi = c == 0xed ? 0x9f : 0xbf;
+            if( !inRange( i + 1, lo, hi ) || !inRange( i + 2, 0x80, 0xbf ) ) {
+                return false;
+            }
+            i += 3;
+        } else if( c >= 0xf0 && c <= 0xf4 ) {
+            const unsigned lo = c == 0xf0 ? 0x90 : 0x80;
+            const unsigned hi = c == 0xf4 ? 0x8f : 0xbf;
+            if( !inRange( i + 1, lo, hi ) || !inRange( i + 2, 0x80, 0xbf ) ||
+                !inRange( i + 3, 0x80, 0xbf ) ) {
+                return false;
+            }
+            i += 4;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+void
+appendUtf8( std::string & out, uint32_t codePoint ) {
+    if( codePoint < 0x80 ) {
+        out += char( codePoint );
+    } else if( codePoint < 0x800 ) {
+        out += char( 0xc0 | codePoint >> 6 );
+        out += char( 0x80 | ( codePoint & 0x3f ) );
+    } else if( codePoint < 0x10000 ) {
+        out += char( 0xe0 | codePoint >> 12 );
+        out += char( 0x80 | ( codePoint >> 6 & 0x3f ) );
+        out += char( 0x80 | ( codePoint & 0x3f ) );
+    } else {
+        out += char( 0xf0 | codePoint >> 18 );
+        out += char( 0x80 | ( codePoint >> 12 & 0x3f ) );
+        out += char( 0x80 | ( codePoint >> 6 & 0x3f ) );
+        out += char( 0x80 | ( codePoint & 0x3f ) );
+    }
+}
+
+// Reads the four hex digits of a \u escape starting at `at`.
+bool
+hex4( std::string_view text, size_t at, uint32_t & value ) {
+    if( text.size() < at + 4 ) {
+        return false;
+    }
+    value = 0;
+    for( size_t i = at; i < at + 4; ++i ) {
+        const char c = text[ i ];
+        const int digit = isDigit( c )              ? c - '0' :
+                          ( c >= 'a' && c <= 'f' ) ? c - 'a' + 10 :
+                          ( c >= 'A' && c <= 'F' ) ? c - 'A' + 10 :
+                                                     -1;
+        if( digit < 0 ) {
+            return false;
+        }
+        value = value << 4 | uint32_t( digit );
+    }
+    return true;
+}
+
+// Decodes the escapes of a string body that is known to contain some.
+bool
+unescape( std::string_view body, std::string & out ) {
+    out.clear();
+    for( size_t i = 0; i < body.size(); ) {
+        const size_t backslash = body.find( '\\', i );
+        const std::string_view plain = body.substr( i, backslash - i );
+        if( !validUtf8( plain ) ) {
+            return false;
+        }
+        out += plain;
+        if( backslash == std::string_view::npos ) {
+            break;
+        }
+        i = backslash + 2;
+        switch( backslash + 1 < body.size() ? body[ backslash + 1 ] : '\0' ) {
+        case '"': out += '"'; break;
+        case '\\': out += '\\'; break;
+        case '/': out += '/'; break;
+        case 'b': out += '\b'; break;
+        case 'f': out += '\f'; break;
+        case 'n': out += '\n'; break;
+        case 'r': out += '\r'; break;
+        case 't': out += '\t'; break;
+        case 'u': {
+            uint32_t codePoint;
+            if( !hex4( body, i, codePoint ) ) {
+                return false;
+            }
+            i += 4;
+            if( codePoint >= 0xdc00 && codePoint <= 0xdfff ) {
+                return false;
+            }
+            if( codePoint >= 0xd800 && codePoint <= 0xdbff ) {
+                uint32_t low;
+                if( body.substr( i, 2 ) != "\\u" || !hex4( body, i + 2, low ) ||
+                    low < 0xdc00 || low > 0xdfff ) {
+                    return false;
+                }
+                i += 6;
+                codePoint = 0x10000 + ( ( codePoint - 0xd800 ) << 10 ) + ( low - 0xdc00 );
+            }
+            appendUtf8( out, codePoint );
+            break;
+        }
+        default: return false;
+        }
+    }
+    return true;
+}
+
+// Walks the index of one response, feeding states to a `StateBuilder`. Every
+// method starts at the current token and, on success, leaves the cursor on the
+// token after whatever it consumed.
+class Walker {
+public:
+    Walker( std::string_view json, const std::vector< uint32_t > & positions,
+            std::string & scratch, std::vector< char > & closers,
+            const OpenSky::StateFn & onState ):
+        _json( json ),
+        _positions( positions ),
+        _scratch( scratch ),
+        _closers( closers ),
+        _onState( onState ) {}
+
+    bool document( OpenSky::StatesHeader & header ) {
+        if( peek() == '{' ) {
+            if( !response( header ) ) {
+                return false;
+            }
+        } else if( !skipValue() ) {
+            return false;
+        }
+        // Nothing but the sentinel may follow.
+        return _token + 1 == _positions.size();
+    }
+
+private:
+    enum class Key { other, time, states };
+
+    size_t offset() const { return _positions[ _token ]; }
+    // The first byte of the current token, or NUL at the end of the text.
+    char peek() const { return offset() < _json.size() ? _json[ offset() ] : '\0'; }
+    bool expect( char c ) {
+        if( peek() != c || _token + 1 == _positions.size() ) {
+            return false;
+        }
+        ++_token;
+        return true;
+    }
+    bool tokenEndsAt( size_t end ) const {
+        return end == _json.size() || isDelimiter( _json[ end ] );
+    }
+
+    // The response object: depth 1 in the SAX handler's terms.
+    bool response( OpenSky::StatesHeader & header ) {
+        ++_token;
+        if( expect( '}' ) ) {
+            return true;
+        }
+        while( true ) {
+            Key key;
+            if( !objectKey( key ) ) {
+                return false;
+            }
+            const char c = peek();
+            if( key == Key::time && ( c == '-' || isDigit( c ) ) ) {
+                double time;
+                std::string_view text;
+                if( !number( time, text ) ) {
+                    return false;
+                }
+                if( isUnixTime( time ) ) {
+                    header.time = static_cast< int64_t >( time );
+                }
+            } else if( key == Key::states && c == '[' ) {
+                if( !states( header ) ) {
+                    return false;
+                }
+            } else if( !skipValue() ) {
+                return false;
+            }
+            if( expect( ',' ) ) {
+                continue;
+            }
+            return expect( '}' );
+        }
+    }
+
+    bool objectKey( Key & key ) {
+        std::string_view name;
+        if( peek() != '"' || !string( name ) ) {
+            return false;
+        }
+        key = name == "time"   ? Key::time :
+              name == "states" ? Key::states :
+                                 Key::other;
+        return expect( ':' );
+    }
+
+    bool states( OpenSky::StatesHeader & header ) {
+        ++_token;
+        if( expect( ']' ) ) {
+            return true;
+        }
+        while( true ) {
+            if( peek() == '[' ) {
+                if( !state( header ) ) {
+                    return false;
+                }
+            } else {
+                if( !skipValue() ) {
+                    return false;
+                }
+                header.stats.count( StateStatus::notArray );
+            }
+            if( expect( ',' ) ) {
+                continue;
+            }
+            return expect( ']' );
+        }
+    }
+
+    bool state( OpenSky::StatesHeader & header ) {
+        ++_token;
+        _builder.begin();
+        int field = 0;
+        if( peek() != ']' ) {
+            while( true ) {
+                if( !stateField( field ) ) {
+                    return false;
+                }
+                ++field;
+                if( expect( ',' ) ) {
+                    continue;
+                }
+                if( peek() == ']' ) {
+                    break;
+                }
+                return false;
+            }
+        }
+        if( !expect( ']' ) ) {
+            return false;
+        }
+        const StateStatus status = _builder.finish( field, _stateVector );
+        header.stats.count( status );
+        if( status == StateStatus::ok ) {
+            _onState( _stateVector );
+        }
+        return true;
+    }
+
+    bool stateField( int field ) {
+        switch( peek() ) {
+        case '"': {
+            std::string_view val;
+            if( !string( val ) ) {
+                return false;
+            }
+            _builder.string( field, val );
+            return true;
+        }
+        case '[':
+        case '{':
+            _builder.container( field, peek() == '[' );
+            return skipValue();
+        case 't':
+        case 'f': {
+            const bool val = peek() == 't';
+            if( !literal( val ? "true" : "false" ) ) {
+                return false;
+            }
+            _builder.boolean( field, val );
+            return true;
+        }
+        case 'n':
+            if( !literal( "null" ) ) {
+                return false;
+            }
+            _builder.null( field );
+            return true;
+        default: {
+            double val;
+            std::string_view text;
+            if( !number( val, text ) ) {
+                return false;
+            }
+            _builder.number( field, val, text );
+            return true;
+        }
+        }
+    }
+
+    // Any value, validated but not decoded. Iterative, so deep nesting can't
+    // overflow the stack.
+    bool skipValue() {
+        _closers.clear();
+        while( true ) {
+            const char c = peek();
+            if( c == '{' || c == '[' ) {
+                ++_token;
+                const char closer = c == '{' ? '}' : ']';
+                if( !expect( closer ) ) {
+                    _closers.push_back( closer );
+                    Key key;
+                    if( closer == '}' && !objectKey( key ) ) {
+                        return false;
+                    }
+                    continue;
+                }
+            } else if( !scalar() ) {
+                return false;
+            }
+
+            // After a value: close finished containers, or move to the next
+            // element of the innermost one.
+            while( true ) {
+                if( _closers.empty() ) {
+                    return true;
+                }
+                if( expect( ',' ) ) {
+                    Key key;
+                    if( _closers.back() == '}' && !objectKey( key ) ) {
+                        return false;
+                    }
+                    break;
+                }
+                if( !expect( _closers.back() ) ) {
+                    return false;
+                }
+                _closers.pop_back();
+            }
+        }
+    }
+
+    bool scalar() {
+        std::string_view text;
+        double val;
+        switch( peek() ) {
+        case '"': return string( text );
+        case 't': return literal( "true" );
+        case 'f': return literal( "false" );
+        case 'n': return literal( "null" );
+        default: return number( val, text );
+        }
+    }
+
+    bool literal( std::string_view word ) {
+        const size_t at = offset();
+        if( _json.substr( at, word.size() ) != word || !tokenEndsAt( at + word.size() ) ) {
+            return false;
+        }
+        ++_token;
+        return true;
+    }
+
+    // The string starting at the current quote. `val` points into the text, or
+    // into the scratch buffer if the string had escapes, until the next call.
+    bool string( std::string_view & val ) {
+        const size_t begin = offset() + 1;
+        bool escaped = false;
+        bool ascii = true;
+        size_t end = begin;
+        while( true ) {
+            if( end >= _json.size() ) {
+                return false;
+            }
+            const unsigned char c = _json[ end ];
+            if( c == '"' ) {
+                break;
+            }
+            if( c == '\\' ) {
+                escaped = true;
+                end += 2;
+                continue;
+            }
+            if( c < 0x20 ) {
+                return false;
+            }
+            ascii &= c < 0x80;
+            ++end;
+        }
+        const std::string_view body = _json.substr( begin, end - begin );
+        if( escaped ) {
+            if( !unescape( body, _scratch ) ) {
+                return false;
+            }
+            val = _scratch;
+        } else {
+            if( !ascii && !validUtf8( body ) ) {
+                return false;
+            }
+            val = body;
+        }
+        ++_token;
+        return true;
+    }
+
+    // A number, as a double rounded exactly like nlohmann rounds it. `text` is
+    // set to the token for numbers nlohmann reports as floats, and left empty for
+    // integers.
+    bool number( double & val, std::string_view & text ) {
+        const size_t begin = offset();
+        size_t i = begin;
+        const bool negative = i < _json.size() && _json[ i ] == '-';
+        i += negative;
+
+        // Grammar: -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+        // The first 19 significant digits go into `mantissa`, scaled by
+        // 10^`exponent`; any more set `truncated`.
+        uint64_t mantissa = 0;
+        int significantDigits = 0;
+        int exponent = 0;
+        bool truncated = false;
+        const auto digits = [ & ]( bool fraction ) {
+            const size_t first = i;
+            for( ; i < _json.size() && isDigit( _json[ i ] ); ++i ) {
+                if( significantDigits == 19 ) {
+                    truncated = true;
+                    exponent += !fraction;
+                    continue;
+                }
+                if( mantissa != 0 || _json[ i ] != '0' ) {
+                    mantissa = mantissa * 10 + uint64_t( _json[ i ] - '0' );
+                    ++significantDigits;
+                }
+                exponent -= fraction;
+            }
+            return i - first;
+        };
+        const size_t integerDigits = digits( false );
+        if( integerDigits == 0 || ( integerDigits > 1 && _json[ i - integerDigits ] == '0' ) ) {
+            return false;
+        }
+        bool isFloat = false;
+        if( i < _json.size() && _json[ i ] == '.' ) {
+            ++i;
+            isFloat = true;
+            if( digits( true ) == 0 ) {
+                return false;
+            }
+        }
+        if( i < _json.size() && ( _json[ i ] == 'e' || _json[ i ] == 'E' ) ) {
+            ++i;
+            isFloat = true;
+            const bool negativeExponent = i < _json.size() && _json[ i ] == '-';
+            i += i < _json.size() && ( _json[ i ] == '-' || _json[ i ] == '+' );
+            const size_t exponentBegin = i;
+            int explicitExponent = 0;
+            for( ; i < _json.size() && isDigit( _json[ i ] ); ++i ) {
+                explicitExponent = std::min( explicitExponent * 10 + ( _json[ i ] - '0' ),
+                                             100000 );
+            }
+            if( i == exponentBegin ) {
+                return false;
+            }
+            exponent += negativeExponent ? -explicitExponent : explicitExponent;
+        }
+        if( !tokenEndsAt( i ) ) {
+            return false;
+        }
+        const std::string_view token = _json.substr( begin, i - begin );
+
+        // nlohmann keeps integers that fit 64 bits as integers, so "-0" is a
+        // plain zero and no text is passed on.
+        if( !isFloat ) {
+            uint64_t magnitude = mantissa;
+            const bool fits =
+                truncated ? std::from_chars( token.data() + negative, token.end(), magnitude )
+                                    .ec == std::errc() :
+                            true;
+            if( fits && ( !negative || magnitude <= uint64_t( 1 ) << 63 ) ) {
+                val = negative && magnitude ? -static_cast< double >( magnitude ) :
+                                              static_cast< double >( magnitude );
+                text = {};
+                ++_token;
+                return true;
+            }
+        }
+        // Everything else goes through strtod in nlohmann.
+        if( !toDouble( token.substr( negative ), mantissa, exponent, truncated, val ) ) {
+            return false;
+        }
+        val = negative ? -val : val;
+        text = token;
+        ++_token;
+        return true;
+    }
+
+    // Exact when the mantissa and the power of ten are both exactly
+    // representable, since one correctly rounded multiply or divide then rounds
+    // like strtod does. Anything harder is handed to strtod itself.
+    static bool toDouble( std::string_view digits, uint64_t mantissa, int exponent,
+                          bool truncated, double & val ) {
+        static constexpr double powersOfTen[] = {
+            1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+        if( !truncated && mantissa <= uint64_t( 1 ) << 53 && exponent >= -22 &&
+            exponent <= 22 ) {
+            const double m = static_cast< double >( mantissa );
+            val = exponent < 0 ? m / powersOfTen[ -exponent ] : m * powersOfTen[ exponent ];
+            return true;
+        }
+        const std::string copy( digits );
+        val = std::strtod( copy.c_str(), nullptr );
+        // nlohmann rejects numbers too large for a double.
+        return std::isfinite( val );
+    }
+
+    std::string_view _json;
+    const std::vector< uint32_t > & _positions;
+    std::string & _scratch;
+    std::vector< char > & _closers;
+    const OpenSky::StateFn & _onState;
+
+    size_t _token = 0;
+    StateBuilder _builder;
+    StateVector _stateVector;
+};
+
+} // namespace
+
+std::optional< OpenSky::StatesHeader >
+streamStates( std::string_view json, const OpenSky::StateFn & onState,
+              StructuralIndex::Isa isa ) {
+    // Reused between calls, so a thread parsing a stream of snapshots stops
+    // allocating once the buffers have grown to fit.
+    thread_local std::vector< uint32_t > positions;
+    thread_local std::string scratch;
+    thread_local std::vector< char > closers;
+
+    // nlohmann skips a byte order mark.
+    if( json.substr( 0, 3 ) == "\xef\xbb\xbf" ) {
+        json.remove_prefix( 3 );
+    }
+    if( json.size() >= UINT32_MAX || !StructuralIndex::build( json, positions, isa ) ) {
+        return std::nullopt;
+    }
+    OpenSky::StatesHeader header;
+    Walker walker( json, positions, scratch, closers, onState );
+    if( !walker.document( header ) ) {
+        return std::nullopt;
+    }
+    return header;
+}
+
+} // namespace StructuralParser
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <optional>
+#include <string_view>
+
+#include "OpenSky.hpp"
+#include "StructuralIndex.hpp"
+
+// The `OpenSky::Backend::structural` parser. Walks the token index built by
+// StructuralIndex and decodes only what `StateBuilder` reads: keys, the time and
+// the fields of each state. Everything else is validated while it is skipped, so
+// it accepts and rejects the same texts as nlohmann and produces byte-identical
+// states.
+namespace StructuralParser {
+
+std::optional< OpenSky::StatesHeader >
+streamStates( std::string_view json, const OpenSky::StateFn & onState,
+              StructuralIndex::Isa isa = StructuralIndex::bestIsa() );
+
+} // namespace StructuralParser
@@ -0,0 +1,219 @@
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <doctest/doctest.h>
+
+#include "OpenSky.hpp"
+#include "StructuralParser.hpp"
+#include "Synthetic.hpp"
+
+namespace {
+
+using StructuralIndex::Isa;
+
+std::vector< Isa >
+supportedIsas() {
+    std::vector< Isa > isas;
+    for( const Isa isa : { Isa::scalar, Isa::sse42, Isa::avx2 } ) {
+        if( StructuralIndex::supported( isa ) ) {
+            isas.push_back( isa );
+        }
+    }
+    return isas;
+}
+
+std::string
+readFile( const char * path ) {
+    std::ifstream f( path );
+    std::stringstream ss;
+    ss << f.rdbuf();
+    return ss.str();
+}
+
+struct Parsed {
+    std::optional< OpenSky::StatesHeader > header;
+    std::vector< StateVector > states;
+};
+
+Parsed
+parseNlohmann( std::string_view json ) {
+    Parsed parsed;
+    parsed.header = OpenSky::streamStates(
+        json, [ & ]( const StateVector & sv ) { parsed.states.push_back( sv ); },
+        OpenSky::Backend::nlohmann );
+    return parsed;
+}
+
+Parsed
+parseStructural( std::string_view json, Isa isa ) {
+    Parsed parsed;
+    parsed.header = StructuralParser::streamStates(
+        json, [ & ]( const StateVector & sv ) { parsed.states.push_back( sv ); }, isa );
+    return parsed;
+}
+
+// Both parsers must agree on whether `json` is valid and, if it is, on every
+// byte of every state and on every count.
+void
+checkAgree( std::string_view json ) {
+    const Parsed expected = parseNlohmann( json );
+    for( const Isa isa : supportedIsas() ) {
+        CAPTURE( isa );
+        const Parsed actual = parseStructural( json, isa );
+        REQUIRE( bool( expected.header ) == bool( actual.header ) );
+        if( !expected.header ) {
+            continue;
+        }
+        CHECK( expected.header->time == actual.header->time );
+        CHECK( expected.header->stats.rows == actual.header->stats.rows );
+        REQUIRE( expected.states.size() == actual.states.size() );
+        for( size_t i = 0; i < expected.states.size(); ++i ) {
+            CAPTURE( i );
+            CHECK( std::memcmp( &expected.states[ i ], &actual.states[ i ],
+                                sizeof( StateVector ) ) == 0 );
+        }
+    }
+}
+
+std::string
+withState( std::string_view fields ) {
+    return std::string( R"({"time":1752437666,"states":[[)" ) + std::string( fields ) +
+           "]]}";
+}
+
+} // namespace
+
+TEST_CASE( "structural index is the same for every instruction set" ) {
+    std::mt19937 rng( 5 );
+    const std::string alphabet = "{}[]:,\" \t\n\\ab01-.e";
+    for( int round = 0; round < 200; ++round ) {
+        std::string text( rng() % 300, ' ' );
+        for( char & c : text ) {
+            c = alphabet[ rng() % alphabet.size() ];
+        }
+        CAPTURE( text );
+        std::vector< uint32_t > expected;
+        const bool expectedOk = StructuralIndex::build( text, expected, Isa::scalar );
+        for( const Isa isa : supportedIsas() ) {
+            CAPTURE( isa );
+            std::vector< uint32_t > actual;
+            CHECK( StructuralIndex::build( text, actual, isa ) == expectedOk );
+            if( expectedOk ) {
+                CHECK( actual == expected );
+            }
+        }
+    }
+
+    std::vector< uint32_t > positions;
+    REQUIRE( StructuralIndex::build( R"( {"a\"b":[1,true]} )", positions, Isa::scalar ) );
+    CHECK( positions == std::vector< uint32_t >{ 1, 2, 8, 9, 10, 11, 12, 16, 17, 19 } );
+    CHECK( !StructuralIndex::build( R"({"a\"})", positions, Isa::scalar ) );
+}
+
+TEST_CASE( "structural parser matches nlohmann" ) {
+    SUBCASE( "sample data" ) {
+        const std::string json = readFile( FTL_SAMPLE_DATA );
+        REQUIRE( !json.empty() );
+        checkAgree( json );
+    }
+    SUBCASE( "synthetic" ) {
+        checkAgree( Synthetic::statesJson( 3000, 11 ) );
+        checkAgree( Synthetic::statesJson( 3000, 12, 1752437666, 0.05 ) );
+    }
+    SUBCASE( "field values" ) {
+        const char * const fields[] = {
+            R"("a39155","N329SF  ","US",1,2,-71.2118,42.4658,1,false,1,1,1,null,1,"1303",false,0)",
+            R"("a39155","N329SF  ","US",1,2,-0,-0.0,-0e5,false,1E2,1e-2,0.1e+1,[],0,"7700",true,3)",
+            R"("a39155","Éé😀","US",1,2,1,1,1,false,1,1,1,{"a":[{}]},1,"0",false,0)",
+            R"("a39155","ÉTÉ ☃","\"\\\/\b\f\n\r\t",1,2,1,1,1,false,1,1,1,[1,[2,[3]]],1,"1",false,0)",
+            R"("a39155","A",null,1,2,12.345678500000000000001,0.00000049999999999999999,1,false,1,1,1,null,1,"1",false,0)",
+            R"("a39155","A",null,1e0,2.0,1,1,123456789012345678901234,false,1,1,1,null,1,"1",false,0)",
+            R"("a39155","A",null,1,18446744073709551615,1,1,1,false,1,1,1,null,1,"1",false,0)",
+            R"("a39155","A",null,-9223372036854775808,-9223372036854775809,1,1,1e-400,false,1,1,1,null,1,"1",false,0)",
+            R"("a39155","A",null,1,2,1,1,1,false,1,1,1,null,1,"1",false,0,"extra",[])",
+            R"("a39155","A",null,1,2,180.0000001,1,1,false,1,1,1,null,1,"1",false,0)",
+        };
+        for( const char * f : fields ) {
+            CAPTURE( f );
+            checkAgree( withState( f ) );
+        }
+    }
+    SUBCASE( "document shapes" ) {
+        const char * const documents[] = {
+            "\xef\xbb\xbf{\"time\":1,\"states\":[]}",
+            R"( { "states" : null , "time" : 2.5 } )",
+            R"({"time":"1","states":[1,"a",{},[],[[]],true]})",
+            R"({"other":{"states":[["a39155"]]},"states":[],"time":[3]})",
+            R"({"states":[],"states":[]})",
+            R"([{"time":1}])",
+            R"("just a string")",
+            "{}",
+            "[]",
+            "0",
+        };
+        for( const char * d : documents ) {
+            CAPTURE( d );
+            checkAgree( d );
+        }
+    }
+    SUBCASE( "malformed documents" ) {
+        const char * const documents[] = {
+            "",
+            " ",
+            R"({"time":1,"states":[]} x)",
+            R"({"time":1,"states":[]}{})",
+            R"({"time":1,"states":[],})",
+            R"({"time":1,"states":[,]})",
+            R"({"time":1 "states":[]})",
+            R"({"time":1,"states":[[1,2,]]})",
+            R"({"time":1,"states":[[1 2]]})",
+            R"({"time":1,"states":[["a" "b"]]})",
+            R"({"time":1,"states":[[{"a":1,}]]})",
+            R"({"time":1,"states":[[{"a"}]]})",
+            R"({"time":1,"states":[[{1:2}]]})",
+            R"({"time":1,"states":[[[1,[2,[3]]]]})",
+            R"({"time":1e400,"states":[]})",
+            R"({"time":-,"states":[]})",
+            R"({"time":01,"states":[]})",
+            R"({"time":1.,"states":[]})",
+            R"({"time":.5,"states":[]})",
+            R"({"time":1e,"states":[]})",
+            R"({"time":+1,"states":[]})",
+            R"({"time":12a,"states":[]})",
+            R"({"time":0x10,"states":[]})",
+            R"({"time":tru,"states":[]})",
+            R"({"time":truex,"states":[]})",
+            R"({"time":NaN,"states":[]})",
+            R"({"time":1,"states":[["\x"]]})",
+            R"({"time":1,"states":[["\u12"]]})",
+            R"({"time":1,"states":[["\ud83d"]]})",
+            R"({"time":1,"states":[["\ude00"]]})",
+            R"({"time":1,"states":[["\ud83dA"]]})",
+            "{\"time\":1,\"states\":[[\"a\tb\"]]}",
+            "{\"time\":1,\"states\":[[\"\xff\"]]}",
+            "{\"time\":1,\"states\":[[\"\xc3\"]]}",
+            "{\"time\":1,\"states\":[[\"\xed\xa0\x80\"]]}",
+            "{\"time\":1,\"states\":[[\"\xf4\x90\x80\x80\"]]}",
+            "{\"time\":1,\"states\":[[\"a\\\"]]}",
+            "{\"time\":1,\x0b\"states\":[]}",
+            R"({"time":1,"states":[[)",
+        };
+        for( const char * d : documents ) {
+            CAPTURE( d );
+            checkAgree( d );
+        }
+    }
+}
+
+TEST_CASE( "structural parser reports malformed rows like nlohmann" ) {
+    const std::string json = Synthetic::statesJson( 500, 3, 1752437666, 0.2 );
+    const auto header = StructuralParser::streamStates( json, []( const StateVector & ) {} );
+    REQUIRE( header );
+    CHECK( header->stats.quarantined() > 0 );
+    CHECK( header->stats.accepted() + header->stats.quarantined() == 500 );
+    checkAgree( json );
+}
@@ -0,0 +1,142 @@
+#include <cmath>
+
+#include <fmt/format.h>
+
+#include "Synthetic.hpp"
+
+namespace Synthetic {
+
+namespace {
+
+void
+appendState( fmt::memory_buffer & out, XorShift & rng, int64_t time ) {
+    static const char * airlines[] = { "JBU", "DAL", "AAL", "UAL", "BAW", "ENY",
+                                       "SWA", "DLH", "AFR", "KLM", "RYR", "EZY" };
+    static const char * countries[] = { "United States", "United Kingdom",
+                                        "Germany", "France", "Ireland" };
+    auto it = std::back_inserter( out );
+
+    fmt::format_to( it, "[\"{:06x}\",", rng.next() & 0xffffff );
+    if( rng.chance( 0.01 ) ) {
+        fmt::format_to( it, "null," );
+    } else if( rng.chance( 0.05 ) ) {
+        fmt::format_to( it, "\"\"," );
+    } else {
+        fmt::format_to( it, "\"{:<8}\",",
+                        fmt::format( "{}{}", airlines[ rng.next() % 12 ],
+                                     rng.next() % 10000 ) );
+    }
+    const int64_t lastContact = time - rng.next() % 10;
+    fmt::format_to( it, "\"{}\",{},{},", countries[ rng.next() % 5 ],
+                    lastContact - rng.next() % 5, lastContact );
+    if( rng.chance( 0.01 ) ) {
+        fmt::format_to( it, "null,null," );
+    } else {
+        fmt::format_to( it, "{:.4f},{:.4f},", rng.uniform( -180, 180 ),
+                        rng.uniform( -85, 85 ) );
+    }
+    const bool onGround = rng.chance( 0.1 );
+    if( onGround ) {
+        fmt::format_to( it, "null,true,{:.2f},{:.2f},null,null,null,",
+                        rng.uniform( 0, 15 ), rng.uniform( 0, 360 ) );
+    } else {
+        fmt::format_to( it, "{:.2f},false,{:.2f},{:.2f},{:.2f},null,{:.2f},",
+                        rng.uniform( 0, 12000 ), rng.uniform( 50, 280 ),
+                        rng.uniform( 0, 360 ), rng.uniform( -15, 15 ),
+                        rng.uniform( 0, 12000 ) );
+    }
+    if( rng.chance( 0.7 ) ) {
+        fmt::format_to( it, "null,false,0]" );
+    } else {
+        fmt::format_to( it, "\"{:04o}\",false,0]", rng.next() % 010000 );
+    }
+}
+
+void
+appendMalformedState( fmt::memory_buffer & out, XorShift & rng ) {
+    static const char * rows[] = {
+        R"({"icao24":"a00001"})",
+        R"(["a00002","TRUNC1  ","United States",1752437600])",
+        R"(["xyz","BAD1    ","United States",1,1,0,0,null,false,null,null,null,null,null,null,false,0])",
+        R"(["a00003",42,"United States",1,1,0,0,null,false,null,null,null,null,null,null,false,0])",
+        R"(["a00004","FAR1    ","United States",1,1,500.5,0,null,false,null,null,null,null,null,null,false,0])",
+    };
+    fmt::format_to( std::back_inserter( out ), "{}", rows[ rng.next() % 5 ] );
+}
+
+} // namespace
+
+std::string
+statesJson( size_t stateCount, uint32_t seed, int64_t time, double malformedRate ) {
+    XorShift rng( seed );
+    fmt::memory_buffer out;
+    fmt::format_to( std::back_inserter( out ), "{{\"time\":{},\"states\":[", time );
+    for( size_t i = 0; i < stateCount; ++i ) {
+        if( i ) {
+            out.push_back( ',' );
+        }
+        // Checking the rate first keeps clean output independent of it.
+        if( malformedRate > 0 && rng.chance( malformedRate ) ) {
+            appendMalformedState( out, rng );
+        } else {
+            appendState( out, rng, time );
+        }
+    }
+    fmt::format_to( std::back_inserter( out ), "]}}" );
+    return fmt::to_string( out );
+}
+
+std::vector< StateVector >
+flightPath( size_t sampleCount, uint32_t seed, bool turns, uint32_t interval ) {
+    constexpr double speed = 230;
+    constexpr double turnRate = 3;
+    constexpr double noise = 3;
+
+    XorShift rng( seed );
+    double longitude = -71.0;
+    double latitude = 42.36;
+    double track = rng.uniform( 0, 360 );
+    // Seconds left in the current leg or turn, and the turn's direction.
+    double legLeft = rng.uniform( 60, 400 );
+    double turnLeft = 0;
+    double turnSign = 1;
+
+    std::vector< StateVector > path;
+    path.reserve( sampleCount );
+    uint32_t time = 1752437666;
+    for( size_t i = 0; i < sampleCount; ++i ) {
+        StateVector stateVector;
+        stateVector.icao24 = 0xa00000 + seed;
+        stateVector.lastContact = time;
+        stateVector.positionAgeIs( 0 );
+        stateVector.longitudeE6 =
+            toMicroDegrees( longitude + rng.uniform( -noise, noise ) / metersPerDegree /
+                                            std::cos( toRadians( latitude ) ) );
+        stateVector.latitudeE6 =
+            toMicroDegrees( latitude + rng.uniform( -noise, noise ) / metersPerDegree );
+        stateVector.baroAltitude = 10668;
+        stateVector.velocity = speed;
+        stateVector.trueTrack = static_cast< float >( track );
+        path.push_back( stateVector );
+
+        // Advance a second at a time so turns come out as arcs.
+        for( uint32_t second = 0; second < interval; ++second ) {
+            if( turnLeft > 0 ) {
+                track = std::fmod( track + turnSign * turnRate + 360, 360 );
+                turnLeft -= 1;
+            } else if( ( legLeft -= 1 ) <= 0 && turns ) {
+                turnLeft = rng.uniform( 10, 60 );
+                turnSign = rng.chance( 0.5 ) ? 1 : -1;
+                legLeft = rng.uniform( 60, 400 );
+            }
+            const double heading = toRadians( track );
+            latitude += speed * std::cos( heading ) / metersPerDegree;
+            longitude += speed * std::sin( heading ) / metersPerDegree /
+                         std::cos( toRadians( latitude ) );
+        }
+        time += interval;
+    }
+    return path;
+}
+
+} // namespace Synthetic
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "FlightData.hpp"
+
+// Deterministic OpenSky-shaped data for benchmarks and tests.
+namespace Synthetic {
+
+// Small, fast PRNG so generated snapshots are identical on every platform.
+class XorShift {
+public:
+    explicit XorShift( uint32_t seed ): _state( seed ? seed : 0x9e3779b9 ) {}
+
+    uint32_t next() {
+        _state ^= _state << 13;
+        _state ^= _state >> 17;
+        _state ^= _state << 5;
+        return _state;
+    }
+    // Uniform in [lo, hi).
+    double uniform( double lo, double hi ) {
+        return lo + ( hi - lo ) * ( next() / 4294967296.0 );
+    }
+    // True with probability `p`.
+    bool chance( double p ) { return uniform( 0, 1 ) < p; }
+
+private:
+    uint32_t _state;
+};
+
+// A /states/all response body with `stateCount` aircraft spread over the globe,
+// including the empty callsigns and null fields real responses contain. A
+// `malformedRate` share of the rows is replaced by rows the parser must
+// quarantine, one kind of defect each.
+std::string statesJson( size_t stateCount, uint32_t seed = 1,
+                        int64_t time = 1752437666, double malformedRate = 0 );
+
+// One airliner's reports, `interval` seconds apart, starting near Logan at 230
+// m/s: straight legs of a few minutes joined by standard-rate (3 deg/s) turns,
+// unless `turns` is false, with a few meters of position noise. Each state has
+// its position, track, velocity, altitude and last contact set.
+std::vector< StateVector > flightPath( size_t sampleCount, uint32_t seed = 1,
+                                       bool turns = true, uint32_t interval = 5 );
+
+} // namespace Synthetic
@@ -0,0 +1,55 @@
+#include "TieredHistory.hpp"
+
+TieredHistory::TieredHistory( const Limits & limits ) {
+    for( size_t index = 0; index < tierCount; ++index ) {
+        _tiers[ index ].limitsIs( limits[ index ] );
+    }
+}
+
+void
+TieredHistory::append( FlightSlot slot, const StateVector & stateVector ) {
+    for( TrackHistory & tier : _tiers ) {
+        tier.append( slot, stateVector );
+    }
+}
+
+void
+TieredHistory::append( FlightSlot slot, const TrackSample & sample ) {
+    for( TrackHistory & tier : _tiers ) {
+        tier.append( slot, sample );
+    }
+}
+
+void
+TieredHistory::erase( FlightSlot slot ) {
+    for( TrackHistory & tier : _tiers ) {
+        tier.erase( slot );
+    }
+}
+
+void
+TieredHistory::clear() {
+    for( TrackHistory & tier : _tiers ) {
+        tier.clear();
+    }
+}
+
+size_t
+TieredHistory::memoryBytes() const {
+    size_t bytes = 0;
+    for( const TrackHistory & tier : _tiers ) {
+        bytes += tier.memoryBytes();
+    }
+    return bytes;
+}
+
+size_t
+TieredHistory::tierFor( double metersPerPixel ) const {
+    const double maxSpacing = maxSamplePixels * metersPerPixel;
+    for( size_t index = tierCount; index-- > 1; ) {
+        if( _tiers[ index ].limits().interval * nominalSpeed <= maxSpacing ) {
+            return index;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+#include "TrackHistory.hpp"
+
+// Track history at three resolutions, for trails from the last few minutes up to
+// a whole day. Every sample is offered to every tier, and each tier keeps at
+// most one per its `interval`, so the coarser tiers roll the track up as it
+// comes in rather than in a later pass. Each tier has its own fixed slab and
+// per-track ring, so memory stays flat however long the history runs: the fine
+// tier holds minutes, the coarse one hours.
+//
+// Queries take the drawing scale and read the coarsest tier whose sample spacing
+// still looks continuous at it, falling back to coarser tiers for whatever is
+// older than the chosen one holds.
+class TieredHistory {
+public:
+    static constexpr size_t tierCount = 3;
+    using Limits = std::array< TrackHistory::Limits, tierCount >;
+    // 1 s for about 5 minutes, 10 s for about an hour, 60 s for a day, with
+    // tolerances that stay under a pixel at the scales each tier is drawn at.
+    static constexpr Limits defaultLimits = { {
+        // maxSamples, samplesPerTrack, tolerance, interval
+        { size_t( 1 ) << 18, 300, 30, 1 },
+        { size_t( 1 ) << 18, 360, 100, 10 },
+        { size_t( 1 ) << 19, 1440, 300, 60 },
+    } };
+    // Speed assumed when turning a tier's interval into spacing on the ground.
+    static constexpr double nominalSpeed = 250;
+    // Samples this many pixels apart still read as a smooth line.
+    static constexpr double maxSamplePixels = 4;
+
+    TieredHistory(): TieredHistory( defaultLimits ) {}
+    explicit TieredHistory( const Limits & limits );
+
+    void append( FlightSlot slot, const StateVector & stateVector );
+    void append( FlightSlot slot, const TrackSample & sample );
+    void erase( FlightSlot slot );
+    void clear();
+
+    const TrackHistory & tier( size_t index ) const { return _tiers[ index ]; }
+    size_t memoryBytes() const;
+
+    // The coarsest tier whose samples are at most `maxSamplePixels` apart when
+    // drawn at `metersPerPixel`.
+    size_t tierFor( double metersPerPixel ) const;
+
+    // Calls `fn( const TrackSample & )` for the samples of `slot` fixed at or after
+    // `since`, oldest first, read from `tierFor( metersPerPixel )` and, before the
+    // oldest sample it holds, from coarser tiers.
+    template< typename Fn >
+    void forEachSince( FlightSlot slot, uint32_t since, double metersPerPixel,
+                       Fn && fn ) const {
+        const size_t finest = tierFor( metersPerPixel );
+        // Each tier covers up to where the finer ones it stands in for begin.
+        std::array< uint32_t, tierCount > until;
+        uint32_t covered = UINT32_MAX;
+        for( size_t index = finest; index < tierCount; ++index ) {
+            until[ index ] = covered;
+            if( _tiers[ index ].size( slot ) > 0 ) {
+                covered = std::min( covered, _tiers[ index ].front( slot ).time );
+            }
+        }
+        for( size_t index = tierCount; index-- > finest; ) {
+            if( since < until[ index ] ) {
+                _tiers[ index ].forEachBetween( slot, since, until[ index ], fn );
+            }
+        }
+    }
+
+private:
+    std::array< TrackHistory, tierCount > _tiers;
+};
@@ -0,0 +1,108 @@
+#include <vector>
+
+#include <doctest/doctest.h>
+
+#include "TieredHistory.hpp"
+
+namespace {
+
+// Small rings and no simplification, so each tier's contents are predictable.
+const TieredHistory::Limits testLimits = { {
+    // maxSamples, samplesPerTrack, tolerance, interval
+    { 1024, 32, 0, 1 },
+    { 1024, 32, 0, 10 },
+    { 1024, 256, 0, 60 },
+} };
+
+TrackSample
+sampleAt( uint32_t time ) {
+    return { time, int32_t( time ), 0, 0 };
+}
+
+std::vector< uint32_t >
+times( const TieredHistory & history, uint32_t since, double metersPerPixel ) {
+    std::vector< uint32_t > result;
+    history.forEachSince( 0, since, metersPerPixel, [ & ]( const TrackSample & sample ) {
+        result.push_back( sample.time );
+    } );
+    return result;
+}
+
+} // namespace
+
+TEST_CASE( "tiered history rolls samples up as they arrive" ) {
+    TieredHistory history( testLimits );
+    for( uint32_t t = 0; t < 3600; ++t ) {
+        history.append( 0, sampleAt( t ) );
+    }
+
+    // Each tier keeps the first sample of every interval, up to its ring of
+    // 16-sample chunks.
+    CHECK( history.tier( 0 ).front( 0 ).time == 3600 - 32 );
+    CHECK( history.tier( 1 ).size( 0 ) == 24 );
+    CHECK( history.tier( 1 ).front( 0 ).time == 3360 );
+    CHECK( history.tier( 1 ).back( 0 ).time == 3590 );
+    CHECK( history.tier( 2 ).front( 0 ).time == 0 );
+    CHECK( history.tier( 2 ).back( 0 ).time == 3540 );
+    CHECK( history.tier( 2 ).size( 0 ) == 60 );
+
+    SUBCASE( "erasing drops every tier" ) {
+        history.erase( 0 );
+        for( size_t tier = 0; tier < TieredHistory::tierCount; ++tier ) {
+            CHECK( history.tier( tier ).size( 0 ) == 0 );
+        }
+    }
+}
+
+TEST_CASE( "tiered history reads the coarsest tier dense enough for the scale" ) {
+    TieredHistory history( testLimits );
+    // A street map, a city and a continent.
+    CHECK( history.tierFor( 2 ) == 0 );
+    CHECK( history.tierFor( 700 ) == 1 );
+    CHECK( history.tierFor( 5000 ) == 2 );
+
+    for( uint32_t t = 0; t < 3600; ++t ) {
+        history.append( 0, sampleAt( t ) );
+    }
+
+    SUBCASE( "fine scale stitches older tiers in before the fine one" ) {
+        const std::vector< uint32_t > all = times( history, 0, 2 );
+        REQUIRE( !all.empty() );
+        CHECK( all.front() == 0 );
+        CHECK( all.back() == 3599 );
+        for( size_t i = 1; i < all.size(); ++i ) {
+            CHECK( all[ i - 1 ] < all[ i ] );
+        }
+        // 60 s up to the 10 s tier, 10 s up to the 1 s tier, then every second.
+        CHECK( all.size() == 56 + 21 + 32 );
+        CHECK( all[ 55 ] == 3300 );
+        CHECK( all[ 56 ] == 3360 );
+        CHECK( all[ 77 ] == 3568 );
+    }
+    SUBCASE( "recent window at fine scale stays in the fine tier" ) {
+        const std::vector< uint32_t > recent = times( history, 3590, 2 );
+        CHECK( recent.size() == 11 );
+        CHECK( recent.front() == 3589 );
+    }
+    SUBCASE( "coarse scale skips the finer tiers" ) {
+        const std::vector< uint32_t > coarse = times( history, 0, 5000 );
+        CHECK( coarse.size() == 60 );
+        CHECK( coarse.back() == 3540 );
+    }
+}
+
+TEST_CASE( "tiered history memory stays flat" ) {
+    TieredHistory history;
+    const auto run = [ & ]( uint32_t from, uint32_t to ) {
+        for( uint32_t t = from; t < to; t += 5 ) {
+            for( FlightSlot slot = 0; slot < 200; ++slot ) {
+                history.append( slot, TrackSample{ t, int32_t( t * 7 + slot * 1000 ),
+                                                   int32_t( ( t * t ) % 100000 ), 0 } );
+            }
+        }
+    };
+    run( 0, 3600 );
+    const size_t afterHour = history.memoryBytes();
+    run( 3600, 6 * 3600 );
+    CHECK( history.memoryBytes() == afterHour );
+}
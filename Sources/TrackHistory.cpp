@@ -0,0 +1,248 @@
+#include <algorithm>
+#include <cmath>
+
+#include "TrackHistory.hpp"
+
+void
+TrackHistory::limitsIs( const Limits & limits ) {
+    _limits = limits;
+    const size_t chunkCount =
+        std::max< size_t >( 1, limits.maxSamples / samplesPerChunk );
+    _chunksPerTrack = static_cast< uint32_t >( std::max< size_t >(
+        1, ( limits.samplesPerTrack + samplesPerChunk - 1 ) / samplesPerChunk ) );
+    _samples.assign( chunkCount * samplesPerChunk, {} );
+    _chunks.assign( chunkCount, {} );
+    _tracks.clear();
+    clear();
+}
+
+void
+TrackHistory::clear() {
+    for( uint32_t chunk = 0; chunk < _chunks.size(); ++chunk ) {
+        _chunks[ chunk ] = {};
+        _chunks[ chunk ].next = chunk + 1 < _chunks.size() ? chunk + 1 : noChunk;
+    }
+    _freeHead = _chunks.empty() ? noChunk : 0;
+    std::fill( _tracks.begin(), _tracks.end(), Track{} );
+    _oldest = noChunk;
+    _newest = noChunk;
+    _totalSize = 0;
+    _compression = {};
+}
+
+void
+TrackHistory::append( FlightSlot slot, const StateVector & stateVector ) {
+    if( !stateVector.hasPosition() ) {
+        return;
+    }
+    const int64_t fixed = int64_t( stateVector.lastContact ) - stateVector.positionAge();
+    append( slot, TrackSample{ static_cast< uint32_t >( std::max< int64_t >( fixed, 0 ) ),
+                               stateVector.longitudeE6, stateVector.latitudeE6,
+                               stateVector.baroAltitude } );
+}
+
+void
+TrackHistory::append( FlightSlot slot, const TrackSample & sample ) {
+    if( slot >= _tracks.size() ) {
+        _tracks.resize( slot + 1 );
+    }
+    Track & track = _tracks[ slot ];
+    const uint32_t interval = std::max( _limits.interval, 1u );
+    if( track.size > 0 && sample.time / interval <= back( slot ).time / interval ) {
+        return;
+    }
+    ++_compression.samples;
+
+    if( track.merging && track.size > 0 && extendsSegment( track, sample ) ) {
+        const uint32_t tail = track.tail;
+        _samples[ tail * samplesPerChunk + _chunks[ tail ].count - 1 ] = sample;
+        narrowCone( track, sample );
+        return;
+    }
+
+    const bool first = track.size == 0;
+    restartSegment( track, first ? sample : back( slot ) );
+    push( slot, sample );
+    ++_compression.points;
+    if( !first && _limits.tolerance > 0 ) {
+        track.merging = true;
+        narrowCone( track, sample );
+    }
+}
+
+void
+TrackHistory::push( FlightSlot slot, const TrackSample & sample ) {
+    uint32_t tail = _tracks[ slot ].tail;
+    if( tail == noChunk || _chunks[ tail ].count == samplesPerChunk ) {
+        // A full ring reuses its own oldest chunk; anything else needs a new one.
+        tail = _tracks[ slot ].chunkCount == _chunksPerTrack ? popHead( slot ) :
+                                                                acquireChunk();
+        pushTail( slot, tail );
+    }
+    Chunk & chunk = _chunks[ tail ];
+    _samples[ tail * samplesPerChunk + chunk.count ] = sample;
+    ++chunk.count;
+    ++_tracks[ slot ].size;
+    ++_totalSize;
+}
+
+namespace {
+
+// Distance and direction from `longitudeE6`, `latitudeE6` to `sample`, on a
+// plane tangent at the former. Fine at the scale of one segment.
+void
+offsetTo( int32_t longitudeE6, int32_t latitudeE6, const TrackSample & sample,
+          double & distance, double & angle ) {
+    const double latitude = toRadians( fromMicroDegrees( latitudeE6 ) );
+    const double x =
+        double( sample.longitudeE6 - longitudeE6 ) * metersPerMicroDegree * std::cos( latitude );
+    const double y = double( sample.latitudeE6 - latitudeE6 ) * metersPerMicroDegree;
+    distance = std::hypot( x, y );
+    angle = std::atan2( y, x );
+}
+
+// `angle` - `reference`, wrapped into [-pi, pi].
+double
+relativeAngle( double angle, double reference ) {
+    double relative = angle - reference;
+    if( relative > pi ) {
+        relative -= 2 * pi;
+    } else if( relative < -pi ) {
+        relative += 2 * pi;
+    }
+    return relative;
+}
+
+} // namespace
+
+void
+TrackHistory::restartSegment( Track & track, const TrackSample & anchor ) {
+    track.anchorLongitudeE6 = anchor.longitudeE6;
+    track.anchorLatitudeE6 = anchor.latitudeE6;
+    track.coneSet = false;
+    track.reach = 0;
+    track.merging = false;
+}
+
+bool
+TrackHistory::extendsSegment( const Track & track, const TrackSample & sample ) const {
+    double distance;
+    double angle;
+    offsetTo( track.anchorLongitudeE6, track.anchorLatitudeE6, sample, distance, angle );
+    // Samples no farther out than the new end project onto the segment rather than
+    // past it, so their distance to the segment is their distance to the line.
+    if( distance < track.reach ) {
+        return false;
+    }
+    if( !track.coneSet ) {
+        return true;
+    }
+    const double relative = relativeAngle( angle, track.coneReference );
+    return relative >= track.coneLow && relative <= track.coneHigh;
+}
+
+void
+TrackHistory::narrowCone( Track & track, const TrackSample & sample ) const {
+    double distance;
+    double angle;
+    offsetTo( track.anchorLongitudeE6, track.anchorLatitudeE6, sample, distance, angle );
+    track.reach = std::max( track.reach, float( distance ) );
+    if( distance <= _limits.tolerance ) {
+        // Any line through the anchor passes close enough.
+        return;
+    }
+    const double halfWidth = std::asin( _limits.tolerance / distance );
+    if( !track.coneSet ) {
+        track.coneSet = true;
+        track.coneReference = float( angle );
+        track.coneLow = float( -halfWidth );
+        track.coneHigh = float( halfWidth );
+        return;
+    }
+    const double relative = relativeAngle( angle, track.coneReference );
+    track.coneLow = std::max( track.coneLow, float( relative - halfWidth ) );
+    track.coneHigh = std::min( track.coneHigh, float( relative + halfWidth ) );
+}
+
+void
+TrackHistory::erase( FlightSlot slot ) {
+    if( slot >= _tracks.size() ) {
+        return;
+    }
+    while( _tracks[ slot ].head != noChunk ) {
+        const uint32_t chunk = popHead( slot );
+        _chunks[ chunk ].next = _freeHead;
+        _freeHead = chunk;
+    }
+}
+
+uint32_t
+TrackHistory::acquireChunk() {
+    if( _freeHead != noChunk ) {
+        const uint32_t chunk = _freeHead;
+        _freeHead = _chunks[ chunk ].next;
+        return chunk;
+    }
+    // Chunks enter the age list as they start filling, and a track's chunks fill
+    // in order, so the oldest chunk overall is always the head of its track.
+    assert( _oldest != noChunk );
+    assert( _tracks[ _chunks[ _oldest ].owner ].head == _oldest );
+    return popHead( _chunks[ _oldest ].owner );
+}
+
+uint32_t
+TrackHistory::popHead( FlightSlot slot ) {
+    Track & track = _tracks[ slot ];
+    const uint32_t chunk = track.head;
+    assert( chunk != noChunk );
+    track.head = _chunks[ chunk ].next;
+    if( track.head == noChunk ) {
+        track.tail = noChunk;
+    }
+    --track.chunkCount;
+    track.size -= _chunks[ chunk ].count;
+    _totalSize -= _chunks[ chunk ].count;
+    unlinkAge( chunk );
+    _chunks[ chunk ] = {};
+    return chunk;
+}
+
+void
+TrackHistory::pushTail( FlightSlot slot, uint32_t chunk ) {
+    Track & track = _tracks[ slot ];
+    Chunk & c = _chunks[ chunk ];
+    c.owner = slot;
+    c.next = noChunk;
+    c.count = 0;
+    if( track.tail == noChunk ) {
+        track.head = chunk;
+    } else {
+        _chunks[ track.tail ].next = chunk;
+    }
+    track.tail = chunk;
+    ++track.chunkCount;
+
+    c.older = _newest;
+    c.newer = noChunk;
+    if( _newest == noChunk ) {
+        _oldest = chunk;
+    } else {
+        _chunks[ _newest ].newer = chunk;
+    }
+    _newest = chunk;
+}
+
+void
+TrackHistory::unlinkAge( uint32_t chunk ) {
+    Chunk & c = _chunks[ chunk ];
+    if( c.older == noChunk ) {
+        _oldest = c.newer;
+    } else {
+        _chunks[ c.older ].newer = c.newer;
+    }
+    if( c.newer == noChunk ) {
+        _newest = c.older;
+    } else {
+        _chunks[ c.newer ].older = c.older;
+    }
+}
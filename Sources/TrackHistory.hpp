@@ -0,0 +1,206 @@
+#pragma once
+
+#include <assert.h>
+#include <cstdint>
+#include <vector>
+
+#include "FlightStore.hpp"
+
+// One point of an aircraft's track.
+struct TrackSample {
+    // Unix time the position was fixed.
+    uint32_t time;
+    int32_t longitudeE6;
+    int32_t latitudeE6;
+    // Barometric altitude in meters, NaN if unknown.
+    float altitude;
+};
+static_assert( sizeof( TrackSample ) == 16 );
+
+// Recent positions of every tracked aircraft, indexed by `FlightSlot`. All samples
+// live in one slab allocated up front and handed out in fixed-size chunks, so
+// appending never allocates. Each track is a ring: once it holds
+// `samplesPerTrack` samples, its oldest chunk is reused for new ones. When the
+// slab runs out, the oldest chunk in the whole fleet is taken from whichever
+// track owns it, so memory stays at `maxSamples` however many aircraft there are.
+//
+// Tracks are simplified as they grow. While new samples stay within `tolerance`
+// meters of the line from the last kept sample, each one replaces the newest
+// sample instead of being appended, so a straight leg is stored as two points and
+// a turn as many. Every merged sample stays within `tolerance` of the stored
+// polyline. The test is the angular cone of the sliding-window simplifiers: the
+// directions from the last kept sample that pass within tolerance of every merged
+// sample narrow to an interval, and a sample outside it starts a new segment.
+class TrackHistory {
+public:
+    static constexpr uint32_t samplesPerChunk = 16;
+
+    struct Limits {
+        // Samples kept across all tracks.
+        size_t maxSamples = size_t( 1 ) << 18;
+        // Samples kept per track, rounded up to whole chunks.
+        size_t samplesPerTrack = 256;
+        // Largest distance in meters between a merged sample and the stored
+        // track. 0 keeps every sample.
+        float tolerance = 30;
+        // Seconds per sample: a sample in the same `interval`-aligned bucket as
+        // the track's newest one is dropped.
+        uint32_t interval = 1;
+
+        constexpr Limits() = default;
+        constexpr Limits( size_t maxSamples, size_t samplesPerTrack, float tolerance,
+                          uint32_t interval = 1 ):
+            maxSamples( maxSamples ), samplesPerTrack( samplesPerTrack ),
+            tolerance( tolerance ), interval( interval ) {}
+    };
+
+    // How well simplification is doing since the last `clear`.
+    struct Compression {
+        // Samples appended.
+        size_t samples = 0;
+        // Points those became; merged samples aren't counted.
+        size_t points = 0;
+
+        double ratio() const { return points ? double( samples ) / points : 1; }
+    };
+
+    TrackHistory() { limitsIs( {} ); }
+    explicit TrackHistory( const Limits & limits ) { limitsIs( limits ); }
+
+    const Limits & limits() const { return _limits; }
+    // Reallocates the slab for `limits`, dropping all samples.
+    void limitsIs( const Limits & limits );
+
+    // Appends the position of `stateVector` to the track of `slot`, unless it has
+    // none or it is not in a later `interval` than the track's last sample.
+    void append( FlightSlot slot, const StateVector & stateVector );
+    void append( FlightSlot slot, const TrackSample & sample );
+    // Drops the track of `slot`, e.g. when its aircraft leaves the store.
+    void erase( FlightSlot slot );
+    void clear();
+
+    // Samples held for `slot`.
+    size_t size( FlightSlot slot ) const {
+        return slot < _tracks.size() ? _tracks[ slot ].size : 0;
+    }
+    // Samples held across all tracks.
+    size_t totalSize() const { return _totalSize; }
+    // Bytes allocated for samples and bookkeeping. Grows only with the number of
+    // slots.
+    size_t memoryBytes() const {
+        return _samples.capacity() * sizeof( TrackSample ) +
+               _chunks.capacity() * sizeof( Chunk ) + _tracks.capacity() * sizeof( Track );
+    }
+    const Compression & compression() const { return _compression; }
+    // The oldest and newest samples of `slot`, which must have one.
+    const TrackSample & front( FlightSlot slot ) const {
+        assert( size( slot ) > 0 );
+        return _samples[ _tracks[ slot ].head * samplesPerChunk ];
+    }
+    const TrackSample & back( FlightSlot slot ) const {
+        assert( size( slot ) > 0 );
+        const Chunk & tail = _chunks[ _tracks[ slot ].tail ];
+        return _samples[ _tracks[ slot ].tail * samplesPerChunk + tail.count - 1 ];
+    }
+
+    // Calls `fn( const TrackSample & )` for each sample of `slot` fixed at or after
+    // `since` and before `until`, oldest first, preceded by the last one before
+    // `since` so that the segment reaching into the window is whole.
+    template< typename Fn >
+    void forEachBetween( FlightSlot slot, uint32_t since, uint32_t until, Fn && fn ) const {
+        if( slot >= _tracks.size() ) {
+            return;
+        }
+        const TrackSample * before = nullptr;
+        for( uint32_t chunk = _tracks[ slot ].head; chunk != noChunk;
+             chunk = _chunks[ chunk ].next ) {
+            const TrackSample * samples = &_samples[ chunk * samplesPerChunk ];
+            const uint32_t count = _chunks[ chunk ].count;
+            if( samples[ count - 1 ].time < since ) {
+                before = &samples[ count - 1 ];
+                continue;
+            }
+            for( uint32_t i = 0; i < count; ++i ) {
+                if( samples[ i ].time < since ) {
+                    before = &samples[ i ];
+                    continue;
+                }
+                if( samples[ i ].time >= until ) {
+                    return;
+                }
+                if( before ) {
+                    fn( *before );
+                    before = nullptr;
+                }
+                fn( samples[ i ] );
+            }
+        }
+    }
+    template< typename Fn >
+    void forEachSince( FlightSlot slot, uint32_t since, Fn && fn ) const {
+        forEachBetween( slot, since, UINT32_MAX, fn );
+    }
+
+private:
+    static constexpr uint32_t noChunk = UINT32_MAX;
+
+    struct Chunk {
+        FlightSlot owner = FlightStore::invalidSlot;
+        // The next newer chunk of the owner's track, or the next free chunk.
+        uint32_t next = noChunk;
+        // Neighbours in the fleet-wide age list, oldest first.
+        uint32_t older = noChunk;
+        uint32_t newer = noChunk;
+        uint32_t count = 0;
+    };
+    struct Track {
+        uint32_t head = noChunk;
+        uint32_t tail = noChunk;
+        uint32_t chunkCount = 0;
+        uint32_t size = 0;
+
+        // The last kept sample before the newest one, which is still open to
+        // being replaced while `merging`. Kept here because eviction may drop it
+        // from the chunks.
+        int32_t anchorLongitudeE6 = 0;
+        int32_t anchorLatitudeE6 = 0;
+        // Directions from the anchor, in radians relative to `coneReference`,
+        // that pass within tolerance of every sample since. Unconstrained until
+        // one of them is farther than tolerance from the anchor.
+        float coneReference = 0;
+        float coneLow = 0;
+        float coneHigh = 0;
+        // Distance of the farthest sample since the anchor, in meters.
+        float reach = 0;
+        bool coneSet = false;
+        bool merging = false;
+    };
+
+    // A chunk for the tail of `slot`'s track, taken from the free list or, if
+    // there is none, from the oldest track data in the fleet.
+    uint32_t acquireChunk();
+    // Unlinks the head chunk of `slot`'s track and returns it.
+    uint32_t popHead( FlightSlot slot );
+    void pushTail( FlightSlot slot, uint32_t chunk );
+    void unlinkAge( uint32_t chunk );
+    // Adds a point to the track of `slot`, without simplifying.
+    void push( FlightSlot slot, const TrackSample & sample );
+
+    static void restartSegment( Track & track, const TrackSample & anchor );
+    // Whether the segment from the anchor to `sample` passes within tolerance of
+    // every sample merged since the anchor.
+    bool extendsSegment( const Track & track, const TrackSample & sample ) const;
+    // Narrows the cone to the directions that also pass near `sample`.
+    void narrowCone( Track & track, const TrackSample & sample ) const;
+
+    Limits _limits;
+    uint32_t _chunksPerTrack = 0;
+    std::vector< TrackSample > _samples;
+    std::vector< Chunk > _chunks;
+    std::vector< Track > _tracks;
+    uint32_t _freeHead = noChunk;
+    uint32_t _oldest = noChunk;
+    uint32_t _newest = noChunk;
+    size_t _totalSize = 0;
+    Compression _compression;
+};
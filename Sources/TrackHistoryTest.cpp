@@ -0,0 +1,204 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <doctest/doctest.h>
+
+#include "Synthetic.hpp"
+#include "TrackHistory.hpp"
+
+namespace {
+
+TrackSample
+sampleAt( uint32_t time ) {
+    return { time, int32_t( time ) * 10, -int32_t( time ), float( time ) };
+}
+
+std::vector< uint32_t >
+times( const TrackHistory & history, FlightSlot slot, uint32_t since = 0 ) {
+    std::vector< uint32_t > result;
+    history.forEachSince( slot, since, [ & ]( const TrackSample & sample ) {
+        CHECK( sample.longitudeE6 == int32_t( sample.time ) * 10 );
+        result.push_back( sample.time );
+    } );
+    return result;
+}
+
+std::vector< uint32_t >
+range( uint32_t first, uint32_t last ) {
+    std::vector< uint32_t > result;
+    for( uint32_t t = first; t <= last; ++t ) {
+        result.push_back( t );
+    }
+    return result;
+}
+
+std::vector< TrackSample >
+samples( const TrackHistory & history, FlightSlot slot ) {
+    std::vector< TrackSample > result;
+    history.forEachSince( slot, 0, [ & ]( const TrackSample & sample ) {
+        result.push_back( sample );
+    } );
+    return result;
+}
+
+// Meters from `state` to the nearest segment of `track`, on a plane tangent at
+// `state`.
+double
+distanceToTrack( const StateVector & state, const std::vector< TrackSample > & track ) {
+    const double scaleX =
+        metersPerMicroDegree * std::cos( toRadians( fromMicroDegrees( state.latitudeE6 ) ) );
+    const auto x = [ & ]( int32_t longitudeE6 ) {
+        return double( longitudeE6 - state.longitudeE6 ) * scaleX;
+    };
+    const auto y = [ & ]( int32_t latitudeE6 ) {
+        return double( latitudeE6 - state.latitudeE6 ) * metersPerMicroDegree;
+    };
+    double best = 1e300;
+    for( size_t i = 0; i + 1 < track.size(); ++i ) {
+        const double ax = x( track[ i ].longitudeE6 );
+        const double ay = y( track[ i ].latitudeE6 );
+        const double dx = x( track[ i + 1 ].longitudeE6 ) - ax;
+        const double dy = y( track[ i + 1 ].latitudeE6 ) - ay;
+        const double length2 = dx * dx + dy * dy;
+        const double t =
+            length2 > 0 ? std::clamp( -( ax * dx + ay * dy ) / length2, 0.0, 1.0 ) : 0.0;
+        best = std::min( best, std::hypot( ax + t * dx, ay + t * dy ) );
+    }
+    return best;
+}
+
+} // namespace
+
+TEST_CASE( "track history keeps a ring per aircraft" ) {
+    TrackHistory history( { 1024, 32, 0 } );
+    for( uint32_t t = 1; t <= 20; ++t ) {
+        history.append( 3, sampleAt( t ) );
+    }
+    CHECK( history.size( 3 ) == 20 );
+    CHECK( history.size( 0 ) == 0 );
+    CHECK( history.size( 99 ) == 0 );
+    CHECK( times( history, 3 ) == range( 1, 20 ) );
+    // The sample before the window starts the trail's first segment.
+    CHECK( times( history, 3, 15 ) == range( 14, 20 ) );
+    CHECK( times( history, 3, 21 ).empty() );
+    CHECK( history.back( 3 ).time == 20 );
+
+    SUBCASE( "stale samples are ignored" ) {
+        history.append( 3, sampleAt( 20 ) );
+        history.append( 3, sampleAt( 7 ) );
+        CHECK( history.size( 3 ) == 20 );
+    }
+    SUBCASE( "a full ring drops its oldest chunk" ) {
+        for( uint32_t t = 21; t <= 40; ++t ) {
+            history.append( 3, sampleAt( t ) );
+        }
+        // Two chunks of 16: 33..40 started the third, which evicted 1..16.
+        CHECK( times( history, 3 ) == range( 17, 40 ) );
+        CHECK( history.totalSize() == 24 );
+    }
+    SUBCASE( "erasing frees the track" ) {
+        history.erase( 3 );
+        CHECK( history.size( 3 ) == 0 );
+        CHECK( history.totalSize() == 0 );
+        history.append( 3, sampleAt( 5 ) );
+        CHECK( times( history, 3 ) == range( 5, 5 ) );
+    }
+}
+
+TEST_CASE( "track history evicts the oldest samples in the fleet" ) {
+    TrackHistory history( { 64, 256, 0 } );
+    // Four aircraft take turns, so each holds one full chunk of 16 when the slab
+    // fills up.
+    for( uint32_t t = 1; t <= 16; ++t ) {
+        for( FlightSlot slot = 0; slot < 4; ++slot ) {
+            history.append( slot, sampleAt( t ) );
+        }
+    }
+    CHECK( history.totalSize() == 64 );
+
+    // A new aircraft needs a chunk: the one filled first, slot 0's, goes.
+    history.append( 7, sampleAt( 17 ) );
+    CHECK( history.size( 0 ) == 0 );
+    CHECK( history.size( 1 ) == 16 );
+    CHECK( history.size( 7 ) == 1 );
+    CHECK( history.totalSize() == 49 );
+
+    // Slot 3 growing takes slot 1's chunk, now the oldest.
+    history.append( 3, sampleAt( 17 ) );
+    CHECK( history.size( 3 ) == 17 );
+    CHECK( history.size( 1 ) == 0 );
+    CHECK( history.size( 2 ) == 16 );
+    CHECK( times( history, 3 ) == range( 1, 17 ) );
+
+    SUBCASE( "one aircraft can take the whole slab" ) {
+        for( uint32_t t = 18; t <= 200; ++t ) {
+            history.append( 3, sampleAt( t ) );
+        }
+        CHECK( history.totalSize() <= 64 );
+        CHECK( history.size( 2 ) == 0 );
+        CHECK( history.size( 7 ) == 0 );
+        CHECK( times( history, 3 ).back() == 200 );
+        CHECK( times( history, 3 ).front() == 200 - history.size( 3 ) + 1 );
+    }
+    SUBCASE( "new limits drop everything" ) {
+        history.limitsIs( { 32, 16, 0 } );
+        CHECK( history.totalSize() == 0 );
+        CHECK( history.size( 3 ) == 0 );
+    }
+}
+
+TEST_CASE( "track history samples states with a position" ) {
+    TrackHistory history;
+    StateVector stateVector;
+    stateVector.lastContact = 1000;
+    history.append( 0, stateVector );
+    CHECK( history.size( 0 ) == 0 );
+
+    stateVector.longitudeE6 = -71000000;
+    stateVector.latitudeE6 = 42000000;
+    stateVector.baroAltitude = 1500;
+    stateVector.positionAgeIs( 4 );
+    history.append( 0, stateVector );
+    REQUIRE( history.size( 0 ) == 1 );
+    CHECK( history.back( 0 ).time == 996 );
+    CHECK( history.back( 0 ).longitudeE6 == -71000000 );
+    CHECK( history.back( 0 ).altitude == 1500 );
+}
+
+TEST_CASE( "track history simplifies within tolerance" ) {
+    const auto simplify = [ & ]( const std::vector< StateVector > & path, float tolerance ) {
+        TrackHistory history( { 1 << 16, 1 << 16, tolerance } );
+        for( const StateVector & state : path ) {
+            history.append( 0, state );
+        }
+        CHECK( history.compression().samples == path.size() );
+        CHECK( history.compression().points == history.size( 0 ) );
+        const std::vector< TrackSample > track = samples( history, 0 );
+        double worst = 0;
+        for( const StateVector & state : path ) {
+            worst = std::max( worst, distanceToTrack( state, track ) );
+        }
+        CHECK( worst <= tolerance + 0.5 );
+        // The ends are kept exactly.
+        CHECK( track.front().time == path.front().lastContact );
+        CHECK( track.back().time == path.back().lastContact );
+        CHECK( track.back().longitudeE6 == path.back().longitudeE6 );
+        return history.compression().ratio();
+    };
+
+    SUBCASE( "cruising collapses to a few points" ) {
+        const std::vector< StateVector > path = Synthetic::flightPath( 2000, 4, false );
+        CHECK( simplify( path, 30 ) >= 10 );
+    }
+    SUBCASE( "turns keep their shape" ) {
+        const std::vector< StateVector > path = Synthetic::flightPath( 2000, 4 );
+        const double ratio = simplify( path, 30 );
+        CHECK( ratio > 2 );
+        CHECK( simplify( path, 5 ) < ratio );
+    }
+    SUBCASE( "no tolerance keeps every sample" ) {
+        const std::vector< StateVector > path = Synthetic::flightPath( 200, 4, false );
+        CHECK( simplify( path, 0 ) == 1 );
+    }
+}